@@ -8,24 +8,80 @@
 #include <cstring>
 #include <iostream>
 #include <exception>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <thread>
 
 #include "src/internal/vkHelper.h"
+#include "src/internal/vkMemory.h"
+#include "src/internal/vkTransfer.h"
+#include "src/internal/vkMesh.h"
+#include "src/internal/vkCulling.h"
+#include "src/internal/vkSimulation.h"
+#include "src/internal/vkUniform.h"
+#include "src/internal/vkDescriptor.h"
+#include "src/internal/vkCompile.h"
+#include "src/internal/vkStartup.h"
+#include "src/internal/vkBench.h"
+#include "src/internal/vkPerf.h"
+#include "src/internal/vkLog.h"
+#include "src/internal/vkTrace.h"
 #include "src/internal/wndHelper.h"
 
+#ifdef _WIN32
 #define _CRTDBG_MAP_ALLOC
 #include <stdlib.h>
 #include <crtdbg.h>
+#else
+#include <stdlib.h>
+#endif
 
 int main ( int argc , char* argv[] )
 {
-#if defined(DEBUG) | defined(_DEBUG)
+#if ( defined(DEBUG) | defined(_DEBUG) ) && defined(_WIN32)
 	_CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
 	_CrtSetReportMode ( _CRT_WARN , _CRTDBG_MODE_DEBUG );
 #endif
 
+	auto program_start = std::chrono::high_resolution_clock::now ();
+
 	bool enable_validation_ { false };
 	bool enable_renderdoc_ { false };
 
+	// headless renders into offscreen images and reads them back, there is no window on other platforms
+#ifdef _WIN32
+	bool headless_ { false };
+#else
+	bool headless_ { true };
+#endif
+	int resize_storm_ { 0 };
+	bool record_per_frame_ { false };
+	int record_threads_ { 0 };
+	int draw_count_ { 1 };
+	int record_bench_frames_ { 0 };
+	int instance_count_ { 0 };
+	int instance_bench_frames_ { 0 };
+	int push_bench_frames_ { 0 };
+	int latency_sweep_frames_ { 0 };
+	bool gpu_cull_ { false };
+	int async_particles_ { 0 };
+	int pipeline_variants_ { 0 };
+	bool serial_startup_ { false };
+	vkLog::Parameters log_params;
+	std::string trace_file_;
+
+	// size, present mode and frame counts of the run, benchmark_file_ also warms up first and writes the results out
+	vkBench::Parameters bench_params;
+	std::string benchmark_file_;
+
+	// performance gate, compares the create steps, the frame loop and a resize loop with a baseline recorded on the machine that gates
+	// no baseline and no build outside the visual studio project ship, -perf-gate refuses to run until -perf-record has added enough runs
+	std::string perf_gate_file_;
+	std::string perf_record_file_;
+	int perf_resizes_ { 50 };
+	bool perf_passed_ { true };
+
 	for ( int i = 0; i < argc; ++i )
 	{
 		if ( !strcmp ( argv[ i ] , "-d" ) )
@@ -36,33 +92,167 @@ int main ( int argc , char* argv[] )
 		{
 			enable_renderdoc_ = true;
 		}
+		else if ( !strcmp ( argv[ i ] , "-headless" ) )
+		{
+			headless_ = true;
+		}
+		else if ( !strcmp ( argv[ i ] , "-frames" ) && i + 1 < argc )
+		{
+			bench_params.frames_ = static_cast< uint32_t >( std::max ( atoi ( argv[ ++i ] ) , 0 ) );
+		}
+		else if ( !strcmp ( argv[ i ] , "-frames-in-flight" ) && i + 1 < argc )
+		{
+			bench_params.frames_in_flight_ = static_cast< uint32_t >( std::min ( std::max ( atoi ( argv[ ++i ] ) , 1 ) , static_cast< int >( vkHelper::Create::MAX_FRAMES_IN_FLIGHT ) ) );
+		}
+		else if ( !strcmp ( argv[ i ] , "-latency-sweep" ) && i + 1 < argc )
+		{
+			latency_sweep_frames_ = atoi ( argv[ ++i ] );
+		}
+		else if ( !strcmp ( argv[ i ] , "-warmup" ) && i + 1 < argc )
+		{
+			bench_params.warmup_frames_ = static_cast< uint32_t >( std::max ( atoi ( argv[ ++i ] ) , 0 ) );
+		}
+		else if ( !strcmp ( argv[ i ] , "-size" ) && i + 1 < argc )
+		{
+			if ( !vkBench::ParseSize ( argv[ ++i ] , bench_params.width_ , bench_params.height_ ) )
+			{
+				std::cerr << "### Bad size " << argv[ i ] << ", expected WIDTHxHEIGHT." << std::endl;
+			}
+		}
+		else if ( !strcmp ( argv[ i ] , "-present-mode" ) && i + 1 < argc )
+		{
+			if ( !vkBench::ParsePresentMode ( argv[ ++i ] , bench_params.present_mode_ ) )
+			{
+				std::cerr << "### Unknown present mode " << argv[ i ] << ", expected fifo, fifo-relaxed, mailbox or immediate." << std::endl;
+			}
+		}
+		else if ( !strcmp ( argv[ i ] , "-benchmark" ) && i + 1 < argc )
+		{
+			benchmark_file_ = argv[ ++i ];
+		}
+		else if ( !strcmp ( argv[ i ] , "-perf-gate" ) && i + 1 < argc )
+		{
+			perf_gate_file_ = argv[ ++i ];
+		}
+		else if ( !strcmp ( argv[ i ] , "-perf-record" ) && i + 1 < argc )
+		{
+			perf_record_file_ = argv[ ++i ];
+		}
+		else if ( !strcmp ( argv[ i ] , "-perf-resizes" ) && i + 1 < argc )
+		{
+			perf_resizes_ = std::max ( atoi ( argv[ ++i ] ) , 1 );
+		}
+		else if ( !strcmp ( argv[ i ] , "-resize-storm" ) && i + 1 < argc )
+		{
+			resize_storm_ = atoi ( argv[ ++i ] );
+		}
+		else if ( !strcmp ( argv[ i ] , "-record-per-frame" ) )
+		{
+			record_per_frame_ = true;
+		}
+		else if ( !strcmp ( argv[ i ] , "-record-threads" ) && i + 1 < argc )
+		{
+			record_threads_ = std::max ( atoi ( argv[ ++i ] ) , 0 );
+			record_per_frame_ = true;
+		}
+		else if ( !strcmp ( argv[ i ] , "-draws" ) && i + 1 < argc )
+		{
+			draw_count_ = std::max ( atoi ( argv[ ++i ] ) , 1 );
+		}
+		else if ( !strcmp ( argv[ i ] , "-record-bench" ) && i + 1 < argc )
+		{
+			record_bench_frames_ = atoi ( argv[ ++i ] );
+		}
+		else if ( !strcmp ( argv[ i ] , "-instances" ) && i + 1 < argc )
+		{
+			instance_count_ = std::max ( atoi ( argv[ ++i ] ) , 1 );
+		}
+		else if ( !strcmp ( argv[ i ] , "-instance-bench" ) && i + 1 < argc )
+		{
+			instance_bench_frames_ = atoi ( argv[ ++i ] );
+		}
+		else if ( !strcmp ( argv[ i ] , "-push-bench" ) && i + 1 < argc )
+		{
+			push_bench_frames_ = atoi ( argv[ ++i ] );
+		}
+		else if ( !strcmp ( argv[ i ] , "-gpu-cull" ) )
+		{
+			gpu_cull_ = true;
+		}
+		else if ( !strcmp ( argv[ i ] , "-async-compute" ) && i + 1 < argc )
+		{
+			async_particles_ = std::max ( atoi ( argv[ ++i ] ) , 1 );
+		}
+		else if ( !strcmp ( argv[ i ] , "-pipeline-variants" ) && i + 1 < argc )
+		{
+			pipeline_variants_ = std::max ( atoi ( argv[ ++i ] ) , 0 );
+		}
+		else if ( !strcmp ( argv[ i ] , "-serial-startup" ) )
+		{
+			serial_startup_ = true;
+		}
+		else if ( !strcmp ( argv[ i ] , "-trace" ) && i + 1 < argc )
+		{
+			trace_file_ = argv[ ++i ];
+		}
+		else if ( !strcmp ( argv[ i ] , "-log-level" ) && i + 1 < argc )
+		{
+			if ( !vkLog::ParseLevel ( argv[ ++i ] , log_params.level_ ) )
+			{
+				std::cerr << "### Unknown log level " << argv[ i ] << ", expected trace, info, warning, failure or off." << std::endl;
+			}
+		}
 	}
 
-	char ans;
-	std::cout << "Validation layers? (Y/N)" << std::endl;
-	std::cin >> ans;
-	if ( ans == 'Y' || ans == 'y' )
+	// diagnostics are queued and written by the logger's thread, results below still go straight to std::cout
+	vkLog::Initialize ( log_params );
+
+	// a gate with nothing to compare against would pass every run
+	if ( !perf_gate_file_.empty () && !vkPerf::HasBaseline ( perf_gate_file_ ) )
 	{
-		enable_validation_ = true;
+		VKLOG_FAILURE ( "### No perf baseline at " , perf_gate_file_ , ", record runs with -perf-record on this machine first." );
+		vkLog::Shutdown ();
+		return 2;
 	}
-	else
+
+	// zones of the create steps, frame phases and swap chain recreation, for chrome://tracing or ui.perfetto.dev
+	// the perf gate times the create steps by their zones
+	bool perf_ = !perf_gate_file_.empty () || !perf_record_file_.empty ();
+	if ( !trace_file_.empty () || perf_ )
 	{
-		enable_validation_ = false;
+		vkTrace::Initialize ();
+		vkTrace::NameThread ( "main" );
 	}
+	vkTrace::Zone startup_zone ( "Startup" );
 
-	std::cout << "RenderDoc? (Y/N)" << std::endl;
-	std::cin >> ans;
-	if ( ans == 'Y' || ans == 'y' )
+	// the instanced draw lives in the per frame commands, prerecorded buffers only draw the built in triangle
+	bool instanced_ = instance_count_ > 0 || instance_bench_frames_ > 0 || push_bench_frames_ > 0 || gpu_cull_;
+	if ( instanced_ )
 	{
-		enable_renderdoc_ = true;
+		record_per_frame_ = true;
 	}
-	else
+
+	// the compiled variants are swapped in as they finish, prerecorded buffers would keep drawing with the placeholder
+	if ( pipeline_variants_ > 0 )
 	{
-		enable_renderdoc_ = false;
+		record_per_frame_ = true;
 	}
 
-	// create vulkan instance
-	VkInstance vk_instance { nullptr };
+	// the particles are drawn from the frame slot's positions, prerecorded buffers are per image
+	if ( async_particles_ > 0 )
+	{
+		record_per_frame_ = true;
+	}
+
+	// per frame resources are indexed by frame slot, the latency sweep goes up to the deepest queue
+	uint32_t frame_slots = latency_sweep_frames_ > 0 ? vkHelper::Create::MAX_FRAMES_IN_FLIGHT : bench_params.frames_in_flight_;
+
+	bench_params.headless_ = headless_;
+	bool benchmark_ = !benchmark_file_.empty ();
+
+	// the perf gate starts from an empty pipeline cache every run, a warm one would depend on the runs before
+	std::string pipeline_cache_path_ { perf_ ? "" : "pipeline_cache.bin" };
+
 	int flags { 0 };
 	if ( enable_validation_ )
 	{
@@ -72,94 +262,304 @@ int main ( int argc , char* argv[] )
 	{
 		flags |= static_cast< int >( vkHelper::Get::VKLAYER::RENDERDOC_CAPTURE );
 	}
-	if ( !vkHelper::Create::vkInstance ( "Homework1" , vk_instance , flags ) )
+
+	// instance to device is one chain, the window, the pipeline cache file and the SPIR-V reads do not need it and overlap with it
+	vkStartup::Scheduler vk_startup;
+	VkInstance vk_instance { nullptr };
+	VkDebugUtilsMessengerEXT vk_debug_messenger { VK_NULL_HANDLE };
+	VkSurfaceKHR vk_surface { VK_NULL_HANDLE };
+	VkPhysicalDevice vk_physical_device { VK_NULL_HANDLE };
+	vkHelper::vkDeviceProfile vk_device_profile;
+	VkDevice vk_logical_device { VK_NULL_HANDLE };
+	std::vector<char> pipeline_cache_file;
+
+	// shader modules are loaded once and kept for every pipeline built after
+	vkHelper::vkShaderCacheData vk_shader_cache;
+
+	// create vulkan instance
+	vkStartup::Scheduler::Task instance_task = vk_startup.Add ( "Startup::vkInstance" , [ & ] ()
 	{
-		throw std::runtime_error ( "Failed to create vkinstance!" );
-	}
-	std::cout << "### VkInstance created successfully." << std::endl;
+		if ( !vkHelper::Create::vkInstance ( "Homework1" , vk_instance , flags , headless_ ) )
+		{
+			return false;
+		}
+		VKLOG_INFO ( "### VkInstance created successfully." );
+		return true;
+	} );
 
 	// create debug messenger
-	VkDebugUtilsMessengerEXT vk_debug_messenger { VK_NULL_HANDLE };
-	if ( enable_validation_ )
+	vk_startup.Add ( "Startup::vkDebugMessenger" , [ & ] ()
 	{
-		if ( !vkHelper::Create::vkDebugMessenger ( vk_instance , vk_debug_messenger ) )
+		if ( enable_validation_ && !vkHelper::Create::vkDebugMessenger ( vk_instance , vk_debug_messenger ) )
 		{
-			throw std::runtime_error ( "Failed to create debug messenger!" );
+			return false;
 		}
-	}
-	std::cout << "### VkDebugMessenger created successfully." << std::endl;
+		VKLOG_INFO ( "### VkDebugMessenger created successfully." );
+		return true;
+	} , { instance_task } );
 
-	// create window
+	// create window and surface, headless has neither
+	std::vector<vkStartup::Scheduler::Task> surface_tasks { instance_task };
+#ifdef _WIN32
 	wndHelper::Window window;
-	if ( !window.Initialize ( { 500, 300, false } ) )
+	if ( !headless_ )
 	{
-		throw std::runtime_error ( "Failed to initialize window!" );
+		// the window's messages are pumped by the thread that created it
+		vkStartup::Scheduler::Task window_task = vk_startup.Add ( "Startup::Window" , [ & ] ()
+		{
+			if ( !window.Initialize ( { static_cast< int >( bench_params.width_ ), static_cast< int >( bench_params.height_ ), false } ) )
+			{
+				return false;
+			}
+			VKLOG_INFO ( "### Window created successfully." );
+			return true;
+		} , {} , true );
+
+		surface_tasks.push_back ( vk_startup.Add ( "Startup::vkSurfaceWin32" , [ & ] ()
+		{
+			if ( !vkHelper::Create::vkSurfaceWin32 ( vk_instance , window.GetHandle () , vk_surface ) )
+			{
+				return false;
+			}
+			VKLOG_INFO ( "### VkSurface created successfully." );
+			return true;
+		} , { instance_task , window_task } ) );
 	}
-	std::cout << "### Window created successfully." << std::endl;
+#endif
 
-	// create surface
-	VkSurfaceKHR vk_surface { VK_NULL_HANDLE };
-	if ( !vkHelper::Create::vkSurfaceWin32 ( vk_instance , window.GetHandle () , vk_surface ) )
+	// create physical device
+	// all device and surface queries are done once here and cached in the profile
+	vkStartup::Scheduler::Task physical_device_task = vk_startup.Add ( "Startup::vkPhysicalDevice" , [ & ] ()
 	{
-		throw std::runtime_error ( "Failed to create VkSurfaceKHR!" );
+		if ( ( vk_physical_device = vkHelper::Create::vkPhysicalDevice ( vk_instance , vk_surface , vk_device_profile ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+		VKLOG_INFO ( "### VkPhysicalDevice created successfully." );
+		return true;
+	} , surface_tasks );
+
+	// create logical device
+	vk_startup.Add ( "Startup::vkLogicalDevice" , [ & ] ()
+	{
+		if ( ( vk_logical_device = vkHelper::Create::vkLogicalDevice ( vk_device_profile , flags ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+		VKLOG_INFO ( "### VkDevice logical created successfully." );
+		return true;
+	} , { physical_device_task } );
+
+	// read the pipeline cache file, it is checked against the device once there is one
+	vk_startup.Add ( "Startup::ReadPipelineCacheFile" , [ & ] ()
+	{
+		if ( !pipeline_cache_path_.empty () )
+		{
+			vkHelper::IO::ReadPipelineCacheFile ( pipeline_cache_path_ , pipeline_cache_file );
+		}
+		return true;
+	} );
+
+	// map and hash the SPIR-V of the pipelines built below, only creating the modules is left for the device
+	std::vector<std::string> startup_shaders { instanced_ ? "shaders/instanced_vert.spv" : "shaders/vert.spv" , "shaders/frag.spv" };
+	if ( push_bench_frames_ > 0 )
+	{
+		startup_shaders.push_back ( "shaders/instanced_push_vert.spv" );
+	}
+	for ( std::string const& shader : startup_shaders )
+	{
+		vk_startup.Add ( "Startup::PrefetchShader" , [ & , shader ] ()
+		{
+			// a missing file is reported again when the pipeline loads it
+			vkHelper::IO::PrefetchShader ( vk_shader_cache , shader );
+			return true;
+		} );
 	}
-	std::cout << "### VkSurface created successfully." << std::endl;
 
-	// create physical device
-	VkPhysicalDevice vk_physical_device { VK_NULL_HANDLE };
-	if ( ( vk_physical_device = vkHelper::Create::vkPhysicalDevice ( vk_instance , vk_surface ) ) == VK_NULL_HANDLE )
+	// -serial-startup runs the same steps on this thread alone, to compare against
+	uint32_t startup_threads = serial_startup_ ? 1u : std::min ( std::max ( std::thread::hardware_concurrency () , 1u ) , 4u );
+	if ( !vk_startup.Run ( startup_threads ) )
 	{
-		throw std::runtime_error ( "Failed to create VkPhysicalDevice!" );
+		throw std::runtime_error ( std::string ( "Failed at " ) + vk_startup.Failed () + "!" );
 	}
-	std::cout << "### VkPhysicalDevice created successfully." << std::endl;
 
-	// create logical device
-	VkDevice vk_logical_device { VK_NULL_HANDLE };
-	if ( ( vk_logical_device = vkHelper::Create::vkLogicalDevice ( vk_physical_device , vk_surface , flags ) ) == VK_NULL_HANDLE )
+	// create device memory allocator, buffers and images are sub allocated from its blocks
+	vkMemory::Allocator vk_allocator;
+	if ( !vk_allocator.Initialize ( vk_device_profile , vk_logical_device , {} ) )
 	{
-		throw std::runtime_error ( "Failed to create VkDevice logical!" );
+		throw std::runtime_error ( "Failed to create device memory allocator!" );
 	}
-	std::cout << "### VkDevice logical created successfully." << std::endl;
+	VKLOG_INFO ( "### Device memory allocator created successfully." );
 
 	// create graphics queue
 	VkQueue vk_graphics_queue { VK_NULL_HANDLE };
-	if ( ( vk_graphics_queue = vkHelper::Create::vkGraphicsQueue ( vk_physical_device , vk_surface , vk_logical_device ) ) == VK_NULL_HANDLE )
+	if ( ( vk_graphics_queue = vkHelper::Create::vkGraphicsQueue ( vk_device_profile , vk_logical_device ) ) == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create graphics queue!" );
 	}
-	std::cout << "### VkQueue graphics created successfully." << std::endl;
+	VKLOG_INFO ( "### VkQueue graphics created successfully." );
 
 	// create present queue
 	VkQueue vk_present_queue { VK_NULL_HANDLE };
-	if ( ( vk_present_queue = vkHelper::Create::vkPresentQueue ( vk_physical_device , vk_surface , vk_logical_device ) ) == VK_NULL_HANDLE )
+	if ( ( vk_present_queue = vkHelper::Create::vkPresentQueue ( vk_device_profile , vk_logical_device ) ) == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create present queue!" );
 	}
-	std::cout << "### VkQueue present created successfully." << std::endl;
+	VKLOG_INFO ( "### VkQueue present created successfully." );
+
+	// create transfer queue, the graphics queue when the device has no separate transfer family
+	VkQueue vk_transfer_queue { VK_NULL_HANDLE };
+	if ( ( vk_transfer_queue = vkHelper::Create::vkTransferQueue ( vk_device_profile , vk_logical_device ) ) == VK_NULL_HANDLE )
+	{
+		throw std::runtime_error ( "Failed to create transfer queue!" );
+	}
+	VKLOG_INFO ( "### VkQueue transfer created successfully." );
+
+	// create compute queue, the graphics queue when the device has no separate compute family
+	VkQueue vk_compute_queue { VK_NULL_HANDLE };
+	if ( ( vk_compute_queue = vkHelper::Create::vkComputeQueue ( vk_device_profile , vk_logical_device ) ) == VK_NULL_HANDLE )
+	{
+		throw std::runtime_error ( "Failed to create compute queue!" );
+	}
+	VKLOG_INFO ( "### VkQueue compute created successfully." );
+
+	// create staging ring, uploads go through it on the transfer queue
+	vkTransfer::StagingRing vk_staging_ring;
+	if ( !vk_staging_ring.Initialize ( vk_device_profile , vk_logical_device , vk_allocator , vk_transfer_queue , vk_graphics_queue , {} ) )
+	{
+		throw std::runtime_error ( "Failed to create staging ring!" );
+	}
+	VKLOG_INFO ( "### Staging ring created successfully." );
 
-	// create swap chain
+	// create swap chain, or offscreen images when headless
 	vkHelper::vkSwapChainData vk_swapchain_data;
-	if ( ( vk_swapchain_data = vkHelper::Create::vkSwapChain ( vk_physical_device , vk_surface , vk_logical_device ) ).swapchain_ == VK_NULL_HANDLE )
+	if ( headless_ )
+	{
+		if ( !( vk_swapchain_data = vkHelper::Create::vkOffscreenTarget ( vk_device_profile , vk_logical_device , { bench_params.width_, bench_params.height_ } , VK_FORMAT_R8G8B8A8_UNORM , frame_slots + 1 ) ).IsOffscreen () )
+		{
+			throw std::runtime_error ( "Failed to create offscreen target" );
+		}
+		VKLOG_INFO ( "### Offscreen target created successfully." );
+	}
+	else if ( ( vk_swapchain_data = vkHelper::Create::vkSwapChain ( vk_device_profile , vk_logical_device , VK_NULL_HANDLE , bench_params.present_mode_ ) ).swapchain_ == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create VkSwapchain" );
 	}
-	std::cout << "### VkSwapchain created successfully." << std::endl;
+	else
+	{
+		VKLOG_INFO ( "### VkSwapchain created successfully." );
+	}
 
-	// create render pass
+	// create render pass, offscreen images end the pass ready to be copied out
 	VkRenderPass vk_render_pass { VK_NULL_HANDLE };
-	if ( ( vk_render_pass = vkHelper::Create::vkRenderPass ( vk_logical_device , vk_swapchain_data.format_ ) ) == VK_NULL_HANDLE )
+	VkImageLayout final_layout = headless_ ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	if ( ( vk_render_pass = vkHelper::Create::vkRenderPass ( vk_logical_device , vk_swapchain_data.format_ , final_layout ) ) == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create VkRenderPass" );
 	}
-	std::cout << "### VkRenderPass created successfully." << std::endl;
+	VKLOG_INFO ( "### VkRenderPass created successfully." );
+
+	// create pipeline cache, seeded from the previous run
+	VkPipelineCache vk_pipeline_cache { VK_NULL_HANDLE };
+	if ( ( vk_pipeline_cache = vkHelper::Create::vkPipelineCache ( vk_device_profile , vk_logical_device , pipeline_cache_path_ , &pipeline_cache_file ) ) == VK_NULL_HANDLE )
+	{
+		throw std::runtime_error ( "Failed to create VkPipelineCache" );
+	}
+	VKLOG_INFO ( "### VkPipelineCache created successfully." );
+	pipeline_cache_file = {};
+
+	// create descriptor caches, layouts and sets that live as long as the device, and sets reset with their frame
+	vkDescriptor::LayoutCache vk_layout_cache;
+	vkDescriptor::SetCache vk_static_sets;
+	vkDescriptor::FrameSetCaches vk_frame_sets;
+	vk_layout_cache.Initialize ( vk_logical_device );
+	if ( !vk_static_sets.Initialize ( vk_logical_device , {} ) ||
+		!vk_frame_sets.Initialize ( vk_logical_device , frame_slots , {} ) )
+	{
+		throw std::runtime_error ( "Failed to create descriptor caches" );
+	}
+	VKLOG_INFO ( "### Descriptor caches created successfully." );
+
+	// create uniform ring, the instanced draws read their constants from it at a dynamic offset
+	vkUniform::UniformRing vk_uniform_ring;
+	std::vector<VkDescriptorSetLayout> graphics_set_layouts;
+	if ( instanced_ )
+	{
+		vkUniform::UniformRing::Parameters uniform_params;
+		uniform_params.frame_size_ = std::max ( uniform_params.frame_size_ , static_cast< VkDeviceSize >( draw_count_ ) * 256 );
+		if ( !vk_uniform_ring.Initialize ( vk_device_profile , vk_logical_device , vk_allocator , vk_layout_cache , vk_static_sets , frame_slots , uniform_params ) )
+		{
+			throw std::runtime_error ( "Failed to create uniform ring" );
+		}
+		graphics_set_layouts.push_back ( vk_uniform_ring.SetLayout () );
+		VKLOG_INFO ( "### Uniform ring created successfully." );
+	}
 
 	// create graphics pipeline
 	vkHelper::vkPipelineData vk_graphics_pipeline;
-	if ( ( vk_graphics_pipeline = vkHelper::Create::vkGraphicsPipeline ( vk_logical_device , vk_swapchain_data , vk_render_pass ) ).pipeline_ == VK_NULL_HANDLE )
+	if ( ( vk_graphics_pipeline = vkHelper::Create::vkGraphicsPipeline ( vk_logical_device , vk_render_pass , vk_pipeline_cache , instanced_ , graphics_set_layouts , 0 , &vk_shader_cache ) ).pipeline_ == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create VkPipeline" );
 	}
-	std::cout << "### VkGraphicsPipeline created successfully." << std::endl;
+	VKLOG_INFO ( "### VkGraphicsPipeline created successfully." );
+
+	// compile state permutations of the graphics pipeline in the background, frames draw the built in pipeline until the showcase variant is ready
+	vkCompile::PipelineCompiler vk_pipeline_compiler;
+	vkCompile::PipelineCompiler::Handle showcase_variant { 0 };
+	if ( pipeline_variants_ > 0 )
+	{
+		vkCompile::PipelineCompiler::Parameters compiler_params;
+		compiler_params.thread_count_ = std::max ( std::thread::hardware_concurrency () , 2u ) - 1;
+		if ( !vk_pipeline_compiler.Initialize ( vk_logical_device , vk_render_pass , vk_pipeline_cache , &vk_shader_cache , vk_graphics_pipeline , compiler_params ) )
+		{
+			throw std::runtime_error ( "Failed to start the pipeline compiler" );
+		}
+
+		VkCullModeFlags const cull_modes[] { VK_CULL_MODE_BACK_BIT , VK_CULL_MODE_NONE , VK_CULL_MODE_FRONT_BIT };
+		VkFrontFace const front_faces[] { VK_FRONT_FACE_CLOCKWISE , VK_FRONT_FACE_COUNTER_CLOCKWISE };
+		for ( int i = 0; i < pipeline_variants_; ++i )
+		{
+			vkCompile::PipelineCompiler::Variant variant;
+			variant.instanced_ = instanced_;
+			variant.set_layouts_ = graphics_set_layouts;
+			variant.state_.cull_mode_ = cull_modes[ i % 3 ];
+			variant.state_.front_face_ = front_faces[ ( i / 3 ) % 2 ];
+			variant.state_.alpha_blend_ = ( i / 6 ) % 2 == 1;
+			variant.state_.constants_.Set ( vkHelper::INSTANCE_ROTATION , ( i / 12 ) % 2 == 0 );
+			variant.state_.constants_.Set ( vkHelper::INSTANCE_TINT , ( i / 24 ) % 2 == 0 );
+
+			// past 48 the permutations repeat and are shared with the first ones
+			vkCompile::PipelineCompiler::Handle handle = vk_pipeline_compiler.Submit ( variant );
+
+			// variant 7 is alpha blended without culling, the last one queued if there are fewer
+			if ( i == std::min ( pipeline_variants_ - 1 , 7 ) )
+			{
+				showcase_variant = handle;
+			}
+		}
+		VKLOG_INFO ( "### Pipeline compiler: " , pipeline_variants_ , " variants queued on " , compiler_params.thread_count_ , " threads." );
+	}
+	auto frame_pipeline = [ & ] () -> vkHelper::vkPipelineData&
+	{
+		return pipeline_variants_ > 0 ? vk_pipeline_compiler.Get ( showcase_variant ) : vk_graphics_pipeline;
+	};
+
+	// created with async compute below, its points are drawn in the render pass too
+	vkSimulation::ParticleSimulation vk_particle_simulation;
+
+	// a surface format change recreates the render pass, the pipeline drawn with is rebuilt by then, the placeholder, the variants and the particles are not
+	vkHelper::Misc::vkRenderPassChanged render_pass_changed = [ & ] ( VkRenderPass renderPass , vkHelper::vkPipelineData const& rebuilt )
+	{
+		if ( &rebuilt != &vk_graphics_pipeline )
+		{
+			vkHelper::Misc::RebuildPipeline ( vk_logical_device , renderPass , vk_graphics_pipeline );
+		}
+		if ( pipeline_variants_ > 0 )
+		{
+			vk_pipeline_compiler.Rebind ( renderPass , &rebuilt );
+		}
+		vk_particle_simulation.Rebind ( renderPass );
+	};
 
 	// create swap chain framebuffers
 	std::vector<VkFramebuffer> vk_framebuffers;
@@ -167,81 +567,717 @@ int main ( int argc , char* argv[] )
 	{
 		throw std::runtime_error ( "Failed to create VkFramebuffers" );
 	}
-	std::cout << "### VkFramebuffers created successfully." << std::endl;
+	VKLOG_INFO ( "### VkFramebuffers created successfully." );
 
 	// create command pool
 	VkCommandPool vk_command_pool;
-	if ( ( vk_command_pool = vkHelper::Create::vkCommandPool ( vk_physical_device , vk_surface , vk_logical_device ) ) == VK_NULL_HANDLE )
+	if ( ( vk_command_pool = vkHelper::Create::vkCommandPool ( vk_device_profile , vk_logical_device ) ) == VK_NULL_HANDLE )
 	{
 		throw std::runtime_error ( "Failed to create VkCommandPool" );
 	}
-	std::cout << "### VkCommandPool created successfully." << std::endl;
+	VKLOG_INFO ( "### VkCommandPool created successfully." );
 
-	// create command buffers
+	// create frame timings, timestamps are recorded into the command buffers
+	vkHelper::vkFrameTimingData vk_frame_timings;
+	if ( !vkHelper::Create::FrameTimings ( vk_device_profile , vk_logical_device , vk_frame_timings ) )
+	{
+		throw std::runtime_error ( "Failed to create frame timings" );
+	}
+	VKLOG_INFO ( "### Frame timings created successfully." );
+
+	// create command buffers, either prerecorded once per image or re-recorded every frame from transient pools
 	std::vector<VkCommandBuffer> vk_command_buffers;
-	if ( !vkHelper::Create::vkCommandBuffers ( vk_logical_device , vk_swapchain_data , vk_render_pass , vk_graphics_pipeline , vk_framebuffers , vk_command_pool , vk_command_buffers ) )
+	vkHelper::vkFrameCommandData vk_frame_commands;
+	if ( record_per_frame_ )
 	{
-		throw std::runtime_error ( "Failed to create command buffers" );
+		if ( !vkHelper::Create::vkFrameCommands ( vk_device_profile , vk_logical_device , vk_frame_commands , static_cast< uint32_t >( record_threads_ ) , static_cast< uint32_t >( draw_count_ ) , frame_slots ) )
+		{
+			throw std::runtime_error ( "Failed to create frame command pools" );
+		}
+		VKLOG_INFO ( "### Frame command pools created successfully." );
+	}
+	else
+	{
+		if ( !vkHelper::Create::vkCommandBuffers ( vk_logical_device , vk_swapchain_data , vk_render_pass , vk_graphics_pipeline , vk_framebuffers , vk_command_pool , vk_command_buffers , &vk_frame_timings ) )
+		{
+			throw std::runtime_error ( "Failed to create command buffers" );
+		}
+		VKLOG_INFO ( "### VkCommandBuffers created successfully." );
+	}
+	vkHelper::vkFrameCommandData* frame_commands = record_per_frame_ ? &vk_frame_commands : nullptr;
+
+	// create instanced mesh, every instance is drawn by one draw call
+	// culled instances are spread past the screen so the frustum has something to reject
+	float instance_extent = gpu_cull_ ? 2.0f : 1.0f;
+	vkMesh::InstancedMesh vk_instanced_mesh;
+	if ( instanced_ )
+	{
+		if ( !vk_instanced_mesh.Initialize ( vk_allocator , vk_staging_ring , vkMesh::TriangleVertices () , vkMesh::TriangleIndices () , static_cast< uint32_t >( std::max ( instance_count_ , 1 ) ) ) ||
+			!vk_instanced_mesh.SetInstances ( vkMesh::GridInstances ( static_cast< uint32_t >( std::max ( instance_count_ , 1 ) ) , instance_extent ) ) )
+		{
+			throw std::runtime_error ( "Failed to create instanced mesh" );
+		}
+		vk_frame_commands.draw_ = vk_instanced_mesh.DrawData ();
+		VKLOG_INFO ( "### Instanced mesh created successfully." );
+
+		// every frame rewrites its draws' constants in its own region of the ring
+		vk_frame_commands.update_ = [ &vk_uniform_ring , &vk_frame_sets , draw_count_ ] ( size_t frame , vkHelper::vkDrawData& draw )
+		{
+			vk_uniform_ring.BeginFrame ( frame );
+			vk_frame_sets.BeginFrame ( frame );
+			uint32_t draws = static_cast< uint32_t >( draw_count_ );
+			vkHelper::vkDrawConstants* constants = vk_uniform_ring.AllocateArray<vkHelper::vkDrawConstants> ( draws , draw.uniform_offset_ , draw.uniform_stride_ );
+			if ( constants == nullptr )
+			{
+				return false;
+			}
+
+			char* element = reinterpret_cast< char* >( constants );
+			for ( uint32_t i = 0; i < draws; ++i , element += draw.uniform_stride_ )
+			{
+				*reinterpret_cast< vkHelper::vkDrawConstants* >( element ) = vkMesh::FadedDrawConstants ( i , draws );
+			}
+			draw.uniform_set_ = vk_uniform_ring.Set ();
+			return true;
+		};
 	}
-	std::cout << "### VkCommandBuffers created successfully." << std::endl;
+
+	// create gpu culler, it records a compute pass ahead of every frame and the frame draws its results indirectly
+	vkCulling::GpuCuller vk_gpu_culler;
+	if ( gpu_cull_ )
+	{
+		vkCulling::GpuCuller::Parameters cull_params;
+		cull_params.max_objects_ = static_cast< uint32_t >( instance_bench_frames_ > 0 ? std::max ( instance_count_ , 1000000 ) : std::max ( instance_count_ , 1 ) );
+		if ( !vk_gpu_culler.Initialize ( vk_device_profile , vk_logical_device , vk_allocator , vk_layout_cache , vk_frame_sets , vk_pipeline_cache , frame_slots , cull_params ) )
+		{
+			throw std::runtime_error ( "Failed to create gpu culler" );
+		}
+		vk_frame_commands.pre_pass_ = [ &vk_gpu_culler ] ( VkCommandBuffer commandBuffer , size_t frame , vkHelper::vkDrawData& draw )
+		{
+			return vk_gpu_culler.Record ( commandBuffer , frame , draw );
+		};
+		VKLOG_INFO ( "### Gpu culler created successfully." );
+	}
+
+	// create async compute, a particle simulation submitted to the compute queue every frame while the previous frame renders
+	// the frame's vertex input waits for its step, the particles are drawn over the frame's own draws
+	vkHelper::vkAsyncComputeData vk_async_compute;
+	if ( async_particles_ > 0 )
+	{
+		vkSimulation::ParticleSimulation::Parameters simulation_params;
+		simulation_params.particle_count_ = static_cast< uint32_t >( async_particles_ );
+		if ( !vk_particle_simulation.Initialize ( vk_device_profile , vk_logical_device , vk_allocator , vk_layout_cache , vk_static_sets , vk_pipeline_cache , vk_render_pass , frame_slots , simulation_params ) ||
+			!vkHelper::Create::AsyncCompute ( vk_device_profile , vk_logical_device , vk_compute_queue , vk_async_compute , frame_slots ) )
+		{
+			throw std::runtime_error ( "Failed to create async compute" );
+		}
+		vk_async_compute.wait_stage_ = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+		vk_async_compute.record_ = [ &vk_particle_simulation ] ( VkCommandBuffer commandBuffer , size_t frame )
+		{
+			return vk_particle_simulation.Record ( commandBuffer , frame );
+		};
+		vk_async_compute.acquire_ = [ &vk_particle_simulation ] ( VkCommandBuffer commandBuffer , size_t frame )
+		{
+			vk_particle_simulation.Acquire ( commandBuffer , frame );
+		};
+		vk_async_compute.draw_ = [ &vk_particle_simulation ] ( VkCommandBuffer commandBuffer , size_t frame )
+		{
+			vk_particle_simulation.Draw ( commandBuffer , frame );
+		};
+		VKLOG_INFO ( "### Async compute created successfully" ,
+			( vk_device_profile.indices_.HasDedicatedCompute () ? "." : ", sharing the graphics queue." ) );
+	}
+	vkHelper::vkAsyncComputeData* async_compute = async_particles_ > 0 ? &vk_async_compute : nullptr;
 
 	// create sync objects
 	vkHelper::vkSyncObjects vk_sync_objects;
-	if ( !vkHelper::Create::SyncObjects ( vk_logical_device , vk_swapchain_data , vk_sync_objects ) )
+	if ( !vkHelper::Create::SyncObjects ( vk_logical_device , vk_swapchain_data , vk_sync_objects , bench_params.frames_in_flight_ ) )
 	{
 		throw std::runtime_error ( "Failed to create vkSyncObjects" );
 	}
-	std::cout << "### vkSyncObjects created successfully." << std::endl;
+	VKLOG_INFO ( "### vkSyncObjects created successfully." );
+
+	startup_zone.End ();
+	vkBench::Results bench_results;
+	bench_results.startup_ms_ = std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - program_start ).count ();
+	bench_results.present_mode_ = vk_swapchain_data.present_mode_;
+	std::vector<vkTrace::Total> create_totals;
+	if ( perf_ )
+	{
+		// the variant workers record Create:: zones too, they must be done before the totals read their events
+		if ( pipeline_variants_ > 0 )
+		{
+			vk_pipeline_compiler.WaitIdle ();
+		}
+		// taken now, swap chain recreation below goes through some of the same create steps
+		create_totals = vkTrace::Totals ( "Create::" );
 
-	std::cout << "### Setup complete.\n### Press any key to continue!" << std::endl;
+		// the timed frames and resizes must not pay for recording zones nobody asked for
+		if ( trace_file_.empty () )
+		{
+			vkTrace::Stop ();
+		}
+	}
+	vkLog::Flush ();
+	vk_startup.Report ( std::cout );
+	std::cout << "### Setup complete." << std::endl;
 
 	size_t current_frame { 0 };
-	while ( !window.WindowShouldClose () )
+
+	// resize storm, resize every frame and track the worst frame hitch
+	if ( resize_storm_ > 0 )
+	{
+		double worst_ms { 0.0 };
+		double total_ms { 0.0 };
+		for ( int i = 0; i < resize_storm_; ++i )
+		{
+			VkExtent2D extent = ( i % 2 ) ? VkExtent2D { 500, 300 } : VkExtent2D { 640, 360 };
+
+			auto start = std::chrono::high_resolution_clock::now ();
+			if ( headless_ )
+			{
+				vkHelper::Misc::ResizeOffscreenTarget ( vk_device_profile , vk_logical_device , extent , vk_swapchain_data , vk_render_pass , vk_graphics_pipeline ,
+					vk_framebuffers , vk_command_pool , vk_command_buffers , vk_sync_objects , &vk_frame_timings );
+			}
+#ifdef _WIN32
+			else
+			{
+				// DrawFrame picks the resize up as an out of date or suboptimal swap chain
+				window.Resize ( static_cast< int >( extent.width ) , static_cast< int >( extent.height ) );
+				window.PollEvents ();
+			}
+#endif
+			vkHelper::Misc::DrawFrame (
+				vk_device_profile ,
+				vk_logical_device ,
+				vk_graphics_queue ,
+				vk_present_queue ,
+				vk_swapchain_data ,
+				vk_render_pass ,
+				vk_graphics_pipeline ,
+				vk_framebuffers ,
+				vk_command_pool ,
+				vk_command_buffers ,
+				vk_sync_objects ,
+				current_frame ,
+				&vk_frame_timings ,
+				frame_commands ,
+				async_compute ,
+				&render_pass_changed );
+			auto end = std::chrono::high_resolution_clock::now ();
+
+			double frame_ms = std::chrono::duration<double , std::milli> ( end - start ).count ();
+			worst_ms = std::max ( worst_ms , frame_ms );
+			total_ms += frame_ms;
+		}
+		std::cout << "### Resize storm: " << resize_storm_ << " resizes, mean frame " << total_ms / resize_storm_
+			<< " ms, worst hitch " << worst_ms << " ms" << std::endl;
+	}
+
+	// record benchmark, per frame recording of draw_count_ draws inline and then on 1, 2, 4 ... worker threads
+	if ( record_bench_frames_ > 0 )
 	{
-		window.PollEvents ();
-		if ( window.WindowShouldClose () )
+		uint32_t max_threads = std::max ( std::thread::hardware_concurrency () , 1u );
+		std::vector<uint32_t> thread_counts { 0 };
+		for ( uint32_t threads = 1; threads <= max_threads; threads *= 2 )
 		{
-			break;
+			thread_counts.push_back ( threads );
 		}
+		if ( thread_counts.back () != max_threads )
+		{
+			thread_counts.push_back ( max_threads );
+		}
+
+		std::cout << "### Record benchmark: " << draw_count_ << " draws, " << record_bench_frames_ << " frames per run" << std::endl;
+		double inline_p50 { 0.0 };
+		for ( uint32_t threads : thread_counts )
+		{
+			vkHelper::vkFrameCommandData bench_commands;
+			if ( !vkHelper::Create::vkFrameCommands ( vk_device_profile , vk_logical_device , bench_commands , threads , static_cast< uint32_t >( draw_count_ ) , frame_slots ) )
+			{
+				throw std::runtime_error ( "Failed to create benchmark frame command pools" );
+			}
+			bench_commands.draw_ = vk_frame_commands.draw_;
+			bench_commands.update_ = vk_frame_commands.update_;
+			bench_commands.pre_pass_ = vk_frame_commands.pre_pass_;
+
+			vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+			for ( int frame = 0; frame < record_bench_frames_; ++frame )
+			{
+				vkHelper::Misc::DrawFrame (
+					vk_device_profile ,
+					vk_logical_device ,
+					vk_graphics_queue ,
+					vk_present_queue ,
+					vk_swapchain_data ,
+					vk_render_pass ,
+					vk_graphics_pipeline ,
+					vk_framebuffers ,
+					vk_command_pool ,
+					vk_command_buffers ,
+					vk_sync_objects ,
+					current_frame ,
+					&vk_frame_timings ,
+					&bench_commands ,
+					async_compute ,
+					&render_pass_changed );
+			}
+			vkDeviceWaitIdle ( vk_logical_device );
 
-		// process vulkan draw logic
-		vkHelper::Misc::DrawFrame (
-			vk_physical_device ,
-			vk_surface ,
-			vk_logical_device ,
-			vk_graphics_queue ,
-			vk_present_queue ,
-			vk_swapchain_data ,
-			vk_render_pass ,
-			vk_graphics_pipeline ,
-			vk_framebuffers ,
-			vk_command_pool ,
-			vk_command_buffers ,
-			vk_sync_objects ,
-			current_frame );
+			double p50 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::record_ms_ , 0.50 );
+			double p95 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::record_ms_ , 0.95 );
+			if ( threads == 0 )
+			{
+				inline_p50 = p50;
+			}
+			std::cout << "\t- " << ( threads == 0 ? std::string ( "inline" ) : std::to_string ( threads ) + " threads" )
+				<< "\trecord p50 " << p50 << " ms\tp95 " << p95 << " ms"
+				<< "\tspeedup " << ( p50 > 0.0 ? inline_p50 / p50 : 0.0 ) << "x" << std::endl;
+
+			vkHelper::Misc::DestroyFrameCommands ( vk_logical_device , bench_commands );
+		}
+		vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
 	}
 
+	// instance benchmark, one instanced draw of 1, 10, 100 ... 1M instances
+	if ( instance_bench_frames_ > 0 )
+	{
+		std::cout << "### Instance benchmark: " << draw_count_ << " draws, " << instance_bench_frames_ << " frames per run" << std::endl;
+		for ( uint32_t instances = 1; instances <= 1000000; instances *= 10 )
+		{
+			// the instance buffer may be replaced, nothing may still read it
+			vkDeviceWaitIdle ( vk_logical_device );
+			if ( !vk_instanced_mesh.SetInstances ( vkMesh::GridInstances ( instances , instance_extent ) ) )
+			{
+				throw std::runtime_error ( "Failed to upload benchmark instances" );
+			}
+			vk_frame_commands.draw_ = vk_instanced_mesh.DrawData ();
+
+			vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+			for ( int frame = 0; frame < instance_bench_frames_; ++frame )
+			{
+				vkHelper::Misc::DrawFrame (
+					vk_device_profile ,
+					vk_logical_device ,
+					vk_graphics_queue ,
+					vk_present_queue ,
+					vk_swapchain_data ,
+					vk_render_pass ,
+					vk_graphics_pipeline ,
+					vk_framebuffers ,
+					vk_command_pool ,
+					vk_command_buffers ,
+					vk_sync_objects ,
+					current_frame ,
+					&vk_frame_timings ,
+					frame_commands ,
+					async_compute ,
+					&render_pass_changed );
+			}
+			vkDeviceWaitIdle ( vk_logical_device );
+
+			double frame_p50 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::frame_ms_ , 0.50 );
+			double record_p50 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::record_ms_ , 0.50 );
+			double gpu_p50 = vkHelper::Misc::GpuPercentile ( vk_frame_timings , 0.50 );
+			std::cout << "\t- " << instances << " instances"
+				<< "\tframe p50 " << frame_p50 << " ms\trecord p50 " << record_p50 << " ms\tgpu p50 " << gpu_p50 << " ms"
+				<< "\t" << ( gpu_p50 > 0.0 ? instances / gpu_p50 : 0.0 ) << " instances/ms" << std::endl;
+		}
+		vkDeviceWaitIdle ( vk_logical_device );
+		if ( !vk_instanced_mesh.SetInstances ( vkMesh::GridInstances ( static_cast< uint32_t >( std::max ( instance_count_ , 1 ) ) , instance_extent ) ) )
+		{
+			throw std::runtime_error ( "Failed to upload instances" );
+		}
+		vk_frame_commands.draw_ = vk_instanced_mesh.DrawData ();
+		vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+	}
+
+	// push constant benchmark, the same draws with their constants written to the uniform ring or pushed
+	if ( push_bench_frames_ > 0 )
+	{
+		vkHelper::vkPipelineData vk_push_pipeline;
+		if ( ( vk_push_pipeline = vkHelper::Create::vkGraphicsPipeline ( vk_logical_device , vk_render_pass , vk_pipeline_cache , true , {} ,
+			sizeof ( vkHelper::vkDrawConstants ) , &vk_shader_cache ) ).pipeline_ == VK_NULL_HANDLE )
+		{
+			throw std::runtime_error ( "Failed to create push constant pipeline" );
+		}
+
+		// both paths compute their constants every frame, only where they go differs
+		std::vector<vkHelper::vkDrawConstants> push_constants ( static_cast< size_t >( draw_count_ ) );
+		auto uniform_update = vk_frame_commands.update_;
+		auto push_update = [ &vk_frame_sets , &push_constants ] ( size_t frame , vkHelper::vkDrawData& draw )
+		{
+			vk_frame_sets.BeginFrame ( frame );
+			uint32_t draws = static_cast< uint32_t >( push_constants.size () );
+			for ( uint32_t i = 0; i < draws; ++i )
+			{
+				push_constants[ i ] = vkMesh::FadedDrawConstants ( i , draws );
+			}
+			draw.uniform_set_ = VK_NULL_HANDLE;
+			draw.push_constants_ = push_constants.data ();
+			return true;
+		};
+
+		std::cout << "### Push constant benchmark: " << draw_count_ << " draws, " << push_bench_frames_ << " frames per run" << std::endl;
+		double uniform_record_p50 { 0.0 };
+		for ( int push = 0; push < 2; ++push )
+		{
+			vkHelper::vkPipelineData& pipeline = push ? vk_push_pipeline : vk_graphics_pipeline;
+			if ( push )
+			{
+				vk_frame_commands.update_ = push_update;
+			}
+			else
+			{
+				vk_frame_commands.update_ = uniform_update;
+			}
+
+			vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+			for ( int frame = 0; frame < push_bench_frames_; ++frame )
+			{
+				vkHelper::Misc::DrawFrame (
+					vk_device_profile ,
+					vk_logical_device ,
+					vk_graphics_queue ,
+					vk_present_queue ,
+					vk_swapchain_data ,
+					vk_render_pass ,
+					pipeline ,
+					vk_framebuffers ,
+					vk_command_pool ,
+					vk_command_buffers ,
+					vk_sync_objects ,
+					current_frame ,
+					&vk_frame_timings ,
+					frame_commands ,
+					async_compute ,
+					&render_pass_changed );
+			}
+			vkDeviceWaitIdle ( vk_logical_device );
+
+			double frame_p50 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::frame_ms_ , 0.50 );
+			double record_p50 = vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::record_ms_ , 0.50 );
+			double gpu_p50 = vkHelper::Misc::GpuPercentile ( vk_frame_timings , 0.50 );
+			std::cout << "\t- " << ( push ? "push constants" : "uniform ring  " )
+				<< "\tframe p50 " << frame_p50 << " ms\trecord p50 " << record_p50 << " ms\tgpu p50 " << gpu_p50 << " ms";
+			if ( push && uniform_record_p50 > 0.0 )
+			{
+				std::cout << "\t(" << 100.0 * record_p50 / uniform_record_p50 << "% of the uniform ring's record time)";
+			}
+			std::cout << std::endl;
+			uniform_record_p50 = push ? uniform_record_p50 : record_p50;
+		}
+
+		vk_frame_commands.update_ = uniform_update;
+		vk_frame_commands.draw_.push_constants_ = nullptr;
+		vkHelper::Misc::DestroyPipeline ( vk_logical_device , vk_push_pipeline );
+		vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+	}
+
+	// frames in flight sweep, throughput against cpu start to gpu completion latency at every queue depth
+	if ( latency_sweep_frames_ > 0 )
+	{
+		auto set_frames_in_flight = [ & ] ( uint32_t framesInFlight )
+		{
+			// nothing may still wait on the old semaphores and fences, retired swap chains are tracked per old slot
+			vkDeviceWaitIdle ( vk_logical_device );
+			vkHelper::Misc::ReleaseRetiredSwapChains ( vk_logical_device , vk_command_pool , vk_sync_objects , 0 , true );
+			vkHelper::Misc::DestroySyncObjects ( vk_logical_device , vk_sync_objects );
+			if ( !vkHelper::Create::SyncObjects ( vk_logical_device , vk_swapchain_data , vk_sync_objects , framesInFlight ) )
+			{
+				throw std::runtime_error ( "Failed to recreate vkSyncObjects" );
+			}
+			current_frame = 0;
+		};
+
+		std::cout << "### Frames in flight sweep: " << bench_params.warmup_frames_ << " warm up and " << latency_sweep_frames_ << " timed frames per depth" << std::endl;
+		for ( uint32_t depth = 1; depth <= vkHelper::Create::MAX_FRAMES_IN_FLIGHT; ++depth )
+		{
+			set_frames_in_flight ( depth );
+			auto start = std::chrono::high_resolution_clock::now ();
+			for ( int frame = -static_cast< int >( bench_params.warmup_frames_ ); frame < latency_sweep_frames_; ++frame )
+			{
+				if ( frame == 0 )
+				{
+					// no wait for idle, the timed frames have to start on a full queue
+					vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+					start = std::chrono::high_resolution_clock::now ();
+				}
+				vkHelper::Misc::DrawFrame (
+					vk_device_profile ,
+					vk_logical_device ,
+					vk_graphics_queue ,
+					vk_present_queue ,
+					vk_swapchain_data ,
+					vk_render_pass ,
+					frame_pipeline () ,
+					vk_framebuffers ,
+					vk_command_pool ,
+					vk_command_buffers ,
+					vk_sync_objects ,
+					current_frame ,
+					&vk_frame_timings ,
+					frame_commands ,
+					async_compute ,
+					&render_pass_changed );
+			}
+			vkDeviceWaitIdle ( vk_logical_device );
+			double elapsed_ms = std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - start ).count ();
+
+			std::cout << "\t- " << depth << " in flight"
+				<< "\tfps " << ( elapsed_ms > 0.0 ? latency_sweep_frames_ * 1000.0 / elapsed_ms : 0.0 )
+				<< "\tlatency p50 " << vkHelper::Misc::LatencyPercentile ( vk_frame_timings , 0.50 ) << " ms"
+				<< "\tp95 " << vkHelper::Misc::LatencyPercentile ( vk_frame_timings , 0.95 ) << " ms"
+				<< "\tframe p50 " << vkHelper::Misc::CpuPercentile ( vk_frame_timings , &vkHelper::vkFrameTimingData::Sample::frame_ms_ , 0.50 ) << " ms"
+				<< "\tgpu p50 " << vkHelper::Misc::GpuPercentile ( vk_frame_timings , 0.50 ) << " ms" << std::endl;
+		}
+		set_frames_in_flight ( bench_params.frames_in_flight_ );
+		vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+	}
+
+	if ( headless_ || benchmark_ || perf_ )
+	{
+		// render a fixed number of frames as fast as possible and report throughput, a benchmark warms up first
+		int warmup_frames = benchmark_ || perf_ ? static_cast< int >( bench_params.warmup_frames_ ) : 0;
+		int timed_frames = static_cast< int >( bench_params.frames_ );
+		bench_results.frame_ms_.reserve ( bench_params.frames_ );
+		auto start = std::chrono::high_resolution_clock::now ();
+		for ( int frame = -warmup_frames; frame < timed_frames; ++frame )
+		{
+			if ( frame == 0 && warmup_frames > 0 )
+			{
+				// the warm up's frames are still in flight, they must not count against the first timed one
+				vkDeviceWaitIdle ( vk_logical_device );
+				vkHelper::Misc::ResetFrameTimings ( vk_frame_timings );
+				start = std::chrono::high_resolution_clock::now ();
+			}
+
+			auto frame_start = std::chrono::high_resolution_clock::now ();
+#ifdef _WIN32
+			if ( !headless_ )
+			{
+				window.PollEvents ();
+				if ( window.WindowShouldClose () )
+				{
+					break;
+				}
+			}
+#endif
+			vkHelper::Misc::DrawFrame (
+				vk_device_profile ,
+				vk_logical_device ,
+				vk_graphics_queue ,
+				vk_present_queue ,
+				vk_swapchain_data ,
+				vk_render_pass ,
+				frame_pipeline () ,
+				vk_framebuffers ,
+				vk_command_pool ,
+				vk_command_buffers ,
+				vk_sync_objects ,
+				current_frame ,
+				&vk_frame_timings ,
+				frame_commands ,
+				async_compute ,
+				&render_pass_changed );
+
+			if ( frame >= 0 )
+			{
+				bench_results.frame_ms_.push_back ( std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - frame_start ).count () );
+			}
+		}
+		vkDeviceWaitIdle ( vk_logical_device );
+		auto end = std::chrono::high_resolution_clock::now ();
+
+		double elapsed_ms = std::chrono::duration<double , std::milli> ( end - start ).count ();
+		size_t frames = bench_results.frame_ms_.size ();
+		bench_results.elapsed_ms_ = elapsed_ms;
+		std::cout << "### " << ( headless_ ? "Offscreen" : "On screen" ) << ": " << frames << " frames in " << elapsed_ms << " ms ("
+			<< ( elapsed_ms > 0.0 ? frames * 1000.0 / elapsed_ms : 0.0 ) << " fps)" << std::endl;
+
+		// read the last frame back to host memory
+		std::vector<char> pixels;
+		if ( headless_ && frames > 0 && vkHelper::Misc::ReadbackImage ( vk_logical_device , vk_swapchain_data , vk_sync_objects , vk_swapchain_data.last_image_ , pixels ) )
+		{
+			std::cout << "### Offscreen: read back " << pixels.size () << " bytes of the last frame." << std::endl;
+		}
+
+		if ( benchmark_ )
+		{
+			// the timing ring holds the most recent gpu times, all of them unless the run was longer than the ring
+			size_t gpu_count = std::min ( vk_frame_timings.gpu_count_ , vk_frame_timings.gpu_samples_.size () );
+			bench_results.gpu_ms_.assign ( vk_frame_timings.gpu_samples_.begin () , vk_frame_timings.gpu_samples_.begin () + gpu_count );
+			bench_results.peak_device_memory_ = vk_allocator.PeakReserved ();
+			bench_results.peak_process_memory_ = vkBench::PeakProcessMemory ();
+			vkBench::WriteJson ( benchmark_file_ , vk_device_profile , bench_params , bench_results );
+		}
+
+		if ( perf_ )
+		{
+			// swap chain recreate loop, every resize rebuilds the swap chain or offscreen images and draws one frame on them
+			std::vector<double> resize_ms;
+			for ( int i = 0; i < perf_resizes_; ++i )
+			{
+				VkExtent2D extent = ( i % 2 ) ? VkExtent2D { bench_params.width_, bench_params.height_ } : VkExtent2D { bench_params.width_ * 5 / 4, bench_params.height_ * 5 / 4 };
+
+				auto start = std::chrono::high_resolution_clock::now ();
+				if ( headless_ )
+				{
+					vkHelper::Misc::ResizeOffscreenTarget ( vk_device_profile , vk_logical_device , extent , vk_swapchain_data , vk_render_pass , frame_pipeline () ,
+						vk_framebuffers , vk_command_pool , vk_command_buffers , vk_sync_objects , &vk_frame_timings );
+				}
+#ifdef _WIN32
+				else
+				{
+					window.Resize ( static_cast< int >( extent.width ) , static_cast< int >( extent.height ) );
+					window.PollEvents ();
+				}
+#endif
+				vkHelper::Misc::DrawFrame (
+					vk_device_profile ,
+					vk_logical_device ,
+					vk_graphics_queue ,
+					vk_present_queue ,
+					vk_swapchain_data ,
+					vk_render_pass ,
+					frame_pipeline () ,
+					vk_framebuffers ,
+					vk_command_pool ,
+					vk_command_buffers ,
+					vk_sync_objects ,
+					current_frame ,
+					&vk_frame_timings ,
+					frame_commands ,
+					async_compute ,
+					&render_pass_changed );
+				resize_ms.push_back ( std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - start ).count () );
+			}
+			vkDeviceWaitIdle ( vk_logical_device );
+
+			// medians and tails rather than means, one descheduled frame must not fail the gate
+			vkPerf::Suite suite;
+			suite.Add ( "Startup" , bench_results.startup_ms_ );
+			for ( auto const& total : create_totals )
+			{
+				suite.Add ( total.name_ , total.ms_ );
+			}
+			vkBench::Statistics frame = vkBench::Summarize ( bench_results.frame_ms_ );
+			suite.Add ( "DrawFrame.p50" , frame.p50_ );
+			suite.Add ( "DrawFrame.p95" , frame.p95_ );
+			vkBench::Statistics resize = vkBench::Summarize ( resize_ms );
+			suite.Add ( "Resize.p50" , resize.p50_ );
+			suite.Add ( "Resize.p95" , resize.p95_ );
+
+			std::string device = vk_device_profile.properties_.deviceName;
+			vkLog::Flush ();
+			if ( !perf_record_file_.empty () )
+			{
+				perf_passed_ = suite.Record ( perf_record_file_ , device , {} );
+			}
+			if ( !perf_gate_file_.empty () )
+			{
+				perf_passed_ = suite.Compare ( perf_gate_file_ , device , {} , std::cout ) && perf_passed_;
+			}
+		}
+	}
+#ifdef _WIN32
+	else
+	{
+		while ( !window.WindowShouldClose () )
+		{
+			window.PollEvents ();
+			if ( window.WindowShouldClose () )
+			{
+				break;
+			}
+
+			// process vulkan draw logic
+			vkHelper::Misc::DrawFrame (
+				vk_device_profile ,
+				vk_logical_device ,
+				vk_graphics_queue ,
+				vk_present_queue ,
+				vk_swapchain_data ,
+				vk_render_pass ,
+				frame_pipeline () ,
+				vk_framebuffers ,
+				vk_command_pool ,
+				vk_command_buffers ,
+				vk_sync_objects ,
+				current_frame ,
+				&vk_frame_timings ,
+				frame_commands ,
+				async_compute ,
+				&render_pass_changed );
+		}
+	}
+#endif
+
 	vkDeviceWaitIdle ( vk_logical_device );
 
+	vkHelper::Misc::ReleaseRetiredSwapChains ( vk_logical_device , vk_command_pool , vk_sync_objects , 0 , true );
+
+	// the reports write to std::cout directly, keep them after everything logged so far
+	vkLog::Flush ();
+
+	vkHelper::Misc::ReportFrameTimings ( vk_frame_timings , std::cout );
+	if ( async_compute )
+	{
+		vkHelper::Misc::ReportComputeOverlap ( vk_async_compute , std::cout );
+	}
+	vkHelper::Misc::DestroyFrameTimings ( vk_logical_device , vk_frame_timings );
+
 	// clean up code
 	vkHelper::Misc::CleanUpSwapChain (
 		vk_logical_device, 
 		vk_swapchain_data, 
-		vk_render_pass, 
-		vk_graphics_pipeline, 
 		vk_framebuffers, 
 		vk_command_pool, 
 		vk_command_buffers
 	);
 
+	if ( pipeline_variants_ > 0 )
+	{
+		vk_pipeline_compiler.Report ( std::cout );
+		vk_pipeline_compiler.Destroy ();
+	}
+	vkHelper::Misc::DestroyPipeline ( vk_logical_device , vk_graphics_pipeline );
+	vkDestroyRenderPass ( vk_logical_device , vk_render_pass , nullptr );
+
 	vkDestroyCommandPool ( vk_logical_device , vk_command_pool , nullptr );
+	vkHelper::Misc::DestroyFrameCommands ( vk_logical_device , vk_frame_commands );
+
+	// write the pipeline cache back for the next run
+	if ( !pipeline_cache_path_.empty () )
+	{
+		vkHelper::IO::SavePipelineCache ( vk_device_profile , vk_logical_device , vk_pipeline_cache , pipeline_cache_path_ );
+	}
+	vkDestroyPipelineCache ( vk_logical_device , vk_pipeline_cache , nullptr );
 
-	for ( size_t i = 0; i < vkHelper::Create::MAX_FRAMES_IN_FLIGHT; i++ )
+	vkHelper::Misc::ReportShaderCache ( vk_shader_cache , std::cout );
+	vkHelper::Misc::DestroyShaderCache ( vk_logical_device , vk_shader_cache );
+
+	vkHelper::Misc::DestroySyncObjects ( vk_logical_device , vk_sync_objects );
+
+	vkHelper::Misc::DestroyAsyncCompute ( vk_logical_device , vk_async_compute );
+	vk_particle_simulation.Destroy ();
+	vk_gpu_culler.Destroy ();
+	vk_instanced_mesh.Destroy ();
+	if ( instanced_ )
 	{
-		vkDestroySemaphore ( vk_logical_device , vk_sync_objects.finished_semaphores_[ i ] , nullptr );
-		vkDestroySemaphore ( vk_logical_device , vk_sync_objects.available_semaphores_[ i ] , nullptr );
-		vkDestroyFence ( vk_logical_device , vk_sync_objects.in_flight_fences_[ i ] , nullptr );
+		std::cout << "### Uniform ring: at most " << vk_uniform_ring.HighWater () << " bytes used in a frame." << std::endl;
 	}
+	vk_uniform_ring.Destroy ();
+
+	std::cout << "### Descriptor sets reset per frame:\n";
+	vk_frame_sets.Report ( std::cout );
+	vk_frame_sets.Destroy ();
+	vk_static_sets.Destroy ();
+	vk_layout_cache.Destroy ();
+	vk_staging_ring.Destroy ();
+
+	vk_allocator.Report ( std::cout );
+	vk_allocator.Destroy ();
 
 	vkDestroyDevice ( vk_logical_device , nullptr );
 
@@ -252,10 +1288,20 @@ int main ( int argc , char* argv[] )
 	}
 
 	// destroy surface, happens before destroy instance
-	vkDestroySurfaceKHR ( vk_instance , vk_surface , nullptr );
+	if ( vk_surface != VK_NULL_HANDLE )
+	{
+		vkDestroySurfaceKHR ( vk_instance , vk_surface , nullptr );
+	}
 
 	// destroy vkinstance before program exits
 	vkDestroyInstance ( vk_instance , nullptr );
 
-	return 1;
+	if ( !trace_file_.empty () )
+	{
+		vkTrace::WriteJson ( trace_file_ );
+	}
+	vkLog::Shutdown ();
+
+	// 0 for ci, 2 tells a script the perf gate regressed or its baseline could not be used
+	return perf_passed_ ? 0 : 2;
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 450
+
+// binding 0, per vertex
+layout ( location = 0 ) in vec2 inPosition;
+layout ( location = 1 ) in vec3 inColor;
+
+// binding 1, per instance, transform is offset xy, scale and rotation
+layout ( location = 2 ) in vec4 inTransform;
+layout ( location = 3 ) in vec4 inInstanceColor;
+
+// per draw, matches vkHelper::vkDrawConstants, pushed with every draw
+layout ( push_constant ) uniform Draw
+{
+	vec4 offsetScale;
+	vec4 color;
+} draw;
+
+// specialization constants, vkHelper::INSTANCE_ROTATION and vkHelper::INSTANCE_TINT, a variant without them drops the branch
+layout ( constant_id = 0 ) const bool ROTATE = true;
+layout ( constant_id = 1 ) const bool TINT = true;
+
+layout ( location = 0 ) out vec3 fragColor;
+
+void main ()
+{
+	vec2 position = inPosition * inTransform.z;
+	if ( ROTATE )
+	{
+		float s = sin ( inTransform.w );
+		float c = cos ( inTransform.w );
+		position = mat2 ( c , s , -s , c ) * position;
+	}
+
+	gl_Position = vec4 ( ( position + inTransform.xy ) * draw.offsetScale.z + draw.offsetScale.xy , 0.0 , 1.0 );
+	fragColor = inColor * draw.color.rgb;
+	if ( TINT )
+	{
+		fragColor *= inInstanceColor.rgb;
+	}
+}
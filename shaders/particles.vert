@@ -0,0 +1,13 @@
+#version 450
+
+// binding 0, a simulation step's positions, see shaders/simulate.comp
+layout ( location = 0 ) in vec4 inPosition;
+
+layout ( location = 0 ) out vec3 fragColor;
+
+void main ()
+{
+	gl_Position = vec4 ( inPosition.xy , 0.0 , 1.0 );
+	gl_PointSize = 1.0;
+	fragColor = vec3 ( 1.0 , 0.8 , 0.3 );
+}
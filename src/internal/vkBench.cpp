@@ -0,0 +1,197 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkBench.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace vkBench
+{
+	using vkHelper::Misc::Percentile;
+
+	Statistics Summarize ( std::vector<double> samples )
+	{
+		Statistics statistics;
+		if ( samples.empty () )
+		{
+			return statistics;
+		}
+		std::sort ( samples.begin () , samples.end () );
+
+		double sum { 0.0 };
+		for ( double sample : samples )
+		{
+			sum += sample;
+		}
+		statistics.count_ = samples.size ();
+		statistics.mean_ = sum / static_cast< double >( samples.size () );
+
+		double variance { 0.0 };
+		for ( double sample : samples )
+		{
+			variance += ( sample - statistics.mean_ ) * ( sample - statistics.mean_ );
+		}
+		statistics.stddev_ = std::sqrt ( variance / static_cast< double >( samples.size () ) );
+
+		statistics.min_ = samples.front ();
+		statistics.p50_ = Percentile ( samples , 0.50 );
+		statistics.p90_ = Percentile ( samples , 0.90 );
+		statistics.p95_ = Percentile ( samples , 0.95 );
+		statistics.p99_ = Percentile ( samples , 0.99 );
+		statistics.max_ = samples.back ();
+		return statistics;
+	}
+
+	struct NamedPresentMode
+	{
+		char const*			name_;
+		VkPresentModeKHR	mode_;
+	};
+	static constexpr NamedPresentMode present_mode_names[] {
+		{ "fifo" , VK_PRESENT_MODE_FIFO_KHR } ,
+		{ "fifo-relaxed" , VK_PRESENT_MODE_FIFO_RELAXED_KHR } ,
+		{ "mailbox" , VK_PRESENT_MODE_MAILBOX_KHR } ,
+		{ "immediate" , VK_PRESENT_MODE_IMMEDIATE_KHR } };
+
+	bool ParsePresentMode ( char const* name , VkPresentModeKHR& mode )
+	{
+		for ( auto const& entry : present_mode_names )
+		{
+			if ( !std::strcmp ( name , entry.name_ ) )
+			{
+				mode = entry.mode_;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	char const* PresentModeName ( VkPresentModeKHR mode )
+	{
+		for ( auto const& entry : present_mode_names )
+		{
+			if ( entry.mode_ == mode )
+			{
+				return entry.name_;
+			}
+		}
+		return "unknown";
+	}
+
+	bool ParseSize ( char const* text , uint32_t& width , uint32_t& height )
+	{
+		char* end { nullptr };
+		unsigned long w = std::strtoul ( text , &end , 10 );
+		if ( end == text || ( *end != 'x' && *end != 'X' ) )
+		{
+			return false;
+		}
+		char const* rest = end + 1;
+		unsigned long h = std::strtoul ( rest , &end , 10 );
+		if ( end == rest || *end != '\0' || w == 0 || h == 0 || w > 16384 || h > 16384 )
+		{
+			return false;
+		}
+		width = static_cast< uint32_t >( w );
+		height = static_cast< uint32_t >( h );
+		return true;
+	}
+
+	size_t PeakProcessMemory ()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters {};
+		if ( GetProcessMemoryInfo ( GetCurrentProcess () , &counters , sizeof ( counters ) ) )
+		{
+			return counters.PeakWorkingSetSize;
+		}
+		return 0;
+#else
+		rusage usage {};
+		if ( getrusage ( RUSAGE_SELF , &usage ) != 0 )
+		{
+			return 0;
+		}
+#ifdef __APPLE__
+		return static_cast< size_t >( usage.ru_maxrss );
+#else
+		// kilobytes on linux
+		return static_cast< size_t >( usage.ru_maxrss ) * 1024;
+#endif
+#endif
+	}
+
+	static void WriteStatistics ( std::ofstream& file , char const* name , Statistics const& statistics )
+	{
+		file << ",\"" << name << "\":{\"count\":" << statistics.count_ << ",\"mean\":" << statistics.mean_ << ",\"stddev\":" << statistics.stddev_
+			<< ",\"min\":" << statistics.min_ << ",\"p50\":" << statistics.p50_ << ",\"p90\":" << statistics.p90_ << ",\"p95\":" << statistics.p95_
+			<< ",\"p99\":" << statistics.p99_ << ",\"max\":" << statistics.max_ << "}";
+	}
+
+	bool WriteJson ( std::string const& filename , vkHelper::vkDeviceProfile const& profile , Parameters const& params , Results const& results )
+	{
+		std::ofstream file ( filename , std::ios::app );
+		if ( !file )
+		{
+			VKLOG_FAILURE ( "### vkBench::WriteJson failed! Failed to open " , filename , "." );
+			return false;
+		}
+
+		// UTC, sorts the history by run
+		std::time_t now = std::time ( nullptr );
+		std::tm utc {};
+#ifdef _WIN32
+		gmtime_s ( &utc , &now );
+#else
+		gmtime_r ( &now , &utc );
+#endif
+		char timestamp[ 32 ];
+		std::strftime ( timestamp , sizeof ( timestamp ) , "%Y-%m-%dT%H:%M:%SZ" , &utc );
+
+		uint32_t api = profile.properties_.apiVersion;
+		file << "{\"timestamp\":\"" << timestamp << "\"";
+		file << ",\"device\":{\"name\":";
+		vkTrace::WriteJsonString ( file , profile.properties_.deviceName );
+		file << ",\"vendor_id\":" << profile.properties_.vendorID << ",\"device_id\":" << profile.properties_.deviceID
+			<< ",\"driver_version\":" << profile.properties_.driverVersion
+			<< ",\"api_version\":\"" << VK_VERSION_MAJOR ( api ) << "." << VK_VERSION_MINOR ( api ) << "." << VK_VERSION_PATCH ( api ) << "\"}";
+
+		file << ",\"config\":{\"target\":\"" << ( params.headless_ ? "offscreen" : "window" ) << "\",\"width\":" << params.width_ << ",\"height\":" << params.height_
+			<< ",\"present_mode\":\"" << ( params.headless_ ? "none" : PresentModeName ( results.present_mode_ ) ) << "\""
+			<< ",\"frames_in_flight\":" << params.frames_in_flight_ << ",\"warmup_frames\":" << params.warmup_frames_ << ",\"frames\":" << params.frames_ << "}";
+
+		file << ",\"startup_ms\":" << results.startup_ms_ << ",\"elapsed_ms\":" << results.elapsed_ms_
+			<< ",\"fps\":" << ( results.elapsed_ms_ > 0.0 ? results.frame_ms_.size () * 1000.0 / results.elapsed_ms_ : 0.0 );
+		WriteStatistics ( file , "frame_ms" , Summarize ( results.frame_ms_ ) );
+		WriteStatistics ( file , "gpu_ms" , Summarize ( results.gpu_ms_ ) );
+		file << ",\"peak_device_memory_bytes\":" << results.peak_device_memory_ << ",\"peak_process_memory_bytes\":" << results.peak_process_memory_ << "}\n";
+
+		if ( !file )
+		{
+			VKLOG_FAILURE ( "### vkBench::WriteJson failed! Failed to write " , filename , "." );
+			return false;
+		}
+		VKLOG_INFO ( "### Benchmark: " , results.frame_ms_.size () , " frames written to " , filename );
+		return true;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace vkBench
+{
+	/*!
+	 * @brief the benchmark run as given on the command line, written back into the report
+	*/
+	struct Parameters
+	{
+		uint32_t			width_ { 500 };
+		uint32_t			height_ { 300 };
+		VkPresentModeKHR	present_mode_ { VK_PRESENT_MODE_MAILBOX_KHR };	// ignored offscreen
+		uint32_t			frames_in_flight_ { vkHelper::Create::DEFAULT_FRAMES_IN_FLIGHT };
+		uint32_t			warmup_frames_ { 100 };
+		uint32_t			frames_ { 1000 };
+		bool				headless_ { false };
+	};
+
+	/*!
+	 * @brief what one run measured, frame_ms_ holds every timed frame, the warm up excluded
+	*/
+	struct Results
+	{
+		double				startup_ms_ { 0.0 };
+		double				elapsed_ms_ { 0.0 };
+		std::vector<double>	frame_ms_;
+		std::vector<double>	gpu_ms_;
+		VkPresentModeKHR	present_mode_ { VK_PRESENT_MODE_FIFO_KHR };		// the one the surface gave us
+		VkDeviceSize		peak_device_memory_ { 0 };
+		size_t				peak_process_memory_ { 0 };
+	};
+
+	struct Statistics
+	{
+		size_t	count_ { 0 };
+		double	mean_ { 0.0 };
+		double	stddev_ { 0.0 };
+		double	min_ { 0.0 };
+		double	p50_ { 0.0 };
+		double	p90_ { 0.0 };
+		double	p95_ { 0.0 };
+		double	p99_ { 0.0 };
+		double	max_ { 0.0 };
+	};
+
+	Statistics Summarize ( std::vector<double> samples );
+
+	/*!
+	 * @brief parses fifo, fifo-relaxed, mailbox or immediate
+	*/
+	bool ParsePresentMode ( char const* name , VkPresentModeKHR& mode );
+
+	char const* PresentModeName ( VkPresentModeKHR mode );
+
+	/*!
+	 * @brief parses WIDTHxHEIGHT, e.g. 1280x720
+	*/
+	bool ParseSize ( char const* text , uint32_t& width , uint32_t& height );
+
+	/*!
+	 * @brief peak resident memory of this process so far, in bytes, 0 if unknown
+	*/
+	size_t PeakProcessMemory ();
+
+	/*!
+	 * @brief appends the run as one line of json to filename, a file per configuration keeps its history
+	*/
+	bool WriteJson ( std::string const& filename , vkHelper::vkDeviceProfile const& profile , Parameters const& params , Results const& results );
+}
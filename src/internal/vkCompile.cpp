@@ -0,0 +1,245 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkCompile.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+
+namespace vkCompile
+{
+	bool PipelineCompiler::Initialize ( VkDevice logicalDevice , VkRenderPass renderPass , VkPipelineCache pipelineCache , vkHelper::vkShaderCacheData* shaderCache ,
+		vkHelper::vkPipelineData& placeholder , Parameters const& params )
+	{
+		if ( placeholder.pipeline_ == VK_NULL_HANDLE )
+		{
+			VKLOG_FAILURE ( "### vkCompile::PipelineCompiler::Initialize failed! The placeholder pipeline is not created." );
+			return false;
+		}
+
+		logical_device_ = logicalDevice;
+		render_pass_ = renderPass;
+		pipeline_cache_ = pipelineCache;
+		shader_cache_ = shaderCache;
+		placeholder_ = &placeholder;
+		stopping_ = false;
+
+		uint32_t thread_count = std::max ( params.thread_count_ , 1u );
+		for ( uint32_t i = 0; i < thread_count; ++i )
+		{
+			workers_.emplace_back ( &PipelineCompiler::Work , this );
+		}
+		return true;
+	}
+
+	using vkHelper::Misc::HashCombine;
+
+	size_t PipelineCompiler::HashVariant ( Variant const& variant )
+	{
+		size_t seed = variant.state_.constants_.Hash ();
+		HashCombine ( seed , variant.instanced_ );
+		HashCombine ( seed , variant.push_constant_size_ );
+		HashCombine ( seed , variant.state_.cull_mode_ );
+		HashCombine ( seed , static_cast< size_t >( variant.state_.front_face_ ) );
+		HashCombine ( seed , variant.state_.alpha_blend_ );
+		HashCombine ( seed , static_cast< size_t >( variant.state_.topology_ ) );
+		HashCombine ( seed , std::hash<std::string> {} ( variant.state_.vertex_shader_ ) );
+		HashCombine ( seed , variant.state_.position_stride_ );
+		for ( auto layout : variant.set_layouts_ )
+		{
+			HashCombine ( seed , std::hash<VkDescriptorSetLayout> {} ( layout ) );
+		}
+		return seed;
+	}
+
+	bool PipelineCompiler::SameVariant ( Variant const& lhs , Variant const& rhs )
+	{
+		return lhs.instanced_ == rhs.instanced_ && lhs.set_layouts_ == rhs.set_layouts_ && lhs.push_constant_size_ == rhs.push_constant_size_ &&
+			lhs.state_.cull_mode_ == rhs.state_.cull_mode_ && lhs.state_.front_face_ == rhs.state_.front_face_ &&
+			lhs.state_.alpha_blend_ == rhs.state_.alpha_blend_ && lhs.state_.constants_ == rhs.state_.constants_ &&
+			lhs.state_.topology_ == rhs.state_.topology_ && lhs.state_.vertex_shader_ == rhs.state_.vertex_shader_ &&
+			lhs.state_.position_stride_ == rhs.state_.position_stride_;
+	}
+
+	PipelineCompiler::Handle PipelineCompiler::Submit ( Variant const& variant )
+	{
+		// the same permutation is often asked for by several materials, compile it once
+		std::vector<Handle>& bucket = by_hash_[ HashVariant ( variant ) ];
+		for ( Handle handle : bucket )
+		{
+			if ( SameVariant ( slots_[ handle ].variant_ , variant ) )
+			{
+				++deduplicated_;
+				return handle;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock ( mutex_ );
+		if ( pending_ == 0 )
+		{
+			first_submit_ = std::chrono::high_resolution_clock::now ();
+		}
+
+		slots_.emplace_back ();
+		Slot& slot = slots_.back ();
+		slot.variant_ = variant;
+		queue_.push_back ( &slot );
+		++pending_;
+		work_ready_.notify_one ();
+
+		Handle handle = static_cast< Handle >( slots_.size () - 1 );
+		bucket.push_back ( handle );
+		return handle;
+	}
+
+	bool PipelineCompiler::Ready ( Handle handle ) const
+	{
+		// handles are only issued and read on the submitting thread, slots_ does not change under us
+		return handle < slots_.size () && slots_[ handle ].ready_.load ( std::memory_order_acquire ) && !slots_[ handle ].failed_.load ( std::memory_order_relaxed );
+	}
+
+	vkHelper::vkPipelineData& PipelineCompiler::Get ( Handle handle )
+	{
+		return Ready ( handle ) ? slots_[ handle ].pipeline_ : *placeholder_;
+	}
+
+	void PipelineCompiler::WaitIdle ()
+	{
+		std::unique_lock<std::mutex> lock ( mutex_ );
+		work_done_.wait ( lock , [ this ] () { return pending_ == 0; } );
+	}
+
+	void PipelineCompiler::Rebind ( VkRenderPass renderPass , vkHelper::vkPipelineData const* rebuilt )
+	{
+		std::unique_lock<std::mutex> lock ( mutex_ );
+
+		// variants still queued pick the new render pass up, wait out the ones compiling against the old one
+		render_pass_ = renderPass;
+		work_done_.wait ( lock , [ this ] () { return pending_ == queue_.size (); } );
+
+		for ( auto& slot : slots_ )
+		{
+			if ( !slot.ready_.load ( std::memory_order_acquire ) )
+			{
+				continue;
+			}
+			if ( &slot.pipeline_ == rebuilt )
+			{
+				slot.failed_.store ( slot.pipeline_.pipeline_ == VK_NULL_HANDLE , std::memory_order_relaxed );
+				continue;
+			}
+
+			vkHelper::Misc::DestroyPipeline ( logical_device_ , slot.pipeline_ );
+			slot.ready_.store ( false , std::memory_order_relaxed );
+			slot.failed_.store ( false , std::memory_order_relaxed );
+			if ( pending_ == 0 )
+			{
+				first_submit_ = std::chrono::high_resolution_clock::now ();
+			}
+			queue_.push_back ( &slot );
+			++pending_;
+		}
+		work_ready_.notify_all ();
+	}
+
+	void PipelineCompiler::Work ()
+	{
+		vkTrace::NameThread ( "pipeline compiler" );
+		for ( ;;)
+		{
+			Slot* slot { nullptr };
+			VkRenderPass render_pass { VK_NULL_HANDLE };
+			{
+				std::unique_lock<std::mutex> lock ( mutex_ );
+				work_ready_.wait ( lock , [ this ] () { return stopping_ || !queue_.empty (); } );
+				if ( queue_.empty () )
+				{
+					return;
+				}
+				slot = queue_.front ();
+				queue_.pop_front ();
+				render_pass = render_pass_;
+			}
+
+			// the pipeline cache and the shader cache are both safe to share between the workers
+			Variant const& variant = slot->variant_;
+			auto start = std::chrono::high_resolution_clock::now ();
+			slot->pipeline_ = vkHelper::Create::vkGraphicsPipeline ( logical_device_ , render_pass , pipeline_cache_ , variant.instanced_ , variant.set_layouts_ ,
+				variant.push_constant_size_ , shader_cache_ , variant.state_ );
+			auto end = std::chrono::high_resolution_clock::now ();
+			slot->compile_ms_ = std::chrono::duration<double , std::milli> ( end - start ).count ();
+
+			if ( slot->pipeline_.pipeline_ == VK_NULL_HANDLE )
+			{
+				VKLOG_FAILURE ( "### vkCompile::PipelineCompiler::Work failed! A variant did not compile, the placeholder stays in use." );
+				slot->failed_.store ( true , std::memory_order_relaxed );
+			}
+			slot->ready_.store ( true , std::memory_order_release );
+
+			std::lock_guard<std::mutex> lock ( mutex_ );
+			last_done_ = end;
+			--pending_;
+			work_done_.notify_all ();
+		}
+	}
+
+	void PipelineCompiler::Report ( std::ostream& out )
+	{
+		WaitIdle ();
+
+		uint32_t compiled { 0 } , failed { 0 };
+		double serial_ms { 0.0 };
+		for ( auto const& slot : slots_ )
+		{
+			serial_ms += slot.compile_ms_;
+			slot.failed_ ? ++failed : ++compiled;
+		}
+		double wall_ms = slots_.empty () ? 0.0 : std::chrono::duration<double , std::milli> ( last_done_ - first_submit_ ).count ();
+
+		out << "### Pipeline compiler: " << compiled << " variants on " << workers_.size () << " threads";
+		if ( failed > 0 )
+		{
+			out << " (" << failed << " failed)";
+		}
+		if ( deduplicated_ > 0 )
+		{
+			out << ", " << deduplicated_ << " duplicate submits shared";
+		}
+		out << ", " << wall_ms << " ms wall against " << serial_ms << " ms of compiles";
+		if ( wall_ms > 0.0 )
+		{
+			out << " (" << serial_ms / wall_ms << "x)";
+		}
+		out << std::endl;
+	}
+
+	void PipelineCompiler::Destroy ()
+	{
+		{
+			std::lock_guard<std::mutex> lock ( mutex_ );
+			stopping_ = true;
+			queue_.clear ();
+		}
+		work_ready_.notify_all ();
+		for ( auto& worker : workers_ )
+		{
+			worker.join ();
+		}
+		workers_.clear ();
+
+		// a variant that failed to compile may still have created its layout
+		for ( auto& slot : slots_ )
+		{
+			vkHelper::Misc::DestroyPipeline ( logical_device_ , slot.pipeline_ );
+		}
+		slots_.clear ();
+		by_hash_.clear ();
+		deduplicated_ = 0;
+		pending_ = 0;
+		placeholder_ = nullptr;
+	}
+}
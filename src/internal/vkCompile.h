@@ -0,0 +1,122 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+namespace vkCompile
+{
+	/*!
+	 * @brief compiles graphics pipeline variants on a pool of worker threads with vkHelper::Create::vkGraphicsPipeline,
+	 *		every variant goes through one VkPipelineCache and one vkShaderCacheData
+	 *		a variant is referred to by a handle, Get hands out the placeholder until the variant is ready
+	 *		variants are deduplicated by hash, submitting an equal variant again returns the first one's handle
+	 *		variants are built against the render pass given to Initialize, or to Rebind once it is recreated
+	*/
+	struct PipelineCompiler
+	{
+		struct Parameters
+		{
+			uint32_t	thread_count_ { 1 };
+		};
+
+		struct Variant
+		{
+			bool								instanced_ { false };
+			std::vector<VkDescriptorSetLayout>	set_layouts_;
+			uint32_t							push_constant_size_ { 0 };
+			vkHelper::vkPipelineState			state_;
+		};
+
+		using Handle = uint32_t;
+
+		/*!
+		 * @brief placeholder is drawn in place of variants not ready yet, it must share their layout and outlive the compiler
+		*/
+		bool Initialize ( VkDevice logicalDevice , VkRenderPass renderPass , VkPipelineCache pipelineCache , vkHelper::vkShaderCacheData* shaderCache ,
+			vkHelper::vkPipelineData& placeholder , Parameters const& params );
+
+		/*!
+		 * @brief queues variant for a worker, returns at once
+		 *		typically a permutation of state_.constants_, see vkHelper::vkSpecializationData::Set
+		*/
+		Handle Submit ( Variant const& variant );
+
+		bool Ready ( Handle handle ) const;
+
+		/*!
+		 * @brief the variant's pipeline once ready, the placeholder before that or if it failed to compile
+		*/
+		vkHelper::vkPipelineData& Get ( Handle handle );
+
+		/*!
+		 * @brief blocks until every submitted variant is compiled
+		*/
+		void WaitIdle ();
+
+		/*!
+		 * @brief the render pass was recreated, queued variants compile against renderPass and compiled ones are destroyed and queued again,
+		 *		all but rebuilt, a variant the caller already rebuilt against it, Get hands out the placeholder until they are done
+		 *		none of the destroyed variants may still be in use, the old render pass has to live until this returns
+		*/
+		void Rebind ( VkRenderPass renderPass , vkHelper::vkPipelineData const* rebuilt = nullptr );
+
+		/*!
+		 * @brief wall time of the compiles against the sum of their single threaded times
+		*/
+		void Report ( std::ostream& out );
+
+		/*!
+		 * @brief joins the workers and destroys every compiled pipeline, none may still be in use
+		*/
+		void Destroy ();
+
+	private:
+		struct Slot
+		{
+			Variant					variant_;
+			vkHelper::vkPipelineData	pipeline_ {};
+			double					compile_ms_ { 0.0 };
+			std::atomic<bool>		ready_ { false };
+			std::atomic<bool>		failed_ { false };
+		};
+
+		void Work ();
+
+		static size_t HashVariant ( Variant const& variant );
+		static bool SameVariant ( Variant const& lhs , Variant const& rhs );
+
+		VkDevice							logical_device_ { VK_NULL_HANDLE };
+		VkRenderPass						render_pass_ { VK_NULL_HANDLE };
+		VkPipelineCache						pipeline_cache_ { VK_NULL_HANDLE };
+		vkHelper::vkShaderCacheData*		shader_cache_ { nullptr };
+		vkHelper::vkPipelineData*			placeholder_ { nullptr };
+
+		std::deque<Slot>					slots_;			// grows on Submit only, workers hold pointers to slots
+		std::unordered_map<size_t , std::vector<Handle>>	by_hash_;
+		uint32_t							deduplicated_ { 0 };
+		std::deque<Slot*>					queue_;
+		std::vector<std::thread>			workers_;
+		std::mutex							mutex_;
+		std::condition_variable				work_ready_;
+		std::condition_variable				work_done_;
+		uint32_t							pending_ { 0 };
+		bool								stopping_ { false };
+
+		std::chrono::high_resolution_clock::time_point	first_submit_ {};
+		std::chrono::high_resolution_clock::time_point	last_done_ {};
+	};
+}
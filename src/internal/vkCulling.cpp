@@ -0,0 +1,196 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkCulling.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vkCulling
+{
+	// push constants of shaders/cull.comp
+	struct CullConstants
+	{
+		float		planes_[ 6 ][ 4 ];
+		uint32_t	object_count_;
+		uint32_t	index_count_;
+		float		bounding_radius_;
+	};
+
+	static constexpr uint32_t CULL_GROUP_SIZE { 64 };
+
+	Frustum ClipSpaceFrustum ()
+	{
+		return { {
+			{  1.0f ,  0.0f ,  0.0f , 1.0f } ,	// x >= -1
+			{ -1.0f ,  0.0f ,  0.0f , 1.0f } ,	// x <= 1
+			{  0.0f ,  1.0f ,  0.0f , 1.0f } ,	// y >= -1
+			{  0.0f , -1.0f ,  0.0f , 1.0f } ,	// y <= 1
+			{  0.0f ,  0.0f ,  1.0f , 0.0f } ,	// z >= 0
+			{  0.0f ,  0.0f , -1.0f , 1.0f }	// z <= 1
+		} };
+	}
+
+	bool GpuCuller::Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+		vkDescriptor::FrameSetCaches& frameSets , VkPipelineCache pipelineCache , uint32_t frameCount , Parameters const& params )
+	{
+		vkTrace::Zone zone ( "vkCulling::GpuCuller::Initialize" );
+
+		logical_device_ = logicalDevice;
+		allocator_ = &allocator;
+		frame_sets_ = &frameSets;
+		max_objects_ = std::max ( params.max_objects_ , 1u );
+		bounding_radius_ = params.bounding_radius_;
+		frustum_ = ClipSpaceFrustum ();
+
+		// one command per visible object, drawn as instance firstInstance
+		if ( !profile.features_.multiDrawIndirect || !profile.features_.drawIndirectFirstInstance )
+		{
+			VKLOG_FAILURE ( "### vkCulling::GpuCuller::Initialize failed! Device lacks multiDrawIndirect or drawIndirectFirstInstance." );
+			return false;
+		}
+		max_draws_per_call_ = std::max ( profile.properties_.limits.maxDrawIndirectCount , 1u );
+		if ( vkHelper::Check::DeviceExtensionAvailable ( profile , VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME ) )
+		{
+			draw_indirect_count_ = reinterpret_cast< PFN_vkCmdDrawIndexedIndirectCountKHR >( vkGetDeviceProcAddr ( logicalDevice , "vkCmdDrawIndexedIndirectCountKHR" ) );
+		}
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings ( 3 );
+		for ( uint32_t i = 0; i < 3; ++i )
+		{
+			bindings[ i ].binding = i;
+			bindings[ i ].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[ i ].descriptorCount = 1;
+			bindings[ i ].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		if ( ( set_layout_ = layoutCache.Get ( bindings ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		if ( ( pipeline_ = vkHelper::Create::vkComputePipeline ( logicalDevice , "shaders/cull_comp.spv" , { set_layout_ } , sizeof ( CullConstants ) , pipelineCache ) ).pipeline_ == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		// results per frame in flight, a frame's draws are read while the next frame culls
+		frames_.resize ( frameCount );
+		for ( uint32_t i = 0; i < frameCount; ++i )
+		{
+			FrameData& frame = frames_[ i ];
+
+			VkBufferCreateInfo bufferInfo {};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = sizeof ( VkDrawIndexedIndirectCommand ) * max_objects_;
+			bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , frame.commands_ , frame.commands_allocation_ ) )
+			{
+				VKLOG_FAILURE ( "### vkCulling::GpuCuller::Initialize failed! Failed to create indirect command buffer." );
+				return false;
+			}
+
+			bufferInfo.size = sizeof ( uint32_t );
+			if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , frame.count_ , frame.count_allocation_ ) )
+			{
+				VKLOG_FAILURE ( "### vkCulling::GpuCuller::Initialize failed! Failed to create draw count buffer." );
+				return false;
+			}
+		}
+		bindings_.resize ( 3 );
+
+		VKLOG_INFO ( "### Gpu culling: up to " , max_objects_ , " objects, " ,
+			( draw_indirect_count_ ? "vkCmdDrawIndexedIndirectCount" : "vkCmdDrawIndexedIndirect over zeroed commands" ) );
+		return true;
+	}
+
+	void GpuCuller::SetFrustum ( Frustum const& frustum )
+	{
+		frustum_ = frustum;
+	}
+
+	bool GpuCuller::Record ( VkCommandBuffer commandBuffer , size_t frame , vkHelper::vkDrawData& draw )
+	{
+		if ( draw.instance_buffer_ == VK_NULL_HANDLE || draw.index_buffer_ == VK_NULL_HANDLE )
+		{
+			VKLOG_FAILURE ( "### vkCulling::GpuCuller::Record failed! Culling needs an indexed instanced draw." );
+			return false;
+		}
+
+		FrameData& frame_data = frames_[ frame ];
+		uint32_t object_count = std::min ( draw.instance_count_ , max_objects_ );
+
+		// the frame's set cache was reset with its fence, the set is written at most once per frame
+		bindings_[ 0 ] = { 0 , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , draw.instance_buffer_ };
+		bindings_[ 1 ] = { 1 , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , frame_data.commands_ };
+		bindings_[ 2 ] = { 2 , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , frame_data.count_ };
+		VkDescriptorSet set = frame_sets_->Frame ( frame ).Get ( set_layout_ , bindings_ );
+		if ( set == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		vkCmdFillBuffer ( commandBuffer , frame_data.count_ , 0 , sizeof ( uint32_t ) , 0 );
+		// the count is not offset per call, a split count draw reads up to count commands from each call's offset
+		if ( ( draw_indirect_count_ == nullptr || object_count > max_draws_per_call_ ) && object_count > 0 )
+		{
+			vkCmdFillBuffer ( commandBuffer , frame_data.commands_ , 0 , sizeof ( VkDrawIndexedIndirectCommand ) * object_count , 0 );
+		}
+
+		VkMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_TRANSFER_BIT , VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT , 0 , 1 , &barrier , 0 , nullptr , 0 , nullptr );
+
+		if ( object_count > 0 )
+		{
+			CullConstants constants {};
+			std::memcpy ( constants.planes_ , frustum_.planes_ , sizeof ( constants.planes_ ) );
+			constants.object_count_ = object_count;
+			constants.index_count_ = draw.index_count_;
+			constants.bounding_radius_ = bounding_radius_;
+
+			vkCmdBindPipeline ( commandBuffer , VK_PIPELINE_BIND_POINT_COMPUTE , pipeline_.pipeline_ );
+			vkCmdBindDescriptorSets ( commandBuffer , VK_PIPELINE_BIND_POINT_COMPUTE , pipeline_.layout_ , 0 , 1 , &set , 0 , nullptr );
+			vkCmdPushConstants ( commandBuffer , pipeline_.layout_ , VK_SHADER_STAGE_COMPUTE_BIT , 0 , sizeof ( CullConstants ) , &constants );
+			vkCmdDispatch ( commandBuffer , ( object_count + CULL_GROUP_SIZE - 1 ) / CULL_GROUP_SIZE , 1 , 1 );
+		}
+
+		// the commands and the count are read as indirect parameters by the render pass
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT , VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT , 0 , 1 , &barrier , 0 , nullptr , 0 , nullptr );
+
+		draw.indirect_buffer_ = frame_data.commands_;
+		draw.count_buffer_ = frame_data.count_;
+		draw.max_draw_count_ = object_count;
+		draw.draw_indirect_count_ = draw_indirect_count_;
+		draw.max_draws_per_call_ = max_draws_per_call_;
+		return true;
+	}
+
+	void GpuCuller::Destroy ()
+	{
+		if ( logical_device_ == VK_NULL_HANDLE )
+		{
+			return;
+		}
+
+		for ( auto& frame : frames_ )
+		{
+			allocator_->DestroyBuffer ( frame.commands_ , frame.commands_allocation_ );
+			allocator_->DestroyBuffer ( frame.count_ , frame.count_allocation_ );
+		}
+		frames_.clear ();
+
+		vkHelper::Misc::DestroyPipeline ( logical_device_ , pipeline_ );
+		set_layout_ = VK_NULL_HANDLE;
+	}
+}
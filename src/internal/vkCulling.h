@@ -0,0 +1,83 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+#include "vkMemory.h"
+#include "vkDescriptor.h"
+
+#include <vector>
+
+namespace vkCulling
+{
+	/*!
+	 * @brief six planes, xyz a normal pointing into the frustum and w the distance
+	*/
+	struct Frustum
+	{
+		float	planes_[ 6 ][ 4 ];
+	};
+
+	/*!
+	 * @brief the clip space volume, x and y in [-1,1] and z in [0,1]
+	*/
+	Frustum ClipSpaceFrustum ();
+
+	/*!
+	 * @brief culls the bounding spheres of a vkDrawData's instances against a frustum in a compute pass
+	 *		every visible instance gets a VkDrawIndexedIndirectCommand and bumps a gpu draw count,
+	 *		Record points the vkDrawData at them so the render pass draws with vkCmdDrawIndexedIndirectCount
+	 *		without VK_KHR_draw_indirect_count the commands are zeroed first and all of them are drawn
+	 *		more objects than the device's maxDrawIndirectCount are drawn in several calls, with their commands zeroed first as well
+	*/
+	struct GpuCuller
+	{
+		struct Parameters
+		{
+			uint32_t	max_objects_ { 1 };
+			float		bounding_radius_ { 0.71f };	// of the mesh at scale 1
+		};
+
+		/*!
+		 * @brief the set layout comes from layoutCache, a frame's set from its cache in frameSets, both outlive the culler
+		*/
+		bool Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+			vkDescriptor::FrameSetCaches& frameSets , VkPipelineCache pipelineCache , uint32_t frameCount , Parameters const& params );
+
+		void SetFrustum ( Frustum const& frustum );
+
+		/*!
+		 * @brief records the cull of frame's draw into commandBuffer, outside a render pass,
+		 *		fits vkFrameCommandData::pre_pass_
+		*/
+		bool Record ( VkCommandBuffer commandBuffer , size_t frame , vkHelper::vkDrawData& draw );
+
+		void Destroy ();
+
+	private:
+		struct FrameData
+		{
+			VkBuffer				commands_ { VK_NULL_HANDLE };
+			vkMemory::Allocation	commands_allocation_;
+			VkBuffer				count_ { VK_NULL_HANDLE };
+			vkMemory::Allocation	count_allocation_;
+		};
+
+		VkDevice								logical_device_ { VK_NULL_HANDLE };
+		vkMemory::Allocator*					allocator_ { nullptr };
+		vkHelper::vkPipelineData				pipeline_ {};
+		VkDescriptorSetLayout					set_layout_ { VK_NULL_HANDLE };	// owned by the layout cache
+		vkDescriptor::FrameSetCaches*			frame_sets_ { nullptr };
+		std::vector<vkDescriptor::BufferBinding>	bindings_;				// scratch of Record, reused
+		PFN_vkCmdDrawIndexedIndirectCountKHR	draw_indirect_count_ { nullptr };
+		uint32_t								max_draws_per_call_ { 1 };
+
+		std::vector<FrameData>					frames_;
+		uint32_t								max_objects_ { 0 };
+		float									bounding_radius_ { 0.0f };
+		Frustum									frustum_ {};
+	};
+}
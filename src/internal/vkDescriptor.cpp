@@ -0,0 +1,309 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkDescriptor.h"
+#include "vkLog.h"
+
+#include <algorithm>
+#include <functional>
+#include <cassert>
+
+namespace vkDescriptor
+{
+	using vkHelper::Misc::HashCombine;
+
+	template <typename T>
+	static size_t HashOf ( T const& value )
+	{
+		return std::hash<T> {} ( value );
+	}
+
+	static size_t HashBindings ( std::vector<VkDescriptorSetLayoutBinding> const& bindings )
+	{
+		size_t seed = bindings.size ();
+		for ( auto const& binding : bindings )
+		{
+			HashCombine ( seed , binding.binding );
+			HashCombine ( seed , static_cast< size_t >( binding.descriptorType ) );
+			HashCombine ( seed , binding.descriptorCount );
+			HashCombine ( seed , binding.stageFlags );
+		}
+		return seed;
+	}
+
+	static bool SameBindings ( std::vector<VkDescriptorSetLayoutBinding> const& lhs , std::vector<VkDescriptorSetLayoutBinding> const& rhs )
+	{
+		return std::equal ( lhs.begin () , lhs.end () , rhs.begin () , rhs.end () , [] ( VkDescriptorSetLayoutBinding const& a , VkDescriptorSetLayoutBinding const& b )
+		{
+			return a.binding == b.binding && a.descriptorType == b.descriptorType && a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+		} );
+	}
+
+	static size_t HashContents ( VkDescriptorSetLayout layout , std::vector<BufferBinding> const& bindings )
+	{
+		size_t seed = HashOf ( layout );
+		for ( auto const& binding : bindings )
+		{
+			HashCombine ( seed , binding.binding_ );
+			HashCombine ( seed , static_cast< size_t >( binding.type_ ) );
+			HashCombine ( seed , HashOf ( binding.buffer_ ) );
+			HashCombine ( seed , HashOf ( binding.offset_ ) );
+			HashCombine ( seed , HashOf ( binding.range_ ) );
+		}
+		return seed;
+	}
+
+	static bool SameContents ( std::vector<BufferBinding> const& lhs , std::vector<BufferBinding> const& rhs )
+	{
+		return std::equal ( lhs.begin () , lhs.end () , rhs.begin () , rhs.end () , [] ( BufferBinding const& a , BufferBinding const& b )
+		{
+			return a.binding_ == b.binding_ && a.type_ == b.type_ && a.buffer_ == b.buffer_ && a.offset_ == b.offset_ && a.range_ == b.range_;
+		} );
+	}
+
+	void LayoutCache::Initialize ( VkDevice logicalDevice )
+	{
+		logical_device_ = logicalDevice;
+	}
+
+	VkDescriptorSetLayout LayoutCache::Get ( std::vector<VkDescriptorSetLayoutBinding> const& bindings )
+	{
+		// the same bindings listed in another order are the same layout
+		std::vector<VkDescriptorSetLayoutBinding> sorted = bindings;
+		std::sort ( sorted.begin () , sorted.end () , [] ( VkDescriptorSetLayoutBinding const& a , VkDescriptorSetLayoutBinding const& b )
+		{
+			return a.binding < b.binding;
+		} );
+
+		std::vector<Entry>& bucket = layouts_[ HashBindings ( sorted ) ];
+		for ( auto const& entry : bucket )
+		{
+			if ( SameBindings ( entry.bindings_ , sorted ) )
+			{
+				return entry.layout_;
+			}
+		}
+
+		for ( auto const& binding : sorted )
+		{
+			assert ( binding.pImmutableSamplers == nullptr );
+			( void )binding;
+		}
+
+		VkDescriptorSetLayout layout = vkHelper::Create::vkDescriptorSetLayout ( logical_device_ , sorted );
+		if ( layout != VK_NULL_HANDLE )
+		{
+			bucket.push_back ( { std::move ( sorted ) , layout } );
+		}
+		return layout;
+	}
+
+	void LayoutCache::Destroy ()
+	{
+		for ( auto& bucket : layouts_ )
+		{
+			for ( auto& entry : bucket.second )
+			{
+				vkDestroyDescriptorSetLayout ( logical_device_ , entry.layout_ , nullptr );
+			}
+		}
+		layouts_.clear ();
+	}
+
+	bool DescriptorAllocator::Initialize ( VkDevice logicalDevice , Parameters const& params )
+	{
+		logical_device_ = logicalDevice;
+		params_ = params;
+		params_.first_pool_sets_ = std::max ( params_.first_pool_sets_ , 1u );
+		params_.max_pool_sets_ = std::max ( params_.max_pool_sets_ , params_.first_pool_sets_ );
+		current_ = 0;
+		return NextPool ();
+	}
+
+	bool DescriptorAllocator::Allocate ( VkDescriptorSetLayout layout , VkDescriptorSet& set )
+	{
+		VkDescriptorSetAllocateInfo allocInfo {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		// a full pool stays behind until the next Reset, the allocation moves on to the next one
+		bool new_pool { false };
+		while ( current_ < pools_.size () )
+		{
+			allocInfo.descriptorPool = pools_[ current_ ];
+			VkResult result = vkAllocateDescriptorSets ( logical_device_ , &allocInfo , &set );
+			if ( result == VK_SUCCESS )
+			{
+				return true;
+			}
+			if ( ( result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL ) || new_pool )
+			{
+				// an empty pool that cannot take the set never will, descriptors_per_set_ is too small for the layout
+				VKLOG_FAILURE ( "### vkDescriptor::DescriptorAllocator::Allocate failed! Failed to allocate descriptor set." );
+				return false;
+			}
+			if ( ++current_ == pools_.size () )
+			{
+				if ( !NextPool () )
+				{
+					return false;
+				}
+				new_pool = true;
+			}
+		}
+		return false;
+	}
+
+	void DescriptorAllocator::Reset ()
+	{
+		for ( size_t i = 0; i < pools_.size () && i <= current_; ++i )
+		{
+			vkResetDescriptorPool ( logical_device_ , pools_[ i ] , 0 );
+		}
+		current_ = 0;
+	}
+
+	void DescriptorAllocator::Destroy ()
+	{
+		for ( auto pool : pools_ )
+		{
+			vkDestroyDescriptorPool ( logical_device_ , pool , nullptr );
+		}
+		pools_.clear ();
+		pool_sets_.clear ();
+		current_ = 0;
+	}
+
+	bool DescriptorAllocator::NextPool ()
+	{
+		uint32_t sets = pool_sets_.empty () ? params_.first_pool_sets_ : std::min ( pool_sets_.back () * 2 , params_.max_pool_sets_ );
+
+		std::vector<VkDescriptorPoolSize> sizes = params_.descriptors_per_set_;
+		for ( auto& size : sizes )
+		{
+			size.descriptorCount *= sets;
+		}
+
+		VkDescriptorPool pool = vkHelper::Create::vkDescriptorPool ( logical_device_ , sizes , sets );
+		if ( pool == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+		pools_.push_back ( pool );
+		pool_sets_.push_back ( sets );
+		return true;
+	}
+
+	bool SetCache::Initialize ( VkDevice logicalDevice , DescriptorAllocator::Parameters const& params )
+	{
+		logical_device_ = logicalDevice;
+		return allocator_.Initialize ( logicalDevice , params );
+	}
+
+	VkDescriptorSet SetCache::Get ( VkDescriptorSetLayout layout , std::vector<BufferBinding> const& bindings )
+	{
+		std::vector<Entry>& bucket = sets_[ HashContents ( layout , bindings ) ];
+		for ( auto const& entry : bucket )
+		{
+			if ( entry.layout_ == layout && SameContents ( entry.bindings_ , bindings ) )
+			{
+				++hits_;
+				return entry.set_;
+			}
+		}
+		++misses_;
+
+		VkDescriptorSet set { VK_NULL_HANDLE };
+		if ( !allocator_.Allocate ( layout , set ) )
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		// every binding in one update call
+		buffer_infos_.resize ( bindings.size () );
+		writes_.resize ( bindings.size () );
+		for ( size_t i = 0; i < bindings.size (); ++i )
+		{
+			buffer_infos_[ i ] = { bindings[ i ].buffer_ , bindings[ i ].offset_ , bindings[ i ].range_ };
+
+			VkWriteDescriptorSet& write = writes_[ i ];
+			write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = bindings[ i ].binding_;
+			write.dstArrayElement = 0;
+			write.descriptorType = bindings[ i ].type_;
+			write.descriptorCount = 1;
+			write.pBufferInfo = &buffer_infos_[ i ];
+		}
+		vkUpdateDescriptorSets ( logical_device_ , static_cast< uint32_t >( writes_.size () ) , writes_.data () , 0 , nullptr );
+
+		bucket.push_back ( { layout , bindings , set } );
+		return set;
+	}
+
+	void SetCache::Reset ()
+	{
+		// the buckets keep their capacity, a frame asking for the same sets again allocates no entries
+		for ( auto& bucket : sets_ )
+		{
+			bucket.second.clear ();
+		}
+		allocator_.Reset ();
+	}
+
+	void SetCache::Report ( std::ostream& out ) const
+	{
+		uint64_t lookups = hits_ + misses_;
+		out << allocator_.PoolCount () << " pools, " << lookups << " lookups, "
+			<< ( lookups > 0 ? 100.0 * static_cast< double >( hits_ ) / static_cast< double >( lookups ) : 0.0 ) << "% hits";
+	}
+
+	void SetCache::Destroy ()
+	{
+		sets_.clear ();
+		allocator_.Destroy ();
+	}
+
+	bool FrameSetCaches::Initialize ( VkDevice logicalDevice , uint32_t frameCount , DescriptorAllocator::Parameters const& params )
+	{
+		caches_.resize ( std::max ( frameCount , 1u ) );
+		for ( auto& cache : caches_ )
+		{
+			if ( !cache.Initialize ( logicalDevice , params ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void FrameSetCaches::BeginFrame ( size_t frame )
+	{
+		caches_[ frame ].Reset ();
+	}
+
+	void FrameSetCaches::Report ( std::ostream& out ) const
+	{
+		for ( size_t i = 0; i < caches_.size (); ++i )
+		{
+			out << "\t- frame " << i << ": ";
+			caches_[ i ].Report ( out );
+			out << "\n";
+		}
+		out.flush ();
+	}
+
+	void FrameSetCaches::Destroy ()
+	{
+		for ( auto& cache : caches_ )
+		{
+			cache.Destroy ();
+		}
+		caches_.clear ();
+	}
+}
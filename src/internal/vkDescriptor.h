@@ -0,0 +1,156 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+namespace vkDescriptor
+{
+	/*!
+	 * @brief one VkDescriptorSetLayout per distinct binding list, owned by the cache
+	 *		bindings are hashed in binding order, immutable samplers are not supported
+	*/
+	struct LayoutCache
+	{
+		void Initialize ( VkDevice logicalDevice );
+
+		/*!
+		 * @brief the cached layout of bindings, created on first use
+		*/
+		VkDescriptorSetLayout Get ( std::vector<VkDescriptorSetLayoutBinding> const& bindings );
+
+		void Destroy ();
+
+	private:
+		struct Entry
+		{
+			std::vector<VkDescriptorSetLayoutBinding>	bindings_;
+			VkDescriptorSetLayout						layout_ { VK_NULL_HANDLE };
+		};
+
+		VkDevice										logical_device_ { VK_NULL_HANDLE };
+		std::unordered_map<size_t , std::vector<Entry>>	layouts_;
+	};
+
+	/*!
+	 * @brief allocates sets from a growing list of pools, each new pool holds twice the sets of the last
+	 *		sets are never freed one by one, Reset returns every pool at once
+	*/
+	struct DescriptorAllocator
+	{
+		struct Parameters
+		{
+			uint32_t							first_pool_sets_ { 64 };
+			uint32_t							max_pool_sets_ { 4096 };
+			std::vector<VkDescriptorPoolSize>	descriptors_per_set_ {	// scaled by a pool's set count
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER , 2 } ,
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC , 1 } ,
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , 4 } ,
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC , 1 } ,
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER , 2 } };
+		};
+
+		bool Initialize ( VkDevice logicalDevice , Parameters const& params );
+
+		bool Allocate ( VkDescriptorSetLayout layout , VkDescriptorSet& set );
+
+		/*!
+		 * @brief resets every pool, no set allocated from them may still be in use
+		*/
+		void Reset ();
+
+		uint32_t PoolCount () const
+		{
+			return static_cast< uint32_t >( pools_.size () );
+		}
+
+		void Destroy ();
+
+	private:
+		bool NextPool ();
+
+		VkDevice						logical_device_ { VK_NULL_HANDLE };
+		Parameters						params_;
+		std::vector<VkDescriptorPool>	pools_;
+		std::vector<uint32_t>			pool_sets_;
+		size_t							current_ { 0 };	// pools before it are full until the next Reset
+	};
+
+	/*!
+	 * @brief a buffer descriptor of a set, its contents as far as the set cache is concerned
+	*/
+	struct BufferBinding
+	{
+		uint32_t			binding_ { 0 };
+		VkDescriptorType	type_ { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+		VkBuffer			buffer_ { VK_NULL_HANDLE };
+		VkDeviceSize		offset_ { 0 };
+		VkDeviceSize		range_ { VK_WHOLE_SIZE };
+	};
+
+	/*!
+	 * @brief sets keyed by layout and contents, a repeated request returns the set written the first time
+	 *		without allocating or updating anything
+	 *		Reset forgets every set and resets the allocator, a cache whose buffers are destroyed must be Reset
+	 *		first, a new buffer may reuse the handle of a destroyed one
+	 *		not thread safe
+	*/
+	struct SetCache
+	{
+		bool Initialize ( VkDevice logicalDevice , DescriptorAllocator::Parameters const& params );
+
+		VkDescriptorSet Get ( VkDescriptorSetLayout layout , std::vector<BufferBinding> const& bindings );
+
+		void Reset ();
+
+		void Report ( std::ostream& out ) const;
+
+		void Destroy ();
+
+	private:
+		struct Entry
+		{
+			VkDescriptorSetLayout		layout_ { VK_NULL_HANDLE };
+			std::vector<BufferBinding>	bindings_;
+			VkDescriptorSet				set_ { VK_NULL_HANDLE };
+		};
+
+		VkDevice										logical_device_ { VK_NULL_HANDLE };
+		DescriptorAllocator								allocator_;
+		std::unordered_map<size_t , std::vector<Entry>>	sets_;
+		std::vector<VkDescriptorBufferInfo>				buffer_infos_;	// scratch of Get, reused
+		std::vector<VkWriteDescriptorSet>				writes_;		// scratch of Get, reused
+		uint64_t										hits_ { 0 };
+		uint64_t										misses_ { 0 };
+	};
+
+	/*!
+	 * @brief a SetCache per frame in flight, BeginFrame resets the frame's cache and with it its pools
+	 *		as a whole, the frame's fence in vkSyncObjects::in_flight_fences_ must have signaled
+	*/
+	struct FrameSetCaches
+	{
+		bool Initialize ( VkDevice logicalDevice , uint32_t frameCount , DescriptorAllocator::Parameters const& params );
+
+		void BeginFrame ( size_t frame );
+
+		SetCache& Frame ( size_t frame )
+		{
+			return caches_[ frame ];
+		}
+
+		void Report ( std::ostream& out ) const;
+
+		void Destroy ();
+
+	private:
+		std::vector<SetCache>	caches_;
+	};
+}
@@ -5,21 +5,34 @@
 */
 
 #include "vkHelper.h"
+#include "vkLog.h"
+#include "vkTrace.h"
 
-#include <iostream>
 #include <fstream>
 #include <set>
 #include <assert.h>
 #include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
 
+#ifdef _WIN32
 #include "wndHelper.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace vkHelper
 {
 	namespace Create
 	{
-		bool vkInstance ( char const* name , VkInstance& instance , int flags )
+		bool vkInstance ( char const* name , VkInstance& instance , int flags , bool headless )
 		{
+			vkTrace::Zone zone ( "Create::vkInstance" );
+
 			// get and check validation and render doc layers
 			bool enable_validation = flags & static_cast< int >( Get::VKLAYER::KHRONOS_VALIDATION );
 			bool enable_renderdoc = flags & static_cast< int >( Get::VKLAYER::RENDERDOC_CAPTURE );
@@ -36,15 +49,15 @@ namespace vkHelper
 			}
 			if ( !Check::vkLayersSupport ( vk_layers ) )
 			{
-				std::cerr << "### Create::vkInstance failed! Vulkan layers requested not supported!" << std::endl;
+				VKLOG_FAILURE ( "### Create::vkInstance failed! Vulkan layers requested not supported!" );
 			}
 
 			// get and check instance extensions support
-			std::vector<const char*> instance_extensions = Get::InstanceExtensions ( enable_validation );
+			std::vector<const char*> instance_extensions = Get::InstanceExtensions ( enable_validation , headless );
 
-			if ( !Check::InstanceExtensionsSupport ( enable_validation ) )
+			if ( !Check::InstanceExtensionsSupport ( enable_validation , headless ) )
 			{
-				std::cerr << "### Create::vkInstance failed! Extensions requested not supported!" << std::endl;
+				VKLOG_FAILURE ( "### Create::vkInstance failed! Extensions requested not supported!" );
 			}
 
 			// app info
@@ -80,7 +93,7 @@ namespace vkHelper
 
 			if ( vkCreateInstance ( &create_info , nullptr , &instance ) != VK_SUCCESS )
 			{
-				std::cerr << "### Create::vkInstance failed to create VkInstance!" << std::endl;
+				VKLOG_FAILURE ( "### Create::vkInstance failed to create VkInstance!" );
 				return false;
 			}
 
@@ -89,25 +102,30 @@ namespace vkHelper
 
 		bool vkDebugMessenger ( VkInstance instance , VkDebugUtilsMessengerEXT& debugMessenger )
 		{
+			vkTrace::Zone zone ( "Create::vkDebugMessenger" );
+
 			VkDebugUtilsMessengerCreateInfoEXT debug_create_info {};
 			Debug::PopulateDebugMessengerCreateInfo ( debug_create_info );
 
 			if ( Debug::CreateDebugUtilsMessengerEXT ( instance , &debug_create_info , nullptr , &debugMessenger ) != VK_SUCCESS )
 			{
-				std::cerr << "### Create::vkDebugMessenger Failed to set up debug messenger!" << std::endl;
+				VKLOG_FAILURE ( "### Create::vkDebugMessenger Failed to set up debug messenger!" );
 				return false;
 			}
 
 			return true;
 		}
 
+#ifdef _WIN32
 		bool vkSurfaceWin32 ( VkInstance instance , HWND hWnd , VkSurfaceKHR& surface )
 		{
+			vkTrace::Zone zone ( "Create::vkSurfaceWin32" );
+
 			// get surface creation extension
 			auto vkCreateWin32Surface = ( PFN_vkCreateWin32SurfaceKHR ) vkGetInstanceProcAddr ( instance , "vkCreateWin32SurfaceKHR" );
 			if ( vkCreateWin32Surface == nullptr )
 			{
-				std::cerr << "### vkHelper::Create::vkSurfaceWin32 failed! Surface creation extension not loaded!" << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkSurfaceWin32 failed! Surface creation extension not loaded!" );
 				return false;
 			}
 
@@ -124,67 +142,77 @@ namespace vkHelper
 			{
 				if ( auto error = vkCreateWin32Surface ( instance , &surface_create_info , nullptr , &surface ) )
 				{
-					std::cerr << "### vkHelper::Create::vkSurfaceWin32 failed! Failed to create win32 surface" << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Create::vkSurfaceWin32 failed! Failed to create win32 surface" );
 					return false;
 				}
 			}
 
 			return true;
 		}
+#endif
 
-		VkPhysicalDevice vkPhysicalDevice ( VkInstance instance , VkSurfaceKHR surface )
+		VkPhysicalDevice vkPhysicalDevice ( VkInstance instance , VkSurfaceKHR surface , vkDeviceProfile& profile )
 		{
+			vkTrace::Zone zone ( "Create::vkPhysicalDevice" );
+
 			// pick a physical device
 			uint32_t device_count { 0 };
 			vkEnumeratePhysicalDevices ( instance , &device_count , nullptr );
 			if ( device_count == 0 )
 			{
-				std::cerr << "### vkHelper::Create::vkPhysicalDevice failed! Failed to find GPU with vulkan support." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkPhysicalDevice failed! Failed to find GPU with vulkan support." );
 				return VK_NULL_HANDLE;
 			}
 			std::vector<VkPhysicalDevice> devices ( device_count );
 			vkEnumeratePhysicalDevices ( instance , &device_count , devices.data () );
 
-			// print all devices
-			std::cout << "### All physical devices:" << std::endl;
+			// profile every device once, suitability checks and later creation only read the profiles
+			std::vector<vkDeviceProfile> profiles;
+			profiles.reserve ( devices.size () );
 			for ( auto const& physical_device : devices )
 			{
-				VkPhysicalDeviceProperties device_properties;
-				vkGetPhysicalDeviceProperties ( physical_device , &device_properties );
-				std::cout << "\t- " << device_properties.deviceName << std::endl;
+				profiles.emplace_back ( Get::DeviceProfile ( physical_device , surface ) );
+			}
+
+			// print all devices
+			VKLOG_INFO ( "### All physical devices:" );
+			for ( auto const& device_profile : profiles )
+			{
+				VKLOG_INFO ( "\t- " , device_profile.properties_.deviceName );
 			}
 
 			VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-			for ( auto const& physical_device : devices )
+			for ( auto& device_profile : profiles )
 			{
-				if ( Check::PhysicalDeviceSuitable ( physical_device , surface ) )
+				if ( Check::PhysicalDeviceSuitable ( device_profile ) )
 				{
 					// device found
-					std::cout << "### Suitable Device Found:" << std::endl;
-					physicalDevice = physical_device;
-					VkPhysicalDeviceProperties device_properties;
-					vkGetPhysicalDeviceProperties ( physicalDevice , &device_properties );
-					std::cout << "\t- " << device_properties.deviceName << std::endl;
+					VKLOG_INFO ( "### Suitable Device Found:" );
+					VKLOG_INFO ( "\t- " , device_profile.properties_.deviceName );
+					physicalDevice = device_profile.physical_device_;
+					profile = std::move ( device_profile );
 					break;
 				}
 			}
 
 			if ( physicalDevice == VK_NULL_HANDLE )
 			{
-				std::cout << "\t- " << "none" << std::endl;
-				std::cerr << "### vkHelper::Create::vkPhysicalDevice failed! Failed to find a suitable GPU for selected operations." << std::endl;
+				VKLOG_INFO ( "\t- " , "none" );
+				VKLOG_FAILURE ( "### vkHelper::Create::vkPhysicalDevice failed! Failed to find a suitable GPU for selected operations." );
 				return VK_NULL_HANDLE;
 			}
 
 			return physicalDevice;
 		}
 
-		VkDevice vkLogicalDevice ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , int flags )
+		VkDevice vkLogicalDevice ( vkDeviceProfile const& profile , int flags )
 		{
-			Get::QueueFamilyIndices indices = Get::QueueFamilies ( physicalDevice , surface );
+			vkTrace::Zone zone ( "Create::vkLogicalDevice" );
+
+			Get::QueueFamilyIndices const& indices = profile.indices_;
 
 			// create set of queue families to guarantee unique key
-			std::set<uint32_t> unique_queue_families = { indices.graphics_family_.value (), indices.present_family_.value () };
+			std::set<uint32_t> unique_queue_families = { indices.graphics_family_.value (), indices.present_family_.value (), indices.transfer_family_.value (), indices.compute_family_.value () };
 
 			float queue_priority { 1.0f };
 
@@ -201,15 +229,24 @@ namespace vkHelper
 				queue_create_infos.push_back ( queue_create_info );
 			}
 
-			// device features for logical device
+			// device features for logical device, gpu driven draws use the indirect features when the device has them
 			VkPhysicalDeviceFeatures device_features {};
+			device_features.multiDrawIndirect = profile.features_.multiDrawIndirect;
+			device_features.drawIndirectFirstInstance = profile.features_.drawIndirectFirstInstance;
 
 			// create logical device
 			bool enable_validation = flags & static_cast< int >( Get::VKLAYER::KHRONOS_VALIDATION );
 			bool enable_renderdoc = flags & static_cast< int >( Get::VKLAYER::RENDERDOC_CAPTURE );
 
-			// get device extensions
-			std::vector<const char*> device_extensions = Get::DeviceExtensions ();
+			// get device extensions, swap chain only needed when presenting to a surface
+			std::vector<const char*> device_extensions = Get::DeviceExtensions ( profile.surface_ != VK_NULL_HANDLE );
+			for ( char const* extension : Get::OptionalDeviceExtensions () )
+			{
+				if ( Check::DeviceExtensionAvailable ( profile , extension ) )
+				{
+					device_extensions.emplace_back ( extension );
+				}
+			}
 
 			// get validation layers
 			std::vector<const char*> vk_layers;
@@ -229,7 +266,7 @@ namespace vkHelper
 			create_info.queueCreateInfoCount = static_cast< uint32_t >( queue_create_infos.size () );
 			create_info.pEnabledFeatures = &device_features;
 			create_info.enabledExtensionCount = static_cast< uint32_t >( device_extensions.size () );
-			create_info.ppEnabledExtensionNames = device_extensions.data ();
+			create_info.ppEnabledExtensionNames = device_extensions.size () > 0 ? device_extensions.data () : nullptr;
 
 			if ( enable_validation )
 			{
@@ -242,54 +279,75 @@ namespace vkHelper
 			}
 
 			VkDevice logical_device { VK_NULL_HANDLE };
-			if ( vkCreateDevice ( physicalDevice , &create_info , nullptr , &logical_device ) != VK_SUCCESS )
+			if ( vkCreateDevice ( profile.physical_device_ , &create_info , nullptr , &logical_device ) != VK_SUCCESS )
 			{
-				std::cerr << "### vkHelper::Create::vkLogicalDevice failed! Failed to create a logical device." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkLogicalDevice failed! Failed to create a logical device." );
 				return VK_NULL_HANDLE;
 			}
 
 			return logical_device;
 		}
 
-		VkQueue vkGraphicsQueue ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice )
+		VkQueue vkGraphicsQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice )
 		{
-			assert ( physicalDevice != VK_NULL_HANDLE &&
-				surface != VK_NULL_HANDLE &&
+			assert ( profile.physical_device_ != VK_NULL_HANDLE &&
 				logicalDevice != VK_NULL_HANDLE );
 
-			Get::QueueFamilyIndices indices = Get::QueueFamilies ( physicalDevice , surface );
 			VkQueue graphics_queue;
-			vkGetDeviceQueue ( logicalDevice , indices.graphics_family_.value () , 0 , &graphics_queue );
+			vkGetDeviceQueue ( logicalDevice , profile.indices_.graphics_family_.value () , 0 , &graphics_queue );
 			return graphics_queue;
 		}
 
-		VkQueue vkPresentQueue ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice )
+		VkQueue vkPresentQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice )
 		{
-			assert ( physicalDevice != VK_NULL_HANDLE &&
-				surface != VK_NULL_HANDLE &&
+			assert ( profile.physical_device_ != VK_NULL_HANDLE &&
 				logicalDevice != VK_NULL_HANDLE );
 
-			Get::QueueFamilyIndices indices = Get::QueueFamilies ( physicalDevice , surface );
 			VkQueue present_queue;
-			vkGetDeviceQueue ( logicalDevice , indices.present_family_.value () , 0 , &present_queue );
+			vkGetDeviceQueue ( logicalDevice , profile.indices_.present_family_.value () , 0 , &present_queue );
 			return present_queue;
 		}
 
-		vkSwapChainData vkSwapChain ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice )
+		VkQueue vkTransferQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice )
+		{
+			assert ( profile.physical_device_ != VK_NULL_HANDLE &&
+				logicalDevice != VK_NULL_HANDLE );
+
+			VkQueue transfer_queue;
+			vkGetDeviceQueue ( logicalDevice , profile.indices_.transfer_family_.value () , 0 , &transfer_queue );
+			return transfer_queue;
+		}
+
+		VkQueue vkComputeQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice )
+		{
+			assert ( profile.physical_device_ != VK_NULL_HANDLE &&
+				logicalDevice != VK_NULL_HANDLE );
+
+			VkQueue compute_queue;
+			vkGetDeviceQueue ( logicalDevice , profile.indices_.compute_family_.value () , 0 , &compute_queue );
+			return compute_queue;
+		}
+
+		vkSwapChainData vkSwapChain ( vkDeviceProfile& profile , VkDevice logicalDevice , VkSwapchainKHR oldSwapChain , VkPresentModeKHR presentMode )
 		{
+			vkTrace::Zone zone ( "Create::vkSwapChain" );
+
 			vkSwapChainData swapchain_data;
 
-			Get::SwapChainSupportDetails swapchain_support = Get::SwapChainSupportDetails_f ( physicalDevice , surface );
+			// formats and present modes are fixed per surface, only the capabilities follow the window size
+			Get::RefreshSurfaceCapabilities ( profile );
+			Get::SwapChainSupportDetails const& swapchain_support = profile.swapchain_support_;
 
 			// get swap chain formats
-			VkSurfaceFormatKHR surface_format = Get::vkSwapChainSurfaceFormat ( physicalDevice , surface );
+			VkSurfaceFormatKHR surface_format = Get::vkSwapChainSurfaceFormat ( swapchain_support );
 			swapchain_data.format_ = surface_format.format;
 
 			// get swap chain present modes
-			VkPresentModeKHR present_mode = Get::vkSwapChainPresentMode ( physicalDevice , surface );
+			VkPresentModeKHR present_mode = Get::vkSwapChainPresentMode ( swapchain_support , presentMode );
+			swapchain_data.present_mode_ = present_mode;
 
 			// get swap chain extent from capabilities
-			swapchain_data.extent_ = Get::vkSwapChainExtent2D ( physicalDevice , surface );
+			swapchain_data.extent_ = Get::vkSwapChainExtent2D ( swapchain_support.capabilities_ );
 
 			uint32_t image_count = swapchain_support.capabilities_.minImageCount + 1;
 
@@ -300,7 +358,7 @@ namespace vkHelper
 
 			VkSwapchainCreateInfoKHR createInfo {};
 			createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-			createInfo.surface = surface;
+			createInfo.surface = profile.surface_;
 			createInfo.minImageCount = image_count;
 			createInfo.imageFormat = surface_format.format;
 			createInfo.imageColorSpace = surface_format.colorSpace;
@@ -314,10 +372,11 @@ namespace vkHelper
 			createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 			// if true, pixels blocked by other windows are clipped
 			createInfo.clipped = VK_TRUE;
-			createInfo.oldSwapchain = VK_NULL_HANDLE;
+			// handing over the retiring swap chain lets the driver reuse its resources and keep presenting meanwhile
+			createInfo.oldSwapchain = oldSwapChain;
 
 			// queue handling
-			Get::QueueFamilyIndices indices = Get::QueueFamilies ( physicalDevice , surface );
+			Get::QueueFamilyIndices const& indices = profile.indices_;
 			uint32_t queueFamilyIndices[] = { indices.graphics_family_.value (), indices.present_family_.value () };
 			if ( indices.graphics_family_ != indices.present_family_ )
 			{
@@ -338,7 +397,7 @@ namespace vkHelper
 
 			if ( vkCreateSwapchainKHR ( logicalDevice , &createInfo , nullptr , &swapchain_data.swapchain_ ) != VK_SUCCESS )
 			{
-				std::cerr << "### vkHelper::Create::vkSwapChain failed! Failed to create swap chain." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkSwapChain failed! Failed to create swap chain." );
 			}
 
 			swapchain_data.images_ = Get::vkSwapChainImages ( logicalDevice , swapchain_data.swapchain_ );
@@ -347,8 +406,108 @@ namespace vkHelper
 			return swapchain_data;
 		}
 
-		VkRenderPass vkRenderPass ( VkDevice logicalDevice , VkFormat imageFormat )
+		vkSwapChainData vkOffscreenTarget ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkExtent2D extent , VkFormat format , uint32_t imageCount )
+		{
+			vkTrace::Zone zone ( "Create::vkOffscreenTarget" );
+
+			vkSwapChainData offscreen_data;
+			offscreen_data.extent_ = extent;
+			offscreen_data.format_ = format;
+
+			offscreen_data.images_.resize ( imageCount , VK_NULL_HANDLE );
+			offscreen_data.image_memory_.resize ( imageCount , VK_NULL_HANDLE );
+			offscreen_data.readback_buffers_.resize ( imageCount , VK_NULL_HANDLE );
+			offscreen_data.readback_memory_.resize ( imageCount , VK_NULL_HANDLE );
+			offscreen_data.readback_mapped_.resize ( imageCount , nullptr );
+
+			// readback is tightly packed, only 4 byte texel formats are supported
+			VkDeviceSize readback_size = static_cast< VkDeviceSize >( extent.width ) * extent.height * 4;
+
+			for ( uint32_t i = 0; i < imageCount; ++i )
+			{
+				// device owned color image, rendered into and then copied out
+				VkImageCreateInfo imageInfo {};
+				imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageInfo.format = format;
+				imageInfo.extent = { extent.width, extent.height, 1 };
+				imageInfo.mipLevels = 1;
+				imageInfo.arrayLayers = 1;
+				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				if ( vkCreateImage ( logicalDevice , &imageInfo , nullptr , &offscreen_data.images_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkOffscreenTarget failed! Failed to create image " , i , "." );
+					Misc::DestroyOffscreenTarget ( logicalDevice , offscreen_data );
+					return offscreen_data;
+				}
+
+				VkMemoryRequirements image_requirements;
+				vkGetImageMemoryRequirements ( logicalDevice , offscreen_data.images_[ i ] , &image_requirements );
+				std::optional<uint32_t> image_memory_type = Get::MemoryType ( profile , image_requirements.memoryTypeBits , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+
+				VkMemoryAllocateInfo imageAllocInfo {};
+				imageAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				imageAllocInfo.allocationSize = image_requirements.size;
+				imageAllocInfo.memoryTypeIndex = image_memory_type.value_or ( 0 );
+
+				if ( !image_memory_type.has_value () ||
+					vkAllocateMemory ( logicalDevice , &imageAllocInfo , nullptr , &offscreen_data.image_memory_[ i ] ) != VK_SUCCESS ||
+					vkBindImageMemory ( logicalDevice , offscreen_data.images_[ i ] , offscreen_data.image_memory_[ i ] , 0 ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkOffscreenTarget failed! Failed to allocate image memory " , i , "." );
+					Misc::DestroyOffscreenTarget ( logicalDevice , offscreen_data );
+					return offscreen_data;
+				}
+
+				// host visible buffer the finished image is copied into
+				VkBufferCreateInfo bufferInfo {};
+				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferInfo.size = readback_size;
+				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				if ( vkCreateBuffer ( logicalDevice , &bufferInfo , nullptr , &offscreen_data.readback_buffers_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkOffscreenTarget failed! Failed to create readback buffer " , i , "." );
+					Misc::DestroyOffscreenTarget ( logicalDevice , offscreen_data );
+					return offscreen_data;
+				}
+
+				VkMemoryRequirements buffer_requirements;
+				vkGetBufferMemoryRequirements ( logicalDevice , offscreen_data.readback_buffers_[ i ] , &buffer_requirements );
+				std::optional<uint32_t> buffer_memory_type = Get::MemoryType ( profile , buffer_requirements.memoryTypeBits , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT );
+
+				VkMemoryAllocateInfo bufferAllocInfo {};
+				bufferAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+				bufferAllocInfo.allocationSize = buffer_requirements.size;
+				bufferAllocInfo.memoryTypeIndex = buffer_memory_type.value_or ( 0 );
+
+				// readback memory stays mapped for the lifetime of the target
+				if ( !buffer_memory_type.has_value () ||
+					vkAllocateMemory ( logicalDevice , &bufferAllocInfo , nullptr , &offscreen_data.readback_memory_[ i ] ) != VK_SUCCESS ||
+					vkBindBufferMemory ( logicalDevice , offscreen_data.readback_buffers_[ i ] , offscreen_data.readback_memory_[ i ] , 0 ) != VK_SUCCESS ||
+					vkMapMemory ( logicalDevice , offscreen_data.readback_memory_[ i ] , 0 , readback_size , 0 , &offscreen_data.readback_mapped_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkOffscreenTarget failed! Failed to allocate readback memory " , i , "." );
+					Misc::DestroyOffscreenTarget ( logicalDevice , offscreen_data );
+					return offscreen_data;
+				}
+			}
+
+			offscreen_data.image_views_ = Get::vkSwapChainImageViews ( logicalDevice , offscreen_data.images_ , offscreen_data.format_ );
+
+			return offscreen_data;
+		}
+
+		VkRenderPass vkRenderPass ( VkDevice logicalDevice , VkFormat imageFormat , VkImageLayout finalLayout )
 		{
+			vkTrace::Zone zone ( "Create::vkRenderPass" );
+
 			// single color buffer attachment from one of the images from the swap chain
 			VkAttachmentDescription colorAttachment {};
 			colorAttachment.format = imageFormat;
@@ -358,7 +517,7 @@ namespace vkHelper
 			colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			colorAttachment.finalLayout = finalLayout;
 
 			// subpasses and attachment references, for postprocessing
 			VkAttachmentReference colorAttachmentRef {};
@@ -370,13 +529,21 @@ namespace vkHelper
 			subpass.colorAttachmentCount = 1;
 			subpass.pColorAttachments = &colorAttachmentRef;
 
-			VkSubpassDependency dependency {};
-			dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-			dependency.dstSubpass = 0;
-			dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependency.srcAccessMask = 0;
-			dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			VkSubpassDependency dependencies[ 2 ] {};
+			dependencies[ 0 ].srcSubpass = VK_SUBPASS_EXTERNAL;
+			dependencies[ 0 ].dstSubpass = 0;
+			dependencies[ 0 ].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependencies[ 0 ].srcAccessMask = 0;
+			dependencies[ 0 ].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependencies[ 0 ].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+			// offscreen images are copied out after the pass, make the color writes visible to the transfer
+			dependencies[ 1 ].srcSubpass = 0;
+			dependencies[ 1 ].dstSubpass = VK_SUBPASS_EXTERNAL;
+			dependencies[ 1 ].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependencies[ 1 ].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			dependencies[ 1 ].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			dependencies[ 1 ].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
 			// create render pass
 			VkRenderPassCreateInfo renderPassInfo {};
@@ -385,31 +552,69 @@ namespace vkHelper
 			renderPassInfo.pAttachments = &colorAttachment;
 			renderPassInfo.subpassCount = 1;
 			renderPassInfo.pSubpasses = &subpass;
-			renderPassInfo.dependencyCount = 1;
-			renderPassInfo.pDependencies = &dependency;
+			renderPassInfo.dependencyCount = finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 2 : 1;
+			renderPassInfo.pDependencies = dependencies;
 
 			VkRenderPass render_pass { VK_NULL_HANDLE };
 			if ( vkCreateRenderPass ( logicalDevice , &renderPassInfo , nullptr , &render_pass ) != VK_SUCCESS )
 			{
-				std::cerr << "### vkHelper::Create::vkRenderPass failed! Failed to create render pass." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkRenderPass failed! Failed to create render pass." );
 				return VK_NULL_HANDLE;
 			}
 
 			return render_pass;
 		}
 
-		vkPipelineData vkGraphicsPipeline ( VkDevice logicalDevice , vkSwapChainData swapChainData , VkRenderPass renderPass )
+		vkPipelineData vkGraphicsPipeline ( VkDevice logicalDevice , VkRenderPass renderPass , VkPipelineCache pipelineCache , bool instanced ,
+			std::vector<VkDescriptorSetLayout> const& setLayouts , uint32_t pushConstantSize , vkShaderCacheData* shaderCache , vkPipelineState const& state )
 		{
+			vkTrace::Zone zone ( "Create::vkGraphicsPipeline" );
+
 			vkPipelineData pipeline_data;
+			pipeline_data.pipeline_ = VK_NULL_HANDLE;
+			pipeline_data.layout_ = VK_NULL_HANDLE;
+			pipeline_data.cache_ = pipelineCache;
+			pipeline_data.instanced_ = instanced;
+			pipeline_data.set_layouts_ = setLayouts;
+			pipeline_data.push_constant_size_ = pushConstantSize;
+			pipeline_data.shaders_ = shaderCache;
+			pipeline_data.state_ = state;
+
+			char const* vertShaderFile = !instanced ? "shaders/vert.spv" : pushConstantSize > 0 ? "shaders/instanced_push_vert.spv" : "shaders/instanced_vert.spv";
+			if ( !state.vertex_shader_.empty () )
+			{
+				vertShaderFile = state.vertex_shader_.c_str ();
+			}
+			char const* fragShaderFile = "shaders/frag.spv";
+
+			VkShaderModule vertShaderModule { VK_NULL_HANDLE };
+			VkShaderModule fragShaderModule { VK_NULL_HANDLE };
+			if ( shaderCache )
+			{
+				// cached modules, no file is read again and nothing is created on a rebuild
+				vertShaderModule = IO::LoadShaderModule ( logicalDevice , *shaderCache , vertShaderFile );
+				fragShaderModule = IO::LoadShaderModule ( logicalDevice , *shaderCache , fragShaderFile );
+				if ( vertShaderModule == VK_NULL_HANDLE || fragShaderModule == VK_NULL_HANDLE )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkGraphicsPipeline failed! Failed to load shader modules." );
+					return pipeline_data;
+				}
+			}
+			else
+			{
+				auto vertShaderCode = IO::ReadFile ( vertShaderFile );
+				auto fragShaderCode = IO::ReadFile ( fragShaderFile );
 
-			auto vertShaderCode = IO::ReadFile ( "shaders/vert.spv" );
-			auto fragShaderCode = IO::ReadFile ( "shaders/frag.spv" );
+				VKLOG_TRACE ( "size of vert read : " , vertShaderCode.size () );
+				VKLOG_TRACE ( "size of frag read : " , fragShaderCode.size () );
 
-			std::cout << "size of vert read : " << vertShaderCode.size () << std::endl;
-			std::cout << "size of frag read : " << fragShaderCode.size () << std::endl;
+				vertShaderModule = IO::CreateShaderModule ( logicalDevice , vertShaderCode );
+				fragShaderModule = IO::CreateShaderModule ( logicalDevice , fragShaderCode );
+			}
 
-			VkShaderModule vertShaderModule = IO::CreateShaderModule ( logicalDevice , vertShaderCode );
-			VkShaderModule fragShaderModule = IO::CreateShaderModule ( logicalDevice , fragShaderCode );
+			// the same constants go to both stages, the driver folds the branches they decide per variant
+			VkSpecializationInfo specialization = state.constants_.Info ();
+			VkSpecializationInfo const* specialization_info = state.constants_.entries_.empty () ? nullptr : &specialization;
 
 			// vertex shader stage creation
 			VkPipelineShaderStageCreateInfo vertShaderStageInfo {};
@@ -417,7 +622,7 @@ namespace vkHelper
 			vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
 			vertShaderStageInfo.module = vertShaderModule;
 			vertShaderStageInfo.pName = "main";
-			vertShaderStageInfo.pSpecializationInfo = nullptr;  // used to optimize constant variables
+			vertShaderStageInfo.pSpecializationInfo = specialization_info;
 
 			// fragment shader stage creation
 			VkPipelineShaderStageCreateInfo fragShaderStageInfo {};
@@ -425,45 +630,57 @@ namespace vkHelper
 			fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 			fragShaderStageInfo.module = fragShaderModule;
 			fragShaderStageInfo.pName = "main";
-			fragShaderStageInfo.pSpecializationInfo = nullptr;  // used to optimize constant variables
+			fragShaderStageInfo.pSpecializationInfo = specialization_info;
 
 			VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
-			// fixed function pipeline setup - vertex input, no vertex data for now
+			// fixed function pipeline setup - vertex input, binding 0 per vertex, binding 1 per instance
+			VkVertexInputBindingDescription bindingDescriptions[ 2 ] {};
+			bindingDescriptions[ 0 ].binding = 0;
+			bindingDescriptions[ 0 ].stride = sizeof ( vkVertex );
+			bindingDescriptions[ 0 ].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+			bindingDescriptions[ 1 ].binding = 1;
+			bindingDescriptions[ 1 ].stride = sizeof ( vkHelper::vkInstance );
+			bindingDescriptions[ 1 ].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+			VkVertexInputAttributeDescription attributeDescriptions[ 4 ] {};
+			attributeDescriptions[ 0 ] = { 0 , 0 , VK_FORMAT_R32G32_SFLOAT , offsetof ( vkVertex , position_ ) };
+			attributeDescriptions[ 1 ] = { 1 , 0 , VK_FORMAT_R32G32B32_SFLOAT , offsetof ( vkVertex , color_ ) };
+			attributeDescriptions[ 2 ] = { 2 , 1 , VK_FORMAT_R32G32B32A32_SFLOAT , offsetof ( vkHelper::vkInstance , transform_ ) };
+			attributeDescriptions[ 3 ] = { 3 , 1 , VK_FORMAT_R32G32B32A32_SFLOAT , offsetof ( vkHelper::vkInstance , color_ ) };
+
+			// the built in triangle has no vertex data
 			VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
 			vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			vertexInputInfo.vertexBindingDescriptionCount = 0;
-			vertexInputInfo.pVertexBindingDescriptions = nullptr;
-			vertexInputInfo.vertexAttributeDescriptionCount = 0;
-			vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+			vertexInputInfo.vertexBindingDescriptionCount = instanced ? 2 : 0;
+			vertexInputInfo.pVertexBindingDescriptions = instanced ? bindingDescriptions : nullptr;
+			vertexInputInfo.vertexAttributeDescriptionCount = instanced ? 4 : 0;
+			vertexInputInfo.pVertexAttributeDescriptions = instanced ? attributeDescriptions : nullptr;
+
+			// or a bare position per vertex
+			VkVertexInputBindingDescription positionBinding { 0 , state.position_stride_ , VK_VERTEX_INPUT_RATE_VERTEX };
+			VkVertexInputAttributeDescription positionAttribute { 0 , 0 , VK_FORMAT_R32G32B32A32_SFLOAT , 0 };
+			if ( state.position_stride_ > 0 )
+			{
+				vertexInputInfo.vertexBindingDescriptionCount = 1;
+				vertexInputInfo.pVertexBindingDescriptions = &positionBinding;
+				vertexInputInfo.vertexAttributeDescriptionCount = 1;
+				vertexInputInfo.pVertexAttributeDescriptions = &positionAttribute;
+			}
 
 			// fixed function pipeline setup - input assembly
 			VkPipelineInputAssemblyStateCreateInfo inputAssembly {};
 			inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-			inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			inputAssembly.topology = state.topology_;
 			inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-			// viewport
-			VkViewport viewport {};
-			viewport.x = 0.0f;
-			viewport.y = 0.0f;
-			viewport.width = ( float ) swapChainData.extent_.width;
-			viewport.height = ( float ) swapChainData.extent_.height;
-			viewport.minDepth = 0.0f;
-			viewport.maxDepth = 1.0f;
-
-			// scizzor rectangle
-			VkRect2D scissor {};
-			scissor.offset = { 0,0 };
-			scissor.extent = swapChainData.extent_;
-
-			// combine viewport and scizzor rectangle into a viewport state
+			// viewport and scizzor rectangle are dynamic, set when recording against the current extent
 			VkPipelineViewportStateCreateInfo viewportState {};
 			viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 			viewportState.viewportCount = 1;
-			viewportState.pViewports = &viewport;
+			viewportState.pViewports = nullptr;
 			viewportState.scissorCount = 1;
-			viewportState.pScissors = &scissor;
+			viewportState.pScissors = nullptr;
 
 			// rasterizer
 			VkPipelineRasterizationStateCreateInfo rasterizer {};
@@ -472,8 +689,8 @@ namespace vkHelper
 			rasterizer.rasterizerDiscardEnable = VK_FALSE;
 			rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
 			rasterizer.lineWidth = 1.0f;
-			rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-			rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+			rasterizer.cullMode = state.cull_mode_;
+			rasterizer.frontFace = state.front_face_;
 			rasterizer.depthBiasEnable = VK_FALSE;
 			rasterizer.depthBiasConstantFactor = 0.0f;
 			rasterizer.depthBiasClamp = 0.0f;
@@ -493,23 +710,28 @@ namespace vkHelper
 			VkPipelineColorBlendAttachmentState colorBlendAttachment {};
 			colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
-			// non
-			colorBlendAttachment.blendEnable = VK_FALSE;
-			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-			// alpha blend
-			/*colorBlendAttachment.blendEnable = VK_TRUE;
-			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;*/
+			if ( !state.alpha_blend_ )
+			{
+				// non
+				colorBlendAttachment.blendEnable = VK_FALSE;
+				colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+				colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+				colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+				colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+				colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+			}
+			else
+			{
+				// alpha blend
+				colorBlendAttachment.blendEnable = VK_TRUE;
+				colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+				colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+				colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+				colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+			}
 
 			// color blend state
 			VkPipelineColorBlendStateCreateInfo colorBlending {};
@@ -526,7 +748,7 @@ namespace vkHelper
 			// setting dynamic states of the pipeline to modify it without recreating entire pipeline
 			VkDynamicState dynamicStates[] = {
 				VK_DYNAMIC_STATE_VIEWPORT,
-				VK_DYNAMIC_STATE_LINE_WIDTH
+				VK_DYNAMIC_STATE_SCISSOR
 			};
 
 			VkPipelineDynamicStateCreateInfo dynamicState {};
@@ -538,14 +760,20 @@ namespace vkHelper
 
 			VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
 			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutInfo.setLayoutCount = 0;
-			pipelineLayoutInfo.pSetLayouts = nullptr;
-			pipelineLayoutInfo.pushConstantRangeCount = 0;
-			pipelineLayoutInfo.pPushConstantRanges = nullptr;
+			pipelineLayoutInfo.setLayoutCount = static_cast< uint32_t >( setLayouts.size () );
+			pipelineLayoutInfo.pSetLayouts = setLayouts.empty () ? nullptr : setLayouts.data ();
+
+			// small per draw data, recorded straight into the command buffer
+			VkPushConstantRange pushConstantRange {};
+			pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+			pushConstantRange.offset = 0;
+			pushConstantRange.size = pushConstantSize;
+			pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+			pipelineLayoutInfo.pPushConstantRanges = pushConstantSize > 0 ? &pushConstantRange : nullptr;
 
 			if ( vkCreatePipelineLayout ( logicalDevice , &pipelineLayoutInfo , nullptr , &pipeline_data.layout_ ) != VK_SUCCESS )
 			{
-				std::cerr << "vkHelper::Create::vkGraphicsPipeline failed! Failed to create pipeline layout." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkGraphicsPipeline failed! Failed to create pipeline layout." );
 			}
 
 			// creating pipeline
@@ -564,7 +792,7 @@ namespace vkHelper
 			pipelineInfo.pMultisampleState = &multisampling;
 			pipelineInfo.pDepthStencilState = nullptr; // Optional
 			pipelineInfo.pColorBlendState = &colorBlending;
-			pipelineInfo.pDynamicState = nullptr;
+			pipelineInfo.pDynamicState = &dynamicState;
 
 			// pipeline layout
 			pipelineInfo.layout = pipeline_data.layout_;
@@ -577,20 +805,171 @@ namespace vkHelper
 			pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 			pipelineInfo.basePipelineIndex = -1;
 
-			if ( vkCreateGraphicsPipelines ( logicalDevice , VK_NULL_HANDLE , 1 , &pipelineInfo , nullptr , &pipeline_data.pipeline_ ) != VK_SUCCESS )
+			if ( vkCreateGraphicsPipelines ( logicalDevice , pipelineCache , 1 , &pipelineInfo , nullptr , &pipeline_data.pipeline_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkGraphicsPipeline failed! Failed to create graphics pipeline." );
+			}
+
+			// clean up local shader modules after compiling and linking, cached ones live as long as the cache
+			if ( !shaderCache )
+			{
+				vkDestroyShaderModule ( logicalDevice , fragShaderModule , nullptr );
+				vkDestroyShaderModule ( logicalDevice , vertShaderModule , nullptr );
+			}
+
+			return pipeline_data;
+		}
+
+		vkPipelineData vkComputePipeline ( VkDevice logicalDevice , std::string const& shaderFile , std::vector<VkDescriptorSetLayout> const& setLayouts ,
+			uint32_t pushConstantSize , VkPipelineCache pipelineCache , vkShaderCacheData* shaderCache )
+		{
+			vkTrace::Zone zone ( "Create::vkComputePipeline" );
+
+			vkPipelineData pipeline_data;
+			pipeline_data.pipeline_ = VK_NULL_HANDLE;
+			pipeline_data.layout_ = VK_NULL_HANDLE;
+			pipeline_data.cache_ = pipelineCache;
+			pipeline_data.shaders_ = shaderCache;
+
+			VkShaderModule compShaderModule = shaderCache ? IO::LoadShaderModule ( logicalDevice , *shaderCache , shaderFile ) :
+				IO::CreateShaderModule ( logicalDevice , IO::ReadFile ( shaderFile ) );
+			if ( compShaderModule == VK_NULL_HANDLE )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkComputePipeline failed! Failed to load " , shaderFile , "." );
+				return pipeline_data;
+			}
+
+			VkPushConstantRange pushConstantRange {};
+			pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			pushConstantRange.offset = 0;
+			pushConstantRange.size = pushConstantSize;
+
+			VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutInfo.setLayoutCount = static_cast< uint32_t >( setLayouts.size () );
+			pipelineLayoutInfo.pSetLayouts = setLayouts.empty () ? nullptr : setLayouts.data ();
+			pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+			pipelineLayoutInfo.pPushConstantRanges = pushConstantSize > 0 ? &pushConstantRange : nullptr;
+
+			if ( vkCreatePipelineLayout ( logicalDevice , &pipelineLayoutInfo , nullptr , &pipeline_data.layout_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkComputePipeline failed! Failed to create pipeline layout." );
+				if ( !shaderCache )
+				{
+					vkDestroyShaderModule ( logicalDevice , compShaderModule , nullptr );
+				}
+				return pipeline_data;
+			}
+
+			VkComputePipelineCreateInfo pipelineInfo {};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipelineInfo.stage.module = compShaderModule;
+			pipelineInfo.stage.pName = "main";
+			pipelineInfo.layout = pipeline_data.layout_;
+			pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+			pipelineInfo.basePipelineIndex = -1;
+
+			if ( vkCreateComputePipelines ( logicalDevice , pipelineCache , 1 , &pipelineInfo , nullptr , &pipeline_data.pipeline_ ) != VK_SUCCESS )
 			{
-				std::cerr << "vkHelper::Create::vkGraphicsPipeline failed! Failed to create graphics pipeline." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkComputePipeline failed! Failed to create compute pipeline from " , shaderFile , "." );
+				pipeline_data.pipeline_ = VK_NULL_HANDLE;
 			}
 
-			// clean up local shader modules after compiling and linking
-			vkDestroyShaderModule ( logicalDevice , fragShaderModule , nullptr );
-			vkDestroyShaderModule ( logicalDevice , vertShaderModule , nullptr );
+			if ( !shaderCache )
+			{
+				vkDestroyShaderModule ( logicalDevice , compShaderModule , nullptr );
+			}
 
 			return pipeline_data;
 		}
 
+		VkDescriptorSetLayout vkDescriptorSetLayout ( VkDevice logicalDevice , std::vector<VkDescriptorSetLayoutBinding> const& bindings )
+		{
+			VkDescriptorSetLayoutCreateInfo layoutInfo {};
+			layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutInfo.bindingCount = static_cast< uint32_t >( bindings.size () );
+			layoutInfo.pBindings = bindings.empty () ? nullptr : bindings.data ();
+
+			VkDescriptorSetLayout set_layout { VK_NULL_HANDLE };
+			if ( vkCreateDescriptorSetLayout ( logicalDevice , &layoutInfo , nullptr , &set_layout ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkDescriptorSetLayout failed! Failed to create descriptor set layout." );
+				return VK_NULL_HANDLE;
+			}
+			return set_layout;
+		}
+
+		VkDescriptorPool vkDescriptorPool ( VkDevice logicalDevice , std::vector<VkDescriptorPoolSize> const& poolSizes , uint32_t maxSets , VkDescriptorPoolCreateFlags flags )
+		{
+			VkDescriptorPoolCreateInfo poolInfo {};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.flags = flags;
+			poolInfo.maxSets = maxSets;
+			poolInfo.poolSizeCount = static_cast< uint32_t >( poolSizes.size () );
+			poolInfo.pPoolSizes = poolSizes.empty () ? nullptr : poolSizes.data ();
+
+			VkDescriptorPool pool { VK_NULL_HANDLE };
+			if ( vkCreateDescriptorPool ( logicalDevice , &poolInfo , nullptr , &pool ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkDescriptorPool failed! Failed to create descriptor pool." );
+				return VK_NULL_HANDLE;
+			}
+			return pool;
+		}
+
+		bool vkDescriptorSets ( VkDevice logicalDevice , VkDescriptorPool pool , VkDescriptorSetLayout layout , uint32_t count , std::vector<VkDescriptorSet>& sets )
+		{
+			std::vector<VkDescriptorSetLayout> layouts ( count , layout );
+
+			VkDescriptorSetAllocateInfo allocInfo {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = pool;
+			allocInfo.descriptorSetCount = count;
+			allocInfo.pSetLayouts = layouts.data ();
+
+			sets.assign ( count , VK_NULL_HANDLE );
+			if ( vkAllocateDescriptorSets ( logicalDevice , &allocInfo , sets.data () ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkDescriptorSets failed! Failed to allocate descriptor sets." );
+				sets.clear ();
+				return false;
+			}
+			return true;
+		}
+
+		VkPipelineCache vkPipelineCache ( vkDeviceProfile const& profile , VkDevice logicalDevice , std::string const& filename , std::vector<char> const* fileData )
+		{
+			vkTrace::Zone zone ( "Create::vkPipelineCache" );
+
+			std::vector<char> cache_data;
+			bool loaded = fileData ? !fileData->empty () && IO::ParsePipelineCacheData ( profile , filename , *fileData , cache_data ) : IO::LoadPipelineCacheData ( profile , filename , cache_data );
+			if ( !loaded )
+			{
+				cache_data.clear ();
+			}
+
+			VkPipelineCacheCreateInfo cacheInfo {};
+			cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			cacheInfo.initialDataSize = cache_data.size ();
+			cacheInfo.pInitialData = cache_data.empty () ? nullptr : cache_data.data ();
+
+			VkPipelineCache pipeline_cache { VK_NULL_HANDLE };
+			if ( vkCreatePipelineCache ( logicalDevice , &cacheInfo , nullptr , &pipeline_cache ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::vkPipelineCache failed! Failed to create pipeline cache." );
+				return VK_NULL_HANDLE;
+			}
+
+			VKLOG_INFO ( "### Pipeline cache seeded with " , cache_data.size () , " bytes from " , filename );
+			return pipeline_cache;
+		}
+
 		bool vkFramebuffers ( VkDevice logicalDevice , vkSwapChainData& swapChainData , VkRenderPass renderPass , std::vector<VkFramebuffer>& framebuffers )
 		{
+			vkTrace::Zone zone ( "Create::vkFramebuffers" );
+
 			framebuffers.resize ( swapChainData.image_views_.size () );
 
 			// iterate image views and create framebuffers from them
@@ -611,16 +990,18 @@ namespace vkHelper
 
 				if ( vkCreateFramebuffer ( logicalDevice , &framebufferInfo , nullptr , &framebuffers[ i ] ) != VK_SUCCESS )
 				{
-					std::cerr << "vkHelper::Create::vkFramebuffers failed! Failed to create framebuffer " << i << "." << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Create::vkFramebuffers failed! Failed to create framebuffer " , i , "." );
 					return false;
 				}
 			}
 			return true;
 		}
 
-		VkCommandPool vkCommandPool ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice )
+		VkCommandPool vkCommandPool ( vkDeviceProfile const& profile , VkDevice logicalDevice )
 		{
-			Get::QueueFamilyIndices queueFamilyIndices = Get::QueueFamilies ( physicalDevice , surface );
+			vkTrace::Zone zone ( "Create::vkCommandPool" );
+
+			Get::QueueFamilyIndices const& queueFamilyIndices = profile.indices_;
 
 			VkCommandPoolCreateInfo poolInfo {};
 			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -630,14 +1011,17 @@ namespace vkHelper
 			VkCommandPool command_pool;
 			if ( vkCreateCommandPool ( logicalDevice , &poolInfo , nullptr , &command_pool ) != VK_SUCCESS )
 			{
-				std::cerr << "vkHelper::Create::vkCommandPool failed! Failed to create command pool." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkCommandPool failed! Failed to create command pool." );
 				return VK_NULL_HANDLE;
 			}
 			return command_pool;
 		}
 
-		bool vkCommandBuffers ( VkDevice logicalDevice , vkSwapChainData swapChain , VkRenderPass renderPass , vkPipelineData graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers )
+		bool vkCommandBuffers ( VkDevice logicalDevice , vkSwapChainData swapChain , VkRenderPass renderPass , vkPipelineData graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers ,
+			vkFrameTimingData const* timings )
 		{
+			vkTrace::Zone zone ( "Create::vkCommandBuffers" );
+
 			commandBuffers.resize ( framebuffers.size () );
 
 			VkCommandBufferAllocateInfo allocInfo {};
@@ -648,68 +1032,192 @@ namespace vkHelper
 
 			if ( vkAllocateCommandBuffers ( logicalDevice , &allocInfo , commandBuffers.data () ) != VK_SUCCESS )
 			{
-				std::cerr << "vkHelper::Create::vkCommandBuffers failed! Failed to allocate command buffers." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Create::vkCommandBuffers failed! Failed to allocate command buffers." );
 				return false;
 			}
 
 			for ( size_t i = 0; i < commandBuffers.size (); ++i )
 			{
-				// begin command buffer
-				VkCommandBufferBeginInfo beginInfo {};
-				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-				beginInfo.flags = 0;
-				beginInfo.pInheritanceInfo = nullptr;
+				if ( !Misc::RecordCommandBuffer ( commandBuffers[ i ] , swapChain , renderPass , graphicsPipeline , framebuffers[ i ] , static_cast< uint32_t >( i ) , 0 , timings ) )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkCommandBuffers failed! Failed to record command buffer." );
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool SyncObjects ( VkDevice logicalDevice , vkSwapChainData swapChain , vkSyncObjects& syncObjects , uint32_t framesInFlight )
+		{
+			vkTrace::Zone zone ( "Create::SyncObjects" );
+
+			if ( framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::SyncObjects failed! " , framesInFlight , " frames in flight, expected 1 to " , MAX_FRAMES_IN_FLIGHT , "." );
+				return false;
+			}
 
-				if ( vkBeginCommandBuffer ( commandBuffers[ i ] , &beginInfo ) != VK_SUCCESS )
+			syncObjects.available_semaphores_.resize ( framesInFlight );
+			syncObjects.finished_semaphores_.resize ( framesInFlight );
+			syncObjects.in_flight_fences_.resize ( framesInFlight );
+			syncObjects.images_in_flight_.resize ( swapChain.images_.size () , VK_NULL_HANDLE );
+
+			VkSemaphoreCreateInfo semaphoreInfo {};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+			VkFenceCreateInfo fenceInfo {};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+			for ( size_t i = 0; i < framesInFlight; ++i )
+			{
+				if ( vkCreateSemaphore ( logicalDevice , &semaphoreInfo , nullptr , &syncObjects.available_semaphores_[ i ] ) != VK_SUCCESS ||
+					vkCreateSemaphore ( logicalDevice , &semaphoreInfo , nullptr , &syncObjects.finished_semaphores_[ i ] ) != VK_SUCCESS ||
+					vkCreateFence ( logicalDevice , &fenceInfo , nullptr , &syncObjects.in_flight_fences_[ i ] ) != VK_SUCCESS )
 				{
-					std::cerr << "vkHelper::Create::vkCommandBuffers failed! Failed to begin command buffer." << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Create::SyncObjects failed! Failed to create semaphore for a frame." );
 					return false;
 				}
+			}
+			return true;
+		}
 
-				// assign render pass to command buffer and begin render pass
-				VkRenderPassBeginInfo renderPassInfo {};
-				renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-				renderPassInfo.renderPass = renderPass;
-				renderPassInfo.framebuffer = framebuffers[ i ];
-				renderPassInfo.renderArea.offset = { 0,0 };
-				renderPassInfo.renderArea.extent = swapChain.extent_;
+		bool vkFrameCommands ( vkDeviceProfile const& profile , VkDevice logicalDevice , vkFrameCommandData& frameCommands , uint32_t threadCount , uint32_t drawCount , uint32_t framesInFlight )
+		{
+			vkTrace::Zone zone ( "Create::vkFrameCommands" );
+
+			frameCommands.pools_.assign ( framesInFlight , VK_NULL_HANDLE );
+			frameCommands.buffers_.assign ( framesInFlight , VK_NULL_HANDLE );
+			frameCommands.pre_buffers_.assign ( framesInFlight , VK_NULL_HANDLE );
+			frameCommands.draw_count_ = drawCount;
+			frameCommands.thread_count_ = threadCount;
+			frameCommands.secondary_pools_.assign ( framesInFlight * threadCount , VK_NULL_HANDLE );
+			frameCommands.secondary_buffers_.assign ( framesInFlight * threadCount , VK_NULL_HANDLE );
+
+			// transient, the pool is reset every frame so the driver can skip per buffer bookkeeping
+			VkCommandPoolCreateInfo poolInfo {};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = profile.indices_.graphics_family_.value ();
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-				VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
-				renderPassInfo.clearValueCount = 1;
-				renderPassInfo.pClearValues = &clearColor;
+			for ( size_t i = 0; i < framesInFlight; ++i )
+			{
+				if ( vkCreateCommandPool ( logicalDevice , &poolInfo , nullptr , &frameCommands.pools_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkFrameCommands failed! Failed to create transient command pool." );
+					return false;
+				}
 
-				vkCmdBeginRenderPass ( commandBuffers[ i ] , &renderPassInfo , VK_SUBPASS_CONTENTS_INLINE );
+				VkCommandBufferAllocateInfo allocInfo {};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = frameCommands.pools_[ i ];
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocInfo.commandBufferCount = 1;
 
-				// bind graphics pipeline
-				vkCmdBindPipeline ( commandBuffers[ i ] , VK_PIPELINE_BIND_POINT_GRAPHICS , graphicsPipeline.pipeline_ );
+				if ( vkAllocateCommandBuffers ( logicalDevice , &allocInfo , &frameCommands.buffers_[ i ] ) != VK_SUCCESS ||
+					vkAllocateCommandBuffers ( logicalDevice , &allocInfo , &frameCommands.pre_buffers_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkFrameCommands failed! Failed to allocate command buffer." );
+					return false;
+				}
+			}
 
-				// bind draw command
-				// param
-				// 1. command buffer
-				// 2. vertex count
-				// 3. first vertex
-				// 4. first instance
-				vkCmdDraw ( commandBuffers[ i ] , 3 , 1 , 0 , 0 );
+			// command pools are externally synchronized, every worker records from its own pool per frame
+			for ( size_t i = 0; i < frameCommands.secondary_pools_.size (); ++i )
+			{
+				if ( vkCreateCommandPool ( logicalDevice , &poolInfo , nullptr , &frameCommands.secondary_pools_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::vkFrameCommands failed! Failed to create worker command pool." );
+					return false;
+				}
 
-				// end render pass
-				vkCmdEndRenderPass ( commandBuffers[ i ] );
+				VkCommandBufferAllocateInfo allocInfo {};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = frameCommands.secondary_pools_[ i ];
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				allocInfo.commandBufferCount = 1;
 
-				// end command buffer
-				if ( vkEndCommandBuffer ( commandBuffers[ i ] ) != VK_SUCCESS )
+				if ( vkAllocateCommandBuffers ( logicalDevice , &allocInfo , &frameCommands.secondary_buffers_[ i ] ) != VK_SUCCESS )
 				{
-					std::cerr << "vkHelper::Create::vkEndCommandBuffer failed! Failed to end command buffer." << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Create::vkFrameCommands failed! Failed to allocate secondary command buffer." );
 					return false;
 				}
 			}
+
+			if ( threadCount > 0 )
+			{
+				frameCommands.workers_ = std::make_unique<vkRecordWorkers> ();
+				RecordWorkers ( threadCount , *frameCommands.workers_ );
+			}
 			return true;
 		}
 
-		bool SyncObjects ( VkDevice logicalDevice , vkSwapChainData swapChain , vkSyncObjects& syncObjects )
+		void RecordWorkers ( uint32_t threadCount , vkRecordWorkers& workers )
 		{
-			syncObjects.available_semaphores_.resize ( MAX_FRAMES_IN_FLIGHT );
-			syncObjects.finished_semaphores_.resize ( MAX_FRAMES_IN_FLIGHT );
-			syncObjects.in_flight_fences_.resize ( MAX_FRAMES_IN_FLIGHT );
-			syncObjects.images_in_flight_.resize ( swapChain.images_.size () , VK_NULL_HANDLE );
+			vkTrace::Zone zone ( "Create::RecordWorkers" );
+
+			workers.threads_.reserve ( threadCount );
+			for ( uint32_t i = 0; i < threadCount; ++i )
+			{
+				workers.threads_.emplace_back ( Misc::RecordWorkerLoop , &workers , i );
+			}
+		}
+
+		bool FrameTimings ( vkDeviceProfile const& profile , VkDevice logicalDevice , vkFrameTimingData& timings )
+		{
+			vkTrace::Zone zone ( "Create::FrameTimings" );
+
+			timings.cpu_samples_.assign ( vkFrameTimingData::RING_SIZE , {} );
+			timings.gpu_samples_.assign ( vkFrameTimingData::RING_SIZE , 0.0 );
+			timings.query_pending_.assign ( vkFrameTimingData::MAX_TIMED_IMAGES , false );
+			timings.latency_samples_.assign ( vkFrameTimingData::RING_SIZE , 0.0 );
+			timings.cpu_count_ = 0;
+			timings.gpu_count_ = 0;
+			timings.latency_count_ = 0;
+			timings.slot_start_.clear ();
+			timings.last_frame_start_ = {};
+
+			// timestamps are only valid if the graphics queue family supports them
+			uint32_t valid_bits = profile.queue_families_[ profile.indices_.graphics_family_.value () ].timestampValidBits;
+			if ( valid_bits == 0 )
+			{
+				VKLOG_INFO ( "### vkHelper::Create::FrameTimings graphics queue has no timestamp support, gpu timings disabled." );
+				return true;
+			}
+			timings.timestamp_mask_ = valid_bits >= 64 ? ~0ull : ( 1ull << valid_bits ) - 1;
+
+			timings.timestamp_period_ = static_cast< double >( profile.properties_.limits.timestampPeriod );
+
+			VkQueryPoolCreateInfo queryPoolInfo {};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolInfo.queryCount = vkFrameTimingData::MAX_TIMED_IMAGES * 2;
+
+			if ( vkCreateQueryPool ( logicalDevice , &queryPoolInfo , nullptr , &timings.query_pool_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::FrameTimings failed! Failed to create timestamp query pool." );
+				return false;
+			}
+			return true;
+		}
+
+		bool AsyncCompute ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkQueue computeQueue , vkAsyncComputeData& asyncCompute , uint32_t framesInFlight )
+		{
+			vkTrace::Zone zone ( "Create::AsyncCompute" );
+
+			uint32_t compute_family = profile.indices_.compute_family_.value ();
+			asyncCompute.queue_ = computeQueue;
+			asyncCompute.pools_.assign ( framesInFlight , VK_NULL_HANDLE );
+			asyncCompute.buffers_.assign ( framesInFlight , VK_NULL_HANDLE );
+			asyncCompute.finished_semaphores_.assign ( framesInFlight , VK_NULL_HANDLE );
+			asyncCompute.fences_.assign ( framesInFlight , VK_NULL_HANDLE );
+			asyncCompute.query_pending_.assign ( framesInFlight , false );
+			asyncCompute.frame_images_.assign ( framesInFlight , 0 );
+
+			VkCommandPoolCreateInfo poolInfo {};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = compute_family;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
 			VkSemaphoreCreateInfo semaphoreInfo {};
 			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -718,15 +1226,56 @@ namespace vkHelper
 			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 			fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-			for ( size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i )
+			for ( size_t i = 0; i < framesInFlight; ++i )
 			{
-				if ( vkCreateSemaphore ( logicalDevice , &semaphoreInfo , nullptr , &syncObjects.available_semaphores_[ i ] ) != VK_SUCCESS ||
-					vkCreateSemaphore ( logicalDevice , &semaphoreInfo , nullptr , &syncObjects.finished_semaphores_[ i ] ) != VK_SUCCESS ||
-					vkCreateFence ( logicalDevice , &fenceInfo , nullptr , &syncObjects.in_flight_fences_[ i ] ) != VK_SUCCESS )
+				if ( vkCreateCommandPool ( logicalDevice , &poolInfo , nullptr , &asyncCompute.pools_[ i ] ) != VK_SUCCESS )
 				{
-					std::cerr << "vkHelper::Create::SyncObjects failed! Failed to create semaphore for a frame." << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Create::AsyncCompute failed! Failed to create compute command pool." );
 					return false;
 				}
+
+				VkCommandBufferAllocateInfo allocInfo {};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = asyncCompute.pools_[ i ];
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocInfo.commandBufferCount = 1;
+
+				if ( vkAllocateCommandBuffers ( logicalDevice , &allocInfo , &asyncCompute.buffers_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::AsyncCompute failed! Failed to allocate compute command buffer." );
+					return false;
+				}
+
+				if ( vkCreateSemaphore ( logicalDevice , &semaphoreInfo , nullptr , &asyncCompute.finished_semaphores_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::AsyncCompute failed! Failed to create compute semaphore." );
+					return false;
+				}
+
+				if ( vkCreateFence ( logicalDevice , &fenceInfo , nullptr , &asyncCompute.fences_[ i ] ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkHelper::Create::AsyncCompute failed! Failed to create compute fence." );
+					return false;
+				}
+			}
+
+			uint32_t valid_bits = profile.queue_families_[ compute_family ].timestampValidBits;
+			if ( valid_bits == 0 )
+			{
+				VKLOG_INFO ( "### vkHelper::Create::AsyncCompute compute queue has no timestamp support, overlap timing disabled." );
+				return true;
+			}
+			asyncCompute.timestamp_mask_ = valid_bits >= 64 ? ~0ull : ( 1ull << valid_bits ) - 1;
+
+			VkQueryPoolCreateInfo queryPoolInfo {};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolInfo.queryCount = framesInFlight * 2;
+
+			if ( vkCreateQueryPool ( logicalDevice , &queryPoolInfo , nullptr , &asyncCompute.query_pool_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Create::AsyncCompute failed! Failed to create timestamp query pool." );
+				return false;
 			}
 			return true;
 		}
@@ -736,10 +1285,10 @@ namespace vkHelper
 	{
 		bool vkLayersSupport ( std::vector<char const*> requestedLayers )
 		{
-			std::cout << "### Requested Layers:" << std::endl;
+			VKLOG_INFO ( "### Requested Layers:" );
 			for ( const auto& layer : requestedLayers )
 			{
-				std::cout << "\t- " << layer << std::endl;
+				VKLOG_INFO ( "\t- " , layer );
 			}
 
 			// get available layers
@@ -748,10 +1297,10 @@ namespace vkHelper
 			std::vector<VkLayerProperties> available_layers ( layer_count );
 			vkEnumerateInstanceLayerProperties ( &layer_count , available_layers.data () );
 
-			std::cout << "### Available Layers:" << std::endl;;
+			VKLOG_INFO ( "### Available Layers:" );
 			for ( const auto& layer : available_layers )
 			{
-				std::cout << "\t- " << layer.layerName << std::endl;
+				VKLOG_INFO ( "\t- " , layer.layerName );
 			}
 
 			for ( const auto& requested_layer : requestedLayers )
@@ -766,13 +1315,13 @@ namespace vkHelper
 				}
 				if ( !layer_found )
 				{
-					std::cerr << "### vkHelper::Check::vkLayersSupported failed! Requested layer not supported." << std::endl;
-					std::cerr << "###\t- " << requested_layer << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Check::vkLayersSupported failed! Requested layer not supported." );
+					VKLOG_FAILURE ( "###\t- " , requested_layer );
 					return false;
 				}
 			}
 
-			std::cout << "### All requested layers supported!" << std::endl;
+			VKLOG_INFO ( "### All requested layers supported!" );
 			return true;
 		}
 
@@ -781,17 +1330,17 @@ namespace vkHelper
 			std::set<std::string> required_extensions ( requestedExtensions.begin () , requestedExtensions.end () );
 
 			// print out requested extensions
-			std::cout << "### Requested " << name << " extensions:" << std::endl;
+			VKLOG_INFO ( "### Requested " , name , " extensions:" );
 			for ( const auto& extension : required_extensions )
 			{
-				std::cout << "\t- " << extension << std::endl;
+				VKLOG_INFO ( "\t- " , extension );
 			}
 
 			// print out available extensions
-			std::cout << "### Available " << name << " instance extensions:" << std::endl;
+			VKLOG_INFO ( "### Available " , name , " instance extensions:" );
 			for ( const auto& extension : availableExtensions )
 			{
-				std::cout << "\t- " << extension.extensionName << std::endl;
+				VKLOG_INFO ( "\t- " , extension.extensionName );
 			}
 
 			// check extensions
@@ -801,18 +1350,18 @@ namespace vkHelper
 			}
 			if ( !required_extensions.empty () )
 			{
-				std::cerr << "### vkHelper::CheckCompareExtensionsList Failed! Requested " << name << " extensions not supported." << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::CheckCompareExtensionsList Failed! Requested " , name , " extensions not supported." );
 				for ( auto const& extension : required_extensions )
 				{
-					std::cerr << "\t- " << extension << std::endl;
+					VKLOG_FAILURE ( "\t- " , extension );
 				}
 				return false;
 			}
-			std::cout << "### All requested " << name << " extensions supported." << std::endl;
+			VKLOG_INFO ( "### All requested " , name , " extensions supported." );
 			return true;
 		}
 
-		bool InstanceExtensionsSupport ( bool debug )
+		bool InstanceExtensionsSupport ( bool debug , bool headless )
 		{
 			// get available extensions
 			uint32_t extension_count { 0 };
@@ -823,42 +1372,54 @@ namespace vkHelper
 			//  - query supported extensions details
 			vkEnumerateInstanceExtensionProperties ( nullptr , &extension_count , available_extensions.data () );
 
-			return CompareExtensionsList ( Get::InstanceExtensions ( debug ) , available_extensions , "instance" );
+			return CompareExtensionsList ( Get::InstanceExtensions ( debug , headless ) , available_extensions , "instance" );
 		}
 
-		bool DeviceExtensionsSupport ( VkPhysicalDevice physicalDevice )
+		bool DeviceExtensionsSupport ( vkDeviceProfile const& profile , bool presentation )
 		{
-			VkPhysicalDeviceProperties device_properties;
-			vkGetPhysicalDeviceProperties ( physicalDevice , &device_properties );
-			std::cout << "### Checking device extensions of: " << device_properties.deviceName << std::endl;
-
-			uint32_t extension_count;
-			vkEnumerateDeviceExtensionProperties ( physicalDevice , nullptr , &extension_count , nullptr );
-			std::vector<VkExtensionProperties> available_extensions ( extension_count );
-			vkEnumerateDeviceExtensionProperties ( physicalDevice , nullptr , &extension_count , available_extensions.data () );
+			VKLOG_INFO ( "### Checking device extensions of: " , profile.properties_.deviceName );
 
-			return CompareExtensionsList ( Get::DeviceExtensions () , available_extensions , "device" );
+			return CompareExtensionsList ( Get::DeviceExtensions ( presentation ) , profile.extensions_ , "device" );
 		}
 
-		bool SwapChainSupport ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		bool SwapChainSupport ( vkDeviceProfile const& profile )
 		{
-			Get::SwapChainSupportDetails details = Get::SwapChainSupportDetails_f ( physicalDevice , surface );
+			Get::SwapChainSupportDetails const& details = profile.swapchain_support_;
 			return !details.formats_.empty () && !details.present_modes_.empty ();
 		}
 
-		bool PhysicalDeviceSuitable ( VkPhysicalDevice device , VkSurfaceKHR surface )
+		bool PhysicalDeviceSuitable ( vkDeviceProfile const& profile )
 		{
-			return Get::QueueFamilies ( device , surface ).IsComplete () &&
-				Check::DeviceExtensionsSupport ( device ) &&
-				Check::SwapChainSupport ( device , surface );
+			// headless, nothing is presented so only graphics support matters
+			if ( profile.surface_ == VK_NULL_HANDLE )
+			{
+				return profile.indices_.IsComplete () &&
+					Check::DeviceExtensionsSupport ( profile , false );
+			}
+
+			return profile.indices_.IsComplete () &&
+				Check::DeviceExtensionsSupport ( profile ) &&
+				Check::SwapChainSupport ( profile );
 		}
-	}
 
-	namespace Get
-	{
-		char const* vkLayer ( VKLAYER layer )
+		bool DeviceExtensionAvailable ( vkDeviceProfile const& profile , char const* extension )
 		{
-			assert ( vk_layers_.find ( layer ) != vk_layers_.end () );
+			for ( auto const& available : profile.extensions_ )
+			{
+				if ( !strcmp ( available.extensionName , extension ) )
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	namespace Get
+	{
+		char const* vkLayer ( VKLAYER layer )
+		{
+			assert ( vk_layers_.find ( layer ) != vk_layers_.end () );
 			return vk_layers_[ layer ];
 		}
 
@@ -876,12 +1437,14 @@ namespace vkHelper
 			return validation_layers;
 		}
 
-		std::vector<char const*> InstanceExtensions ( bool debug )
+		std::vector<char const*> InstanceExtensions ( bool debug , bool headless )
 		{
-			std::vector<char const*> instance_extensions {
-				"VK_KHR_surface",
-				"VK_KHR_win32_surface"
-			};
+			std::vector<char const*> instance_extensions;
+			if ( !headless )
+			{
+				instance_extensions.emplace_back ( "VK_KHR_surface" );
+				instance_extensions.emplace_back ( "VK_KHR_win32_surface" );
+			}
 
 			if ( debug )
 			{
@@ -890,27 +1453,46 @@ namespace vkHelper
 			return instance_extensions;
 		}
 
-		std::vector<char const*> DeviceExtensions ()
+		std::vector<char const*> DeviceExtensions ( bool presentation )
 		{
+			if ( !presentation )
+			{
+				return {};
+			}
 			return {
 				VK_KHR_SWAPCHAIN_EXTENSION_NAME
 			};
 		}
 
-		QueueFamilyIndices QueueFamilies ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		std::vector<char const*> OptionalDeviceExtensions ()
 		{
-			QueueFamilyIndices indices;
+			return {
+				VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME
+			};
+		}
 
-			// get all device queue families
-			uint32_t qfp_count = 0;
-			vkGetPhysicalDeviceQueueFamilyProperties ( physicalDevice , &qfp_count , nullptr );
-			std::vector<VkQueueFamilyProperties> queue_families_properties ( qfp_count );
-			vkGetPhysicalDeviceQueueFamilyProperties ( physicalDevice , &qfp_count , queue_families_properties.data () );
+		std::optional<uint32_t> MemoryType ( vkDeviceProfile const& profile , uint32_t typeFilter , VkMemoryPropertyFlags properties )
+		{
+			VkPhysicalDeviceMemoryProperties const& memory_properties = profile.memory_properties_;
+
+			for ( uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i )
+			{
+				if ( ( typeFilter & ( 1u << i ) ) && ( memory_properties.memoryTypes[ i ].propertyFlags & properties ) == properties )
+				{
+					return i;
+				}
+			}
+			return std::nullopt;
+		}
+
+		QueueFamilyIndices QueueFamilies ( vkDeviceProfile const& profile )
+		{
+			QueueFamilyIndices indices;
 
 			// store them in self made queue family struct, i.e. QueueFamilyIndices
 			// graphics and present family share the same index
-			int i = 0;
-			for ( const auto& qfp : queue_families_properties )
+			uint32_t i = 0;
+			for ( const auto& qfp : profile.queue_families_ )
 			{
 				// look for graphics bit
 				if ( qfp.queueFlags & VK_QUEUE_GRAPHICS_BIT )
@@ -918,10 +1500,8 @@ namespace vkHelper
 					indices.graphics_family_ = i;
 				}
 
-				// look for present support
-				VkBool32 presentSupport = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR ( physicalDevice , i , surface , &presentSupport );
-				if ( presentSupport )
+				// look for present support, headless frames are read back on the graphics family
+				if ( profile.present_support_[ i ] )
 				{
 					indices.present_family_ = i;
 				}
@@ -934,6 +1514,45 @@ namespace vkHelper
 				++i;
 			}
 
+			// prefer a transfer only family, usually a dma engine that copies alongside rendering,
+			// then any transfer family without graphics, else uploads share the graphics family
+			auto find_transfer = [ & ] ( VkQueueFlags excluded ) -> std::optional<uint32_t>
+			{
+				for ( uint32_t family = 0; family < profile.queue_families_.size (); ++family )
+				{
+					VkQueueFlags queue_flags = profile.queue_families_[ family ].queueFlags;
+					if ( ( queue_flags & VK_QUEUE_TRANSFER_BIT ) && !( queue_flags & excluded ) )
+					{
+						return family;
+					}
+				}
+				return std::nullopt;
+			};
+			indices.transfer_family_ = find_transfer ( VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT );
+			if ( !indices.transfer_family_ )
+			{
+				indices.transfer_family_ = find_transfer ( VK_QUEUE_GRAPHICS_BIT );
+			}
+			if ( !indices.transfer_family_ )
+			{
+				indices.transfer_family_ = indices.graphics_family_;
+			}
+
+			// prefer a compute family without graphics, work submitted there can run beside rendering
+			for ( uint32_t family = 0; family < profile.queue_families_.size (); ++family )
+			{
+				VkQueueFlags queue_flags = profile.queue_families_[ family ].queueFlags;
+				if ( ( queue_flags & VK_QUEUE_COMPUTE_BIT ) && !( queue_flags & VK_QUEUE_GRAPHICS_BIT ) )
+				{
+					indices.compute_family_ = family;
+					break;
+				}
+			}
+			if ( !indices.compute_family_ )
+			{
+				indices.compute_family_ = indices.graphics_family_;
+			}
+
 			return indices;
 		}
 
@@ -965,9 +1584,9 @@ namespace vkHelper
 			return details;
 		}
 
-		VkSurfaceFormatKHR vkSwapChainSurfaceFormat ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		VkSurfaceFormatKHR vkSwapChainSurfaceFormat ( SwapChainSupportDetails const& details )
 		{
-			std::vector<VkSurfaceFormatKHR> available_formats = SwapChainSupportDetails_f ( physicalDevice , surface ).formats_;
+			std::vector<VkSurfaceFormatKHR> const& available_formats = details.formats_;
 			// if format specified found 
 			for ( auto const& available_format : available_formats )
 			{
@@ -980,13 +1599,13 @@ namespace vkHelper
 			return available_formats[ 0 ];
 		}
 
-		VkPresentModeKHR vkSwapChainPresentMode ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		VkPresentModeKHR vkSwapChainPresentMode ( SwapChainSupportDetails const& details , VkPresentModeKHR preferred )
 		{
-			std::vector<VkPresentModeKHR> available_present_modes = SwapChainSupportDetails_f ( physicalDevice , surface ).present_modes_;
+			std::vector<VkPresentModeKHR> const& available_present_modes = details.present_modes_;
 			// if present mode specified found 
 			for ( auto const& available_present_mode : available_present_modes )
 			{
-				if ( available_present_mode == VK_PRESENT_MODE_MAILBOX_KHR )
+				if ( available_present_mode == preferred )
 				{
 					return available_present_mode;
 				}
@@ -996,16 +1615,19 @@ namespace vkHelper
 		}
 
 		float aspect_ratio { 0.5625f };
-		VkExtent2D vkSwapChainExtent2D ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		VkExtent2D vkSwapChainExtent2D ( VkSurfaceCapabilitiesKHR const& capabilities )
 		{
-			VkSurfaceCapabilitiesKHR capabilities = SwapChainSupportDetails_f ( physicalDevice , surface ).capabilities_;
 			if ( capabilities.currentExtent.width != UINT32_MAX )
 			{
 				return capabilities.currentExtent;
 			}
 			else
 			{
+#ifdef _WIN32
 				VkExtent2D actual_extent = { static_cast< uint32_t >( wndHelper::g_width ), static_cast< uint32_t >( wndHelper::g_height ) };
+#else
+				VkExtent2D actual_extent = capabilities.minImageExtent;
+#endif
 
 				actual_extent.width = std::clamp ( actual_extent.width , capabilities.minImageExtent.width , capabilities.maxImageExtent.width );
 				actual_extent.height = std::clamp ( actual_extent.height , capabilities.minImageExtent.height , capabilities.maxImageExtent.height );
@@ -1014,6 +1636,58 @@ namespace vkHelper
 			}
 		}
 
+		vkDeviceProfile DeviceProfile ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface )
+		{
+			vkDeviceProfile profile;
+			profile.physical_device_ = physicalDevice;
+			profile.surface_ = surface;
+
+			vkGetPhysicalDeviceProperties ( physicalDevice , &profile.properties_ );
+			vkGetPhysicalDeviceFeatures ( physicalDevice , &profile.features_ );
+			vkGetPhysicalDeviceMemoryProperties ( physicalDevice , &profile.memory_properties_ );
+
+			// get all device queue families
+			uint32_t qfp_count = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties ( physicalDevice , &qfp_count , nullptr );
+			profile.queue_families_.resize ( qfp_count );
+			vkGetPhysicalDeviceQueueFamilyProperties ( physicalDevice , &qfp_count , profile.queue_families_.data () );
+
+			// present support per family, headless frames are read back on the graphics family
+			profile.present_support_.assign ( qfp_count , VK_FALSE );
+			for ( uint32_t i = 0; i < qfp_count; ++i )
+			{
+				if ( surface != VK_NULL_HANDLE )
+				{
+					vkGetPhysicalDeviceSurfaceSupportKHR ( physicalDevice , i , surface , &profile.present_support_[ i ] );
+				}
+				else
+				{
+					profile.present_support_[ i ] = ( profile.queue_families_[ i ].queueFlags & VK_QUEUE_GRAPHICS_BIT ) ? VK_TRUE : VK_FALSE;
+				}
+			}
+
+			uint32_t extension_count { 0 };
+			vkEnumerateDeviceExtensionProperties ( physicalDevice , nullptr , &extension_count , nullptr );
+			profile.extensions_.resize ( extension_count );
+			vkEnumerateDeviceExtensionProperties ( physicalDevice , nullptr , &extension_count , profile.extensions_.data () );
+
+			if ( surface != VK_NULL_HANDLE )
+			{
+				profile.swapchain_support_ = SwapChainSupportDetails_f ( physicalDevice , surface );
+			}
+
+			profile.indices_ = QueueFamilies ( profile );
+			return profile;
+		}
+
+		void RefreshSurfaceCapabilities ( vkDeviceProfile& profile )
+		{
+			if ( profile.surface_ != VK_NULL_HANDLE )
+			{
+				vkGetPhysicalDeviceSurfaceCapabilitiesKHR ( profile.physical_device_ , profile.surface_ , &profile.swapchain_support_.capabilities_ );
+			}
+		}
+
 		std::vector<VkImage> vkSwapChainImages ( VkDevice logicalDevice , VkSwapchainKHR swapChain )
 		{
 			std::vector<VkImage> images;
@@ -1048,7 +1722,7 @@ namespace vkHelper
 
 				if ( vkCreateImageView ( logicalDevice , &createInfo , nullptr , &image_views[ i ] ) != VK_SUCCESS )
 				{
-					std::cerr << "### vkHelper::Get::vkSwapChainImageViews failed! Failed to create image view." << std::endl;
+					VKLOG_FAILURE ( "### vkHelper::Get::vkSwapChainImageViews failed! Failed to create image view." );
 				}
 			}
 
@@ -1061,24 +1735,25 @@ namespace vkHelper
 #define JZVK_ALL_LAYER_MESSAGES
 		VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback ( VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity , VkDebugUtilsMessageTypeFlagsEXT messageType , const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData , void* pUserData )
 		{
-			if ( messageSeverity & VK_DEBUG_REPORT_ERROR_BIT_EXT )
+			// the severities are VK_DEBUG_UTILS_MESSAGE_SEVERITY bits, not the old debug report ones
+			if ( messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT )
 			{
-				std::cerr << "[ERROR]\n"
-					<< "\t[CODE: " << pCallbackData->messageIdNumber << "]\n"
-					<< "\t[MESSAGE: " << pCallbackData->pMessage << "]" << std::endl;
+				VKLOG_FAILURE ( "[ERROR]\n" ,
+					"\t[CODE: " , pCallbackData->messageIdNumber , "]\n" ,
+					"\t[MESSAGE: " , pCallbackData->pMessage , "]" );
 			}
-			else if ( messageSeverity & VK_DEBUG_REPORT_WARNING_BIT_EXT )
+			else if ( messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT )
 			{
-				std::cerr << "[WARNING]\n"
-					<< "\t[CODE: " << pCallbackData->messageIdNumber << "]\n"
-					<< "\t[MESSAGE: " << pCallbackData->pMessage << "]" << std::endl;
+				VKLOG_WARNING ( "[WARNING]\n" ,
+					"\t[CODE: " , pCallbackData->messageIdNumber , "]\n" ,
+					"\t[MESSAGE: " , pCallbackData->pMessage , "]" );
 			}
 			else
 			{
 #ifdef JZVK_ALL_LAYER_MESSAGES
-				std::cerr << "[INFO]\n"
-					<< "\t[CODE: " << pCallbackData->messageIdNumber << "]\n"
-					<< "\t[MESSAGE: " << pCallbackData->pMessage << "]" << std::endl;
+				VKLOG_TRACE ( "[INFO]\n" ,
+					"\t[CODE: " , pCallbackData->messageIdNumber , "]\n" ,
+					"\t[MESSAGE: " , pCallbackData->pMessage , "]" );
 #endif
 			}
 			// should always return false, i.e. not abort function call that triggered this callback
@@ -1125,13 +1800,180 @@ namespace vkHelper
 			}
 			else
 			{
-				std::cerr << "### vkHelper::Debug::DestroyUtilsMessengerEXT failed! vkDestroyDebugUtilsMessengerEXT func not loaded!" << std::endl;
+				VKLOG_FAILURE ( "### vkHelper::Debug::DestroyUtilsMessengerEXT failed! vkDestroyDebugUtilsMessengerEXT func not loaded!" );
 			}
 		}
 	}
 
 	namespace IO
 	{
+		/*!
+		 * @brief header written in front of the driver's pipeline cache blob
+		*/
+		struct PipelineCacheFileHeader
+		{
+			uint32_t	magic_;
+			uint32_t	header_size_;
+			uint32_t	vendor_id_;
+			uint32_t	device_id_;
+			uint32_t	driver_version_;
+			uint8_t		uuid_[ VK_UUID_SIZE ];
+			uint64_t	data_size_;
+			uint64_t	data_hash_;
+		};
+		static constexpr uint32_t PIPELINE_CACHE_MAGIC { 0x43504B56 };	// "VKPC"
+
+		uint64_t Fnv1a ( char const* data , size_t size )
+		{
+			uint64_t hash { 14695981039346656037ull };
+			for ( size_t i = 0; i < size; ++i )
+			{
+				hash ^= static_cast< uint8_t >( data[ i ] );
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		PipelineCacheFileHeader MakePipelineCacheHeader ( vkDeviceProfile const& profile )
+		{
+			VkPhysicalDeviceProperties const& device_properties = profile.properties_;
+
+			PipelineCacheFileHeader header {};
+			header.magic_ = PIPELINE_CACHE_MAGIC;
+			header.header_size_ = sizeof ( PipelineCacheFileHeader );
+			header.vendor_id_ = device_properties.vendorID;
+			header.device_id_ = device_properties.deviceID;
+			header.driver_version_ = device_properties.driverVersion;
+			std::memcpy ( header.uuid_ , device_properties.pipelineCacheUUID , VK_UUID_SIZE );
+			return header;
+		}
+
+		bool LoadPipelineCacheData ( vkDeviceProfile const& profile , std::string const& filename , std::vector<char>& data )
+		{
+			std::vector<char> file;
+			return ReadPipelineCacheFile ( filename , file ) && ParsePipelineCacheData ( profile , filename , file , data );
+		}
+
+		bool ReadPipelineCacheFile ( std::string const& filename , std::vector<char>& file )
+		{
+			vkTrace::Zone zone ( "IO::ReadPipelineCacheFile" );
+
+			std::ifstream stream ( filename , std::ios::ate | std::ios::binary );
+			if ( !stream.is_open () )
+			{
+				VKLOG_INFO ( "### No pipeline cache at " , filename , ", starting empty." );
+				return false;
+			}
+
+			file.resize ( static_cast< size_t >( stream.tellg () ) );
+			stream.seekg ( 0 );
+			stream.read ( file.data () , file.size () );
+			if ( !stream )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::ReadPipelineCacheFile failed! Failed to read " , filename , "." );
+				file.clear ();
+				return false;
+			}
+			return true;
+		}
+
+		bool ParsePipelineCacheData ( vkDeviceProfile const& profile , std::string const& filename , std::vector<char> const& file , std::vector<char>& data )
+		{
+			vkTrace::Zone zone ( "IO::ParsePipelineCacheData" );
+
+			PipelineCacheFileHeader header {};
+			if ( file.size () < sizeof ( header ) )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadPipelineCacheData rejected " , filename , "! File too small." );
+				return false;
+			}
+			std::memcpy ( &header , file.data () , sizeof ( header ) );
+
+			// reject caches written by another device or driver, the driver may not validate them itself
+			PipelineCacheFileHeader expected = MakePipelineCacheHeader ( profile );
+			if ( header.magic_ != expected.magic_ || header.header_size_ != expected.header_size_ )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadPipelineCacheData rejected " , filename , "! Bad header." );
+				return false;
+			}
+			if ( header.vendor_id_ != expected.vendor_id_ || header.device_id_ != expected.device_id_ ||
+				header.driver_version_ != expected.driver_version_ || std::memcmp ( header.uuid_ , expected.uuid_ , VK_UUID_SIZE ) != 0 )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadPipelineCacheData rejected " , filename , "! Written for another device or driver." );
+				return false;
+			}
+			if ( header.data_size_ != file.size () - sizeof ( header ) )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadPipelineCacheData rejected " , filename , "! Truncated data." );
+				return false;
+			}
+
+			char const* cache_data = file.data () + sizeof ( header );
+			if ( Fnv1a ( cache_data , static_cast< size_t >( header.data_size_ ) ) != header.data_hash_ )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadPipelineCacheData rejected " , filename , "! Corrupt data." );
+				return false;
+			}
+
+			data.assign ( cache_data , cache_data + header.data_size_ );
+			return true;
+		}
+
+		bool SavePipelineCache ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkPipelineCache pipelineCache , std::string const& filename )
+		{
+			vkTrace::Zone zone ( "IO::SavePipelineCache" );
+
+			if ( pipelineCache == VK_NULL_HANDLE )
+			{
+				return false;
+			}
+
+			size_t data_size { 0 };
+			if ( vkGetPipelineCacheData ( logicalDevice , pipelineCache , &data_size , nullptr ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::SavePipelineCache failed! Failed to get pipeline cache size." );
+				return false;
+			}
+			std::vector<char> data ( data_size );
+			if ( vkGetPipelineCacheData ( logicalDevice , pipelineCache , &data_size , data.data () ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::SavePipelineCache failed! Failed to get pipeline cache data." );
+				return false;
+			}
+			data.resize ( data_size );
+
+			PipelineCacheFileHeader header = MakePipelineCacheHeader ( profile );
+			header.data_size_ = data.size ();
+			header.data_hash_ = Fnv1a ( data.data () , data.size () );
+
+			// write to a temporary and swap it in so an interrupted write never leaves a half file behind
+			std::string temp_filename = filename + ".tmp";
+			{
+				std::ofstream file ( temp_filename , std::ios::binary | std::ios::trunc );
+				if ( !file.is_open () )
+				{
+					VKLOG_FAILURE ( "### vkHelper::IO::SavePipelineCache failed! Failed to open " , temp_filename );
+					return false;
+				}
+				file.write ( reinterpret_cast< char const* >( &header ) , sizeof ( header ) );
+				file.write ( data.data () , data.size () );
+				if ( !file )
+				{
+					VKLOG_FAILURE ( "### vkHelper::IO::SavePipelineCache failed! Failed to write " , temp_filename );
+					return false;
+				}
+			}
+			std::remove ( filename.c_str () );
+			if ( std::rename ( temp_filename.c_str () , filename.c_str () ) != 0 )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::SavePipelineCache failed! Failed to replace " , filename );
+				return false;
+			}
+
+			VKLOG_INFO ( "### Pipeline cache saved, " , data.size () , " bytes to " , filename );
+			return true;
+		}
+
 		std::vector<char> ReadFile ( std::string const& filename )
 		{
 			std::ifstream file ( filename , std::ios::ate | std::ios::binary );
@@ -1167,125 +2009,1368 @@ namespace vkHelper
 
 			return shaderModule;
 		}
-	}
-
-	namespace Misc
-	{
 
-		void DrawFrame ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice , VkQueue graphicsQueue , VkQueue presentQueue , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
-			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , size_t& currentFrame )
+		bool MapFile ( std::string const& filename , vkMappedFile& file )
 		{
-
-			// wait for frame to be finished before drawing next frame
-			vkWaitForFences ( logicalDevice , 1 , &syncObjects.in_flight_fences_[ currentFrame ] , VK_TRUE , UINT64_MAX );
-
-			uint32_t imageIndex;
-			VkResult result = vkAcquireNextImageKHR ( logicalDevice , swapChain.swapchain_ , UINT64_MAX , syncObjects.available_semaphores_[ currentFrame ] , VK_NULL_HANDLE , &imageIndex );
-			if ( result == VK_ERROR_OUT_OF_DATE_KHR )
+			file = {};
+#ifdef _WIN32
+			file.file_ = CreateFileA ( filename.c_str () , GENERIC_READ , FILE_SHARE_READ , nullptr , OPEN_EXISTING , FILE_ATTRIBUTE_NORMAL , nullptr );
+			if ( file.file_ == INVALID_HANDLE_VALUE )
 			{
-				Misc::RecreateSwapChain ( physicalDevice , surface , logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers );
-				return;
+				return false;
 			}
-			else if ( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR )
+			LARGE_INTEGER size {};
+			if ( !GetFileSizeEx ( file.file_ , &size ) || size.QuadPart == 0 ||
+				( file.mapping_ = CreateFileMappingA ( file.file_ , nullptr , PAGE_READONLY , 0 , 0 , nullptr ) ) == nullptr ||
+				( file.data_ = MapViewOfFile ( file.mapping_ , FILE_MAP_READ , 0 , 0 , 0 ) ) == nullptr )
 			{
-				throw std::runtime_error ( "failed to acquire swap chain image!" );
+				UnmapFile ( file );
+				return false;
 			}
-
-			// check if the previous frame is using this image
-			if ( syncObjects.images_in_flight_[ imageIndex ] != VK_NULL_HANDLE )
+			file.size_ = static_cast< size_t >( size.QuadPart );
+#else
+			file.descriptor_ = open ( filename.c_str () , O_RDONLY );
+			if ( file.descriptor_ < 0 )
 			{
-				vkWaitForFences ( logicalDevice , 1 , &syncObjects.images_in_flight_[ imageIndex ] , VK_TRUE , UINT64_MAX );
+				return false;
 			}
-
-			// mark image as now being used by this frame
-			syncObjects.images_in_flight_[ imageIndex ] = syncObjects.in_flight_fences_[ currentFrame ];
-
-			// queue submission and synchronization
-			VkSubmitInfo submitInfo {};
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-			VkSemaphore waitSemaphore[] = { syncObjects.available_semaphores_[ currentFrame ] };
-			VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-			submitInfo.waitSemaphoreCount = 1;
-			submitInfo.pWaitSemaphores = waitSemaphore;
-			submitInfo.pWaitDstStageMask = waitStages;
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffers[ imageIndex ];
-
-			VkSemaphore signalSemaphores[] = { syncObjects.finished_semaphores_[ currentFrame ] };
-			submitInfo.signalSemaphoreCount = 1;
-			submitInfo.pSignalSemaphores = signalSemaphores;
-
-			vkResetFences ( logicalDevice , 1 , &syncObjects.in_flight_fences_[ currentFrame ] );
-
-			if ( vkQueueSubmit ( graphicsQueue , 1 , &submitInfo , syncObjects.in_flight_fences_[ currentFrame ] ) != VK_SUCCESS )
+			struct stat status {};
+			if ( fstat ( file.descriptor_ , &status ) != 0 || status.st_size == 0 )
 			{
-				throw std::runtime_error ( "failed to submit draw command buffer!" );
+				UnmapFile ( file );
+				return false;
 			}
+			void* data = mmap ( nullptr , static_cast< size_t >( status.st_size ) , PROT_READ , MAP_PRIVATE , file.descriptor_ , 0 );
+			if ( data == MAP_FAILED )
+			{
+				UnmapFile ( file );
+				return false;
+			}
+			file.data_ = data;
+			file.size_ = static_cast< size_t >( status.st_size );
+#endif
+			return true;
+		}
 
-			VkPresentInfoKHR presentInfo {};
-			presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-			presentInfo.waitSemaphoreCount = 1;
-			presentInfo.pWaitSemaphores = signalSemaphores;
-
-			VkSwapchainKHR swapChains[] = { swapChain.swapchain_ };
-			presentInfo.swapchainCount = 1;
-			presentInfo.pSwapchains = swapChains;
-			presentInfo.pImageIndices = &imageIndex;
-
-			presentInfo.pResults = nullptr;
-
-			result = vkQueuePresentKHR ( presentQueue , &presentInfo );
-
-			if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR )
+		void UnmapFile ( vkMappedFile& file )
+		{
+#ifdef _WIN32
+			if ( file.data_ )
 			{
-				Misc::RecreateSwapChain ( physicalDevice , surface , logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers );
+				UnmapViewOfFile ( file.data_ );
 			}
-			else if ( result != VK_SUCCESS )
+			if ( file.mapping_ )
 			{
-				throw std::runtime_error ( "failed to present swap chain image!" );
+				CloseHandle ( file.mapping_ );
 			}
-
-			currentFrame = ( currentFrame + 1 ) % Create::MAX_FRAMES_IN_FLIGHT;
+			if ( file.file_ != INVALID_HANDLE_VALUE )
+			{
+				CloseHandle ( file.file_ );
+			}
+#else
+			if ( file.data_ )
+			{
+				munmap ( const_cast< void* >( file.data_ ) , file.size_ );
+			}
+			if ( file.descriptor_ >= 0 )
+			{
+				close ( file.descriptor_ );
+			}
+#endif
+			file = {};
 		}
 
-		void RecreateSwapChain ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
-			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers )
+		/*!
+		 * @brief maps a SPIR-V file and hashes its contents, 64 bit FNV-1a, reading it pages it in
+		*/
+		static bool MapShaderFile ( std::string const& filename , vkMappedFile& file , uint64_t& hash )
 		{
-			vkDeviceWaitIdle ( logicalDevice );
+			if ( !MapFile ( filename , file ) )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadShaderModule failed! Failed to map " , filename , "." );
+				return false;
+			}
 
-			CleanUpSwapChain ( logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers );
+			// SPIR-V is a stream of words, the mapping is page aligned
+			if ( file.size_ % sizeof ( uint32_t ) != 0 )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadShaderModule failed! " , filename , " is not SPIR-V." );
+				UnmapFile ( file );
+				return false;
+			}
 
-			swapChain = Create::vkSwapChain ( physicalDevice , surface , logicalDevice );
-			renderPass = Create::vkRenderPass ( logicalDevice , swapChain.format_ );
-			graphicsPipeline = Create::vkGraphicsPipeline ( logicalDevice , swapChain , renderPass );
-			std::vector<VkFramebuffer> new_framebuffers;
-			Create::vkFramebuffers ( logicalDevice , swapChain , renderPass , new_framebuffers );
-			framebuffers = new_framebuffers;
-			std::vector<VkCommandBuffer> new_commandbuffers;
-			Create::vkCommandBuffers ( logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , new_commandbuffers );
-			commandBuffers = new_commandbuffers;
+			hash = 14695981039346656037ull;
+			unsigned char const* bytes = static_cast< unsigned char const* >( file.data_ );
+			for ( size_t i = 0; i < file.size_; ++i )
+			{
+				hash = ( hash ^ bytes[ i ] ) * 1099511628211ull;
+			}
+			return true;
 		}
 
-		void CleanUpSwapChain ( VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass renderPass , vkPipelineData& graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers )
+		/*!
+		 * @brief the cached module holding exactly the words of file, VK_NULL_HANDLE when there is none, call locked
+		*/
+		static VkShaderModule FindCachedShader ( vkShaderCacheData& shaderCache , vkMappedFile const& file , uint64_t hash )
 		{
-			for ( size_t i = 0; i < framebuffers.size (); i++ )
+			auto range = shaderCache.by_hash_.equal_range ( hash );
+			for ( auto contents = range.first; contents != range.second; ++contents )
 			{
-				vkDestroyFramebuffer ( logicalDevice , framebuffers[ i ] , nullptr );
+				std::vector<uint32_t> const& code = contents->second.code_;
+				if ( code.size () * sizeof ( uint32_t ) == file.size_ && std::memcmp ( code.data () , file.data_ , file.size_ ) == 0 )
+				{
+					return contents->second.module_;
+				}
 			}
+			return VK_NULL_HANDLE;
+		}
 
-			vkFreeCommandBuffers ( logicalDevice , commandPool , static_cast< uint32_t >( commandBuffers.size () ) , commandBuffers.data () );
-
-			vkDestroyPipeline ( logicalDevice , graphicsPipeline.pipeline_ , nullptr );
-			vkDestroyPipelineLayout ( logicalDevice , graphicsPipeline.layout_ , nullptr );
-			vkDestroyRenderPass ( logicalDevice , renderPass , nullptr );
+		VkShaderModule LoadShaderModule ( VkDevice logicalDevice , vkShaderCacheData& shaderCache , std::string const& filename )
+		{
+			vkTrace::Zone zone ( "IO::LoadShaderModule" );
 
-			for ( size_t i = 0; i < swapChain.image_views_.size (); i++ )
+			vkMappedFile file;
+			uint64_t hash { 0 };
+			bool prefetched_file { false };
 			{
-				vkDestroyImageView ( logicalDevice , swapChain.image_views_[ i ] , nullptr );
+				std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+				auto path = shaderCache.by_path_.find ( filename );
+				if ( path != shaderCache.by_path_.end () )
+				{
+					++shaderCache.path_hits_;
+					return path->second;
+				}
+
+				auto prefetched = shaderCache.prefetched_.find ( filename );
+				if ( prefetched != shaderCache.prefetched_.end () )
+				{
+					++shaderCache.prefetch_hits_;
+					file = prefetched->second.file_;
+					hash = prefetched->second.hash_;
+					shaderCache.prefetched_.erase ( prefetched );
+					prefetched_file = true;
+				}
 			}
 
-			vkDestroySwapchainKHR ( logicalDevice , swapChain.swapchain_ , nullptr );
+			// mapping, hashing and module creation run unlocked, the cache is checked again before inserting
+			if ( !prefetched_file )
+			{
+				if ( !MapShaderFile ( filename , file , hash ) )
+				{
+					return VK_NULL_HANDLE;
+				}
+				std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+				++shaderCache.file_loads_;
+			}
+
+			VkShaderModule shaderModule { VK_NULL_HANDLE };
+			{
+				std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+				shaderModule = FindCachedShader ( shaderCache , file , hash );
+				if ( shaderModule != VK_NULL_HANDLE )
+				{
+					++shaderCache.hash_hits_;
+					UnmapFile ( file );
+					return shaderCache.by_path_.emplace ( filename , shaderModule ).first->second;
+				}
+			}
+
+			VkShaderModuleCreateInfo createInfo {};
+			createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			createInfo.codeSize = file.size_;
+			createInfo.pCode = static_cast< uint32_t const* >( file.data_ );
+
+			if ( vkCreateShaderModule ( logicalDevice , &createInfo , nullptr , &shaderModule ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::IO::LoadShaderModule failed! Failed to create shader module from " , filename , "." );
+				UnmapFile ( file );
+				return VK_NULL_HANDLE;
+			}
+
+			std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+			// another thread may have created the same contents meanwhile, keep the module that is already shared
+			VkShaderModule cached = FindCachedShader ( shaderCache , file , hash );
+			if ( cached != VK_NULL_HANDLE )
+			{
+				vkDestroyShaderModule ( logicalDevice , shaderModule , nullptr );
+				shaderModule = cached;
+			}
+			else
+			{
+				uint32_t const* words = static_cast< uint32_t const* >( file.data_ );
+				vkCachedShader shader;
+				shader.code_.assign ( words , words + file.size_ / sizeof ( uint32_t ) );
+				shader.module_ = shaderModule;
+				shaderCache.by_hash_.emplace ( hash , std::move ( shader ) );
+			}
+			UnmapFile ( file );
+
+			return shaderCache.by_path_.emplace ( filename , shaderModule ).first->second;
+		}
+
+		bool PrefetchShader ( vkShaderCacheData& shaderCache , std::string const& filename )
+		{
+			vkTrace::Zone zone ( "IO::PrefetchShader" );
+
+			{
+				std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+				if ( shaderCache.by_path_.count ( filename ) || shaderCache.prefetched_.count ( filename ) )
+				{
+					return true;
+				}
+			}
+
+			// mapped and hashed outside the lock, that is the slow part
+			vkPrefetchedShader shader;
+			if ( !MapShaderFile ( filename , shader.file_ , shader.hash_ ) )
+			{
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+			++shaderCache.file_loads_;
+			if ( !shaderCache.prefetched_.emplace ( filename , shader ).second )
+			{
+				UnmapFile ( shader.file_ );
+			}
+			return true;
+		}
+	}
+
+	namespace Misc
+	{
+		double ElapsedMs ( std::chrono::steady_clock::time_point start , std::chrono::steady_clock::time_point end )
+		{
+			return std::chrono::duration<double , std::milli> ( end - start ).count ();
+		}
+
+		void PushCpuSample ( vkFrameTimingData& timings , vkFrameTimingData::Sample const& sample )
+		{
+			timings.cpu_samples_[ timings.cpu_count_ % timings.cpu_samples_.size () ] = sample;
+			++timings.cpu_count_;
+		}
+
+		void CollectGpuSample ( VkDevice logicalDevice , vkFrameTimingData& timings , uint32_t imageIndex )
+		{
+			if ( timings.query_pool_ == VK_NULL_HANDLE || imageIndex >= timings.query_pending_.size () || !timings.query_pending_[ imageIndex ] )
+			{
+				return;
+			}
+
+			// the fence of the frame that wrote these queries has signaled, so no need to wait
+			uint64_t timestamps[ 2 ] { 0, 0 };
+			if ( vkGetQueryPoolResults ( logicalDevice , timings.query_pool_ , imageIndex * 2 , 2 , sizeof ( timestamps ) , timestamps , sizeof ( uint64_t ) , VK_QUERY_RESULT_64_BIT ) == VK_SUCCESS )
+			{
+				uint64_t ticks = ( timestamps[ 1 ] - timestamps[ 0 ] ) & timings.timestamp_mask_;
+				timings.gpu_samples_[ timings.gpu_count_ % timings.gpu_samples_.size () ] = static_cast< double >( ticks ) * timings.timestamp_period_ / 1000000.0;
+				++timings.gpu_count_;
+			}
+			timings.query_pending_[ imageIndex ] = false;
+		}
+
+		void CollectLatencySample ( vkFrameTimingData& timings , size_t frame , std::chrono::steady_clock::time_point end )
+		{
+			if ( frame >= timings.slot_start_.size () || timings.slot_start_[ frame ] == std::chrono::steady_clock::time_point {} )
+			{
+				return;
+			}
+			timings.latency_samples_[ timings.latency_count_ % timings.latency_samples_.size () ] = ElapsedMs ( timings.slot_start_[ frame ] , end );
+			++timings.latency_count_;
+			timings.slot_start_[ frame ] = {};
+		}
+
+		void PollLatencySamples ( VkDevice logicalDevice , vkFrameTimingData& timings , vkSyncObjects const& syncObjects )
+		{
+			// no present timing extension, a frame counts as shown once its fence signals, seen at most a frame late
+			auto now = std::chrono::steady_clock::now ();
+			for ( size_t frame = 0; frame < timings.slot_start_.size (); ++frame )
+			{
+				if ( timings.slot_start_[ frame ] != std::chrono::steady_clock::time_point {} && vkGetFenceStatus ( logicalDevice , syncObjects.in_flight_fences_[ frame ] ) == VK_SUCCESS )
+				{
+					CollectLatencySample ( timings , frame , now );
+				}
+			}
+		}
+
+		void CollectComputeSample ( VkDevice logicalDevice , vkAsyncComputeData& asyncCompute , vkFrameTimingData const& timings , size_t frame )
+		{
+			if ( asyncCompute.query_pool_ == VK_NULL_HANDLE || timings.query_pool_ == VK_NULL_HANDLE || !asyncCompute.query_pending_[ frame ] )
+			{
+				return;
+			}
+			asyncCompute.query_pending_[ frame ] = false;
+
+			uint32_t image = asyncCompute.frame_images_[ frame ];
+			if ( image >= vkFrameTimingData::MAX_TIMED_IMAGES )
+			{
+				return;
+			}
+
+			// the frame's fences have signaled, both its compute and its render pass are done
+			uint64_t compute[ 2 ] { 0, 0 };
+			uint64_t graphics[ 2 ] { 0, 0 };
+			if ( vkGetQueryPoolResults ( logicalDevice , asyncCompute.query_pool_ , static_cast< uint32_t >( frame ) * 2 , 2 , sizeof ( compute ) , compute , sizeof ( uint64_t ) , VK_QUERY_RESULT_64_BIT ) != VK_SUCCESS ||
+				vkGetQueryPoolResults ( logicalDevice , timings.query_pool_ , image * 2 , 2 , sizeof ( graphics ) , graphics , sizeof ( uint64_t ) , VK_QUERY_RESULT_64_BIT ) != VK_SUCCESS )
+			{
+				return;
+			}
+
+			// only differences within one queue mean anything, the two queues' counters need not share an origin
+			uint64_t compute_ticks = ( compute[ 1 ] - compute[ 0 ] ) & asyncCompute.timestamp_mask_;
+			uint64_t graphics_ticks = ( graphics[ 1 ] - graphics[ 0 ] ) & timings.timestamp_mask_;
+
+			auto now = std::chrono::steady_clock::now ();
+			if ( asyncCompute.samples_ == 0 )
+			{
+				asyncCompute.first_sample_ = now;
+			}
+			asyncCompute.last_sample_ = now;
+
+			double to_ms = timings.timestamp_period_ / 1000000.0;
+			asyncCompute.compute_ms_ += static_cast< double >( compute_ticks ) * to_ms;
+			asyncCompute.graphics_ms_ += static_cast< double >( graphics_ticks ) * to_ms;
+			++asyncCompute.samples_;
+		}
+
+		bool RecordCommandBuffer ( VkCommandBuffer commandBuffer , vkSwapChainData const& swapChain , VkRenderPass renderPass , vkPipelineData const& graphicsPipeline , VkFramebuffer framebuffer , uint32_t imageIndex ,
+			VkCommandBufferUsageFlags usage , vkFrameTimingData const* timings , uint32_t drawCount , VkCommandBuffer const* secondaryBuffers , uint32_t secondaryCount ,
+			vkDrawData const* draw , vkAsyncComputeData const* asyncCompute , size_t frame )
+		{
+			// begin command buffer
+			VkCommandBufferBeginInfo beginInfo {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = usage;
+			beginInfo.pInheritanceInfo = nullptr;
+
+			if ( vkBeginCommandBuffer ( commandBuffer , &beginInfo ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Misc::RecordCommandBuffer failed! Failed to begin command buffer." );
+				return false;
+			}
+
+			// the compute results are handed over before the render pass reads them
+			if ( asyncCompute && asyncCompute->acquire_ )
+			{
+				asyncCompute->acquire_ ( commandBuffer , frame );
+			}
+
+			// timestamp pair 2i, 2i + 1 brackets the render pass of image i
+			bool timed = timings != nullptr && timings->query_pool_ != VK_NULL_HANDLE && imageIndex < vkFrameTimingData::MAX_TIMED_IMAGES;
+			uint32_t first_query = imageIndex * 2;
+			if ( timed )
+			{
+				vkCmdResetQueryPool ( commandBuffer , timings->query_pool_ , first_query , 2 );
+				vkCmdWriteTimestamp ( commandBuffer , VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT , timings->query_pool_ , first_query );
+			}
+
+			// assign render pass to command buffer and begin render pass
+			VkRenderPassBeginInfo renderPassInfo {};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = renderPass;
+			renderPassInfo.framebuffer = framebuffer;
+			renderPassInfo.renderArea.offset = { 0,0 };
+			renderPassInfo.renderArea.extent = swapChain.extent_;
+
+			VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
+			renderPassInfo.clearValueCount = 1;
+			renderPassInfo.pClearValues = &clearColor;
+
+			// draws either come from secondary buffers recorded on the workers or are recorded inline
+			if ( secondaryBuffers != nullptr && secondaryCount > 0 )
+			{
+				vkCmdBeginRenderPass ( commandBuffer , &renderPassInfo , VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+				vkCmdExecuteCommands ( commandBuffer , secondaryCount , secondaryBuffers );
+			}
+			else
+			{
+				vkCmdBeginRenderPass ( commandBuffer , &renderPassInfo , VK_SUBPASS_CONTENTS_INLINE );
+				RecordDraws ( commandBuffer , swapChain , graphicsPipeline , drawCount , draw );
+				if ( asyncCompute && asyncCompute->draw_ )
+				{
+					asyncCompute->draw_ ( commandBuffer , frame );
+				}
+			}
+
+			// end render pass
+			vkCmdEndRenderPass ( commandBuffer );
+
+			if ( timed )
+			{
+				vkCmdWriteTimestamp ( commandBuffer , VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT , timings->query_pool_ , first_query + 1 );
+			}
+
+			// offscreen, copy the finished image into its readback buffer
+			if ( swapChain.IsOffscreen () )
+			{
+				VkBufferImageCopy region {};
+				region.bufferOffset = 0;
+				region.bufferRowLength = 0;
+				region.bufferImageHeight = 0;
+				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				region.imageSubresource.mipLevel = 0;
+				region.imageSubresource.baseArrayLayer = 0;
+				region.imageSubresource.layerCount = 1;
+				region.imageOffset = { 0, 0, 0 };
+				region.imageExtent = { swapChain.extent_.width, swapChain.extent_.height, 1 };
+
+				vkCmdCopyImageToBuffer ( commandBuffer , swapChain.images_[ imageIndex ] , VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL , swapChain.readback_buffers_[ imageIndex ] , 1 , &region );
+
+				// make the copy visible to the host once the fence signals
+				VkBufferMemoryBarrier barrier {};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = swapChain.readback_buffers_[ imageIndex ];
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+
+				vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_TRANSFER_BIT , VK_PIPELINE_STAGE_HOST_BIT , 0 , 0 , nullptr , 1 , &barrier , 0 , nullptr );
+			}
+
+			// end command buffer
+			if ( vkEndCommandBuffer ( commandBuffer ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Misc::RecordCommandBuffer failed! Failed to end command buffer." );
+				return false;
+			}
+			return true;
+		}
+
+		void RecordDraws ( VkCommandBuffer commandBuffer , vkSwapChainData const& swapChain , vkPipelineData const& graphicsPipeline , uint32_t drawCount , vkDrawData const* draw ,
+			uint32_t firstDraw )
+		{
+			// bind graphics pipeline
+			vkCmdBindPipeline ( commandBuffer , VK_PIPELINE_BIND_POINT_GRAPHICS , graphicsPipeline.pipeline_ );
+
+			// dynamic viewport and scizzor cover the current extent, secondary buffers inherit neither
+			VkViewport viewport {};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = ( float ) swapChain.extent_.width;
+			viewport.height = ( float ) swapChain.extent_.height;
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			vkCmdSetViewport ( commandBuffer , 0 , 1 , &viewport );
+
+			VkRect2D scissor {};
+			scissor.offset = { 0,0 };
+			scissor.extent = swapChain.extent_;
+			vkCmdSetScissor ( commandBuffer , 0 , 1 , &scissor );
+
+			// instanced, the mesh and its instances are bound once and each draw covers every instance
+			if ( draw != nullptr && draw->vertex_buffer_ != VK_NULL_HANDLE )
+			{
+				VkBuffer vertexBuffers[] = { draw->vertex_buffer_ , draw->instance_buffer_ };
+				VkDeviceSize offsets[] = { 0 , 0 };
+				vkCmdBindVertexBuffers ( commandBuffer , 0 , 2 , vertexBuffers , offsets );
+				if ( draw->index_buffer_ != VK_NULL_HANDLE )
+				{
+					vkCmdBindIndexBuffer ( commandBuffer , draw->index_buffer_ , 0 , VK_INDEX_TYPE_UINT16 );
+				}
+
+				for ( uint32_t i = 0; i < drawCount; ++i )
+				{
+					// the set stays bound, only its dynamic offset moves to this draw's constants
+					if ( draw->push_constants_ != nullptr )
+					{
+						PushDrawConstants ( commandBuffer , graphicsPipeline , draw->push_constants_[ firstDraw + i ] );
+					}
+					else if ( draw->uniform_set_ != VK_NULL_HANDLE )
+					{
+						uint32_t dynamic_offset = draw->uniform_offset_ + ( firstDraw + i ) * draw->uniform_stride_;
+						vkCmdBindDescriptorSets ( commandBuffer , VK_PIPELINE_BIND_POINT_GRAPHICS , graphicsPipeline.layout_ , 0 , 1 , &draw->uniform_set_ , 1 , &dynamic_offset );
+					}
+
+					if ( draw->indirect_buffer_ != VK_NULL_HANDLE )
+					{
+						// a split count call draws up to the whole count from its own offset, the producer zeroes the commands past the count then
+						uint32_t per_call = std::max ( draw->max_draws_per_call_ , 1u );
+						for ( uint32_t first = 0; first < draw->max_draw_count_; first += per_call )
+						{
+							uint32_t count = std::min ( draw->max_draw_count_ - first , per_call );
+							VkDeviceSize offset = static_cast< VkDeviceSize >( first ) * sizeof ( VkDrawIndexedIndirectCommand );
+							if ( draw->draw_indirect_count_ != nullptr )
+							{
+								draw->draw_indirect_count_ ( commandBuffer , draw->indirect_buffer_ , offset , draw->count_buffer_ , 0 , count , sizeof ( VkDrawIndexedIndirectCommand ) );
+							}
+							else
+							{
+								// commands past the count were zeroed, they draw no instances
+								vkCmdDrawIndexedIndirect ( commandBuffer , draw->indirect_buffer_ , offset , count , sizeof ( VkDrawIndexedIndirectCommand ) );
+							}
+						}
+					}
+					else if ( draw->index_buffer_ != VK_NULL_HANDLE )
+					{
+						vkCmdDrawIndexed ( commandBuffer , draw->index_count_ , draw->instance_count_ , 0 , 0 , 0 );
+					}
+					else
+					{
+						vkCmdDraw ( commandBuffer , draw->vertex_count_ , draw->instance_count_ , 0 , 0 );
+					}
+				}
+				return;
+			}
+
+			// bind draw command
+			// param
+			// 1. command buffer
+			// 2. vertex count
+			// 3. instance count
+			// 4. first vertex
+			// 5. first instance
+			for ( uint32_t i = 0; i < drawCount; ++i )
+			{
+				vkCmdDraw ( commandBuffer , 3 , 1 , 0 , 0 );
+			}
+		}
+
+		void PushDrawConstants ( VkCommandBuffer commandBuffer , vkPipelineData const& graphicsPipeline , vkDrawConstants const& constants )
+		{
+			assert ( graphicsPipeline.push_constant_size_ >= sizeof ( vkDrawConstants ) );
+			vkCmdPushConstants ( commandBuffer , graphicsPipeline.layout_ , VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT , 0 , sizeof ( vkDrawConstants ) , &constants );
+		}
+
+		void WriteBufferDescriptor ( VkDevice logicalDevice , VkDescriptorSet set , uint32_t binding , VkDescriptorType type , VkBuffer buffer , VkDeviceSize offset , VkDeviceSize range )
+		{
+			VkDescriptorBufferInfo bufferInfo {};
+			bufferInfo.buffer = buffer;
+			bufferInfo.offset = offset;
+			bufferInfo.range = range;
+
+			VkWriteDescriptorSet write {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding;
+			write.dstArrayElement = 0;
+			write.descriptorCount = 1;
+			write.descriptorType = type;
+			write.pBufferInfo = &bufferInfo;
+
+			vkUpdateDescriptorSets ( logicalDevice , 1 , &write , 0 , nullptr );
+		}
+
+		bool RecordSecondaryBuffers ( VkDevice logicalDevice , vkFrameCommandData& frameCommands , size_t frame , vkSwapChainData const& swapChain , VkRenderPass renderPass , vkPipelineData const& graphicsPipeline ,
+			VkFramebuffer framebuffer , vkAsyncComputeData const* asyncCompute )
+		{
+			uint32_t thread_count = frameCommands.thread_count_;
+			std::vector<char> recorded ( thread_count , 0 );
+
+			RunRecordWorkers ( *frameCommands.workers_ , [ & ] ( uint32_t worker )
+			{
+				size_t slot = frame * thread_count + worker;
+				VkCommandBuffer command_buffer = frameCommands.secondary_buffers_[ slot ];
+
+				// the frame's fence was waited on, so the worker's pool for this frame is idle
+				vkResetCommandPool ( logicalDevice , frameCommands.secondary_pools_[ slot ] , 0 );
+
+				VkCommandBufferInheritanceInfo inheritanceInfo {};
+				inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+				inheritanceInfo.renderPass = renderPass;
+				inheritanceInfo.subpass = 0;
+				inheritanceInfo.framebuffer = framebuffer;
+
+				VkCommandBufferBeginInfo beginInfo {};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+				beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+				if ( vkBeginCommandBuffer ( command_buffer , &beginInfo ) != VK_SUCCESS )
+				{
+					return;
+				}
+
+				// even split of the draws, the first workers take the remainder
+				uint32_t share = frameCommands.draw_count_ / thread_count;
+				uint32_t remainder = frameCommands.draw_count_ % thread_count;
+				uint32_t draw_count = share + ( worker < remainder ? 1 : 0 );
+				uint32_t first_draw = worker * share + std::min ( worker , remainder );
+				RecordDraws ( command_buffer , swapChain , graphicsPipeline , draw_count , &frameCommands.draw_ , first_draw );
+
+				// drawn over the frame's draws, as it is when recorded inline
+				if ( worker + 1 == thread_count && asyncCompute && asyncCompute->draw_ )
+				{
+					asyncCompute->draw_ ( command_buffer , frame );
+				}
+
+				recorded[ worker ] = vkEndCommandBuffer ( command_buffer ) == VK_SUCCESS;
+			} );
+
+			if ( std::find ( recorded.begin () , recorded.end () , 0 ) != recorded.end () )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Misc::RecordSecondaryBuffers failed! Failed to record secondary command buffer." );
+				return false;
+			}
+			return true;
+		}
+
+		void RecordWorkerLoop ( vkRecordWorkers* workers , uint32_t index )
+		{
+			vkTrace::NameThread ( "record worker" );
+			uint64_t seen_generation { 0 };
+			for ( ;; )
+			{
+				{
+					std::unique_lock<std::mutex> lock ( workers->mutex_ );
+					workers->start_cv_.wait ( lock , [ & ] { return workers->quit_ || workers->generation_ != seen_generation; } );
+					if ( workers->quit_ )
+					{
+						return;
+					}
+					seen_generation = workers->generation_;
+				}
+
+				// job_ is only replaced once every worker reported done
+				{
+					vkTrace::Zone zone ( "RecordWorkers::job" );
+					workers->job_ ( index );
+				}
+
+				std::lock_guard<std::mutex> lock ( workers->mutex_ );
+				if ( --workers->pending_ == 0 )
+				{
+					workers->done_cv_.notify_one ();
+				}
+			}
+		}
+
+		void RunRecordWorkers ( vkRecordWorkers& workers , std::function<void ( uint32_t )> const& job )
+		{
+			{
+				std::lock_guard<std::mutex> lock ( workers.mutex_ );
+				workers.job_ = job;
+				workers.pending_ = static_cast< uint32_t >( workers.threads_.size () );
+				++workers.generation_;
+			}
+			workers.start_cv_.notify_all ();
+
+			std::unique_lock<std::mutex> lock ( workers.mutex_ );
+			workers.done_cv_.wait ( lock , [ & ] { return workers.pending_ == 0; } );
+		}
+
+		void DestroyRecordWorkers ( vkRecordWorkers& workers )
+		{
+			{
+				std::lock_guard<std::mutex> lock ( workers.mutex_ );
+				workers.quit_ = true;
+			}
+			workers.start_cv_.notify_all ();
+			for ( auto& thread : workers.threads_ )
+			{
+				thread.join ();
+			}
+			workers.threads_.clear ();
+		}
+
+		void DrawFrame ( vkDeviceProfile& profile , VkDevice logicalDevice , VkQueue graphicsQueue , VkQueue presentQueue , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , size_t& currentFrame , vkFrameTimingData* timings ,
+			vkFrameCommandData* frameCommands , vkAsyncComputeData* asyncCompute , vkRenderPassChanged const* renderPassChanged )
+		{
+			vkTrace::Zone frame_zone ( "Misc::DrawFrame" );
+			vkTrace::Zone phase ( "DrawFrame::wait" );
+
+			vkFrameTimingData::Sample sample;
+			auto frame_start = std::chrono::steady_clock::now ();
+			if ( timings && timings->last_frame_start_ != std::chrono::steady_clock::time_point {} )
+			{
+				sample.frame_ms_ = ElapsedMs ( timings->last_frame_start_ , frame_start );
+			}
+
+			// wait for frame to be finished before drawing next frame
+			vkWaitForFences ( logicalDevice , 1 , &syncObjects.in_flight_fences_[ currentFrame ] , VK_TRUE , UINT64_MAX );
+			auto wait_end = std::chrono::steady_clock::now ();
+
+			// the slot's previous frame finished by the time the wait returned
+			if ( timings )
+			{
+				if ( timings->slot_start_.size () != syncObjects.in_flight_fences_.size () )
+				{
+					timings->slot_start_.assign ( syncObjects.in_flight_fences_.size () , {} );
+				}
+				CollectLatencySample ( *timings , currentFrame , wait_end );
+			}
+
+			// this slot's previous work is done, retired swap chains it used can go
+			if ( !syncObjects.retired_swapchains_.empty () )
+			{
+				ReleaseRetiredSwapChains ( logicalDevice , commandPool , syncObjects , currentFrame );
+			}
+
+			// graphics need not have waited on the slot's compute, its own fence says when it is done
+			if ( asyncCompute )
+			{
+				vkWaitForFences ( logicalDevice , 1 , &asyncCompute->fences_[ currentFrame ] , VK_TRUE , UINT64_MAX );
+				if ( timings )
+				{
+					CollectComputeSample ( logicalDevice , *asyncCompute , *timings , currentFrame );
+				}
+			}
+
+			// offscreen images are handed out round robin, no presentation engine to acquire from
+			phase.Next ( "DrawFrame::acquire" );
+			bool offscreen = swapChain.IsOffscreen ();
+
+			uint32_t imageIndex;
+			VkResult result { VK_SUCCESS };
+			if ( offscreen )
+			{
+				imageIndex = swapChain.next_image_;
+				swapChain.next_image_ = ( swapChain.next_image_ + 1 ) % static_cast< uint32_t >( swapChain.images_.size () );
+			}
+			else
+			{
+				result = vkAcquireNextImageKHR ( logicalDevice , swapChain.swapchain_ , UINT64_MAX , syncObjects.available_semaphores_[ currentFrame ] , VK_NULL_HANDLE , &imageIndex );
+			}
+			auto acquire_end = std::chrono::steady_clock::now ();
+			if ( result == VK_ERROR_OUT_OF_DATE_KHR )
+			{
+				Misc::RecreateSwapChain ( profile , logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers , syncObjects , timings , renderPassChanged );
+				return;
+			}
+			else if ( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR )
+			{
+				throw std::runtime_error ( "failed to acquire swap chain image!" );
+			}
+
+			// check if the previous frame is using this image
+			phase.Next ( "DrawFrame::image wait" );
+			if ( syncObjects.images_in_flight_[ imageIndex ] != VK_NULL_HANDLE )
+			{
+				vkWaitForFences ( logicalDevice , 1 , &syncObjects.images_in_flight_[ imageIndex ] , VK_TRUE , UINT64_MAX );
+			}
+			auto image_wait_end = std::chrono::steady_clock::now ();
+			phase.Next ( "DrawFrame::record" );
+
+			// previous use of this image is done, its timestamps are ready
+			if ( timings )
+			{
+				CollectGpuSample ( logicalDevice , *timings , imageIndex );
+			}
+
+			// mark image as now being used by this frame
+			syncObjects.images_in_flight_[ imageIndex ] = syncObjects.in_flight_fences_[ currentFrame ];
+
+			// this slot's fence was waited on above, nothing recorded from its pool is still executing
+			VkCommandBuffer command_buffer = commandBuffers.empty () ? VK_NULL_HANDLE : commandBuffers[ imageIndex ];
+			if ( frameCommands )
+			{
+				command_buffer = frameCommands->buffers_[ currentFrame ];
+				vkResetCommandPool ( logicalDevice , frameCommands->pools_[ currentFrame ] , 0 );
+
+				// the frame's host visible data is no longer read either, it can be rewritten
+				if ( frameCommands->update_ && !frameCommands->update_ ( currentFrame , frameCommands->draw_ ) )
+				{
+					throw std::runtime_error ( "failed to update frame data!" );
+				}
+
+				// pre pass first, it may retarget the draws recorded below
+				if ( frameCommands->pre_pass_ )
+				{
+					VkCommandBufferBeginInfo beginInfo {};
+					beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+					beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+					VkCommandBuffer pre_buffer = frameCommands->pre_buffers_[ currentFrame ];
+					if ( vkBeginCommandBuffer ( pre_buffer , &beginInfo ) != VK_SUCCESS ||
+						!frameCommands->pre_pass_ ( pre_buffer , currentFrame , frameCommands->draw_ ) ||
+						vkEndCommandBuffer ( pre_buffer ) != VK_SUCCESS )
+					{
+						throw std::runtime_error ( "failed to record pre pass command buffer!" );
+					}
+				}
+
+				uint32_t thread_count = frameCommands->thread_count_;
+				VkCommandBuffer const* secondary_buffers = nullptr;
+				if ( thread_count > 0 )
+				{
+					if ( !RecordSecondaryBuffers ( logicalDevice , *frameCommands , currentFrame , swapChain , renderPass , graphicsPipeline , framebuffers[ imageIndex ] , asyncCompute ) )
+					{
+						throw std::runtime_error ( "failed to record secondary command buffers!" );
+					}
+					secondary_buffers = &frameCommands->secondary_buffers_[ currentFrame * thread_count ];
+				}
+
+				if ( !RecordCommandBuffer ( command_buffer , swapChain , renderPass , graphicsPipeline , framebuffers[ imageIndex ] , imageIndex , VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT , timings ,
+					frameCommands->draw_count_ , secondary_buffers , thread_count , &frameCommands->draw_ , asyncCompute , currentFrame ) )
+				{
+					throw std::runtime_error ( "failed to record frame command buffer!" );
+				}
+			}
+
+			// compute work of the frame, on the compute queue
+			if ( asyncCompute )
+			{
+				VkCommandBuffer compute_buffer = asyncCompute->buffers_[ currentFrame ];
+				vkResetCommandPool ( logicalDevice , asyncCompute->pools_[ currentFrame ] , 0 );
+
+				VkCommandBufferBeginInfo beginInfo {};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+				bool timed = asyncCompute->query_pool_ != VK_NULL_HANDLE;
+				uint32_t first_query = static_cast< uint32_t >( currentFrame ) * 2;
+				if ( vkBeginCommandBuffer ( compute_buffer , &beginInfo ) != VK_SUCCESS )
+				{
+					throw std::runtime_error ( "failed to begin compute command buffer!" );
+				}
+				if ( timed )
+				{
+					vkCmdResetQueryPool ( compute_buffer , asyncCompute->query_pool_ , first_query , 2 );
+					vkCmdWriteTimestamp ( compute_buffer , VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT , asyncCompute->query_pool_ , first_query );
+				}
+				if ( !asyncCompute->record_ ( compute_buffer , currentFrame ) )
+				{
+					throw std::runtime_error ( "failed to record compute command buffer!" );
+				}
+				if ( timed )
+				{
+					vkCmdWriteTimestamp ( compute_buffer , VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT , asyncCompute->query_pool_ , first_query + 1 );
+				}
+				if ( vkEndCommandBuffer ( compute_buffer ) != VK_SUCCESS )
+				{
+					throw std::runtime_error ( "failed to end compute command buffer!" );
+				}
+				asyncCompute->query_pending_[ currentFrame ] = timed;
+				asyncCompute->frame_images_[ currentFrame ] = imageIndex;
+			}
+			auto record_end = std::chrono::steady_clock::now ();
+			phase.Next ( "DrawFrame::submit" );
+
+			// the compute is submitted first, its semaphore has to be signaled before graphics waits on it
+			if ( asyncCompute )
+			{
+				VkSubmitInfo computeInfo {};
+				computeInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				computeInfo.commandBufferCount = 1;
+				computeInfo.pCommandBuffers = &asyncCompute->buffers_[ currentFrame ];
+				// a signaled semaphore nobody waits on could not be signaled again
+				computeInfo.signalSemaphoreCount = asyncCompute->wait_stage_ ? 1 : 0;
+				computeInfo.pSignalSemaphores = &asyncCompute->finished_semaphores_[ currentFrame ];
+
+				vkResetFences ( logicalDevice , 1 , &asyncCompute->fences_[ currentFrame ] );
+				if ( vkQueueSubmit ( asyncCompute->queue_ , 1 , &computeInfo , asyncCompute->fences_[ currentFrame ] ) != VK_SUCCESS )
+				{
+					throw std::runtime_error ( "failed to submit compute command buffer!" );
+				}
+			}
+
+			// queue submission and synchronization
+			VkSubmitInfo submitInfo {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+			VkSemaphore waitSemaphore[ 2 ] {};
+			VkPipelineStageFlags waitStages[ 2 ] {};
+			uint32_t wait_count { 0 };
+			if ( !offscreen )
+			{
+				waitSemaphore[ wait_count ] = syncObjects.available_semaphores_[ currentFrame ];
+				waitStages[ wait_count++ ] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			}
+			if ( asyncCompute && asyncCompute->wait_stage_ )
+			{
+				waitSemaphore[ wait_count ] = asyncCompute->finished_semaphores_[ currentFrame ];
+				waitStages[ wait_count++ ] = asyncCompute->wait_stage_;
+			}
+			submitInfo.waitSemaphoreCount = wait_count;
+			submitInfo.pWaitSemaphores = waitSemaphore;
+			submitInfo.pWaitDstStageMask = waitStages;
+			// the pre pass is submitted in the same batch, its barriers order it before the render pass
+			VkCommandBuffer submitBuffers[] = { VK_NULL_HANDLE , command_buffer };
+			bool pre_pass = frameCommands != nullptr && frameCommands->pre_pass_;
+			if ( pre_pass )
+			{
+				submitBuffers[ 0 ] = frameCommands->pre_buffers_[ currentFrame ];
+			}
+			submitInfo.commandBufferCount = pre_pass ? 2 : 1;
+			submitInfo.pCommandBuffers = pre_pass ? submitBuffers : &submitBuffers[ 1 ];
+
+			VkSemaphore signalSemaphores[] = { syncObjects.finished_semaphores_[ currentFrame ] };
+			submitInfo.signalSemaphoreCount = offscreen ? 0 : 1;
+			submitInfo.pSignalSemaphores = signalSemaphores;
+
+			vkResetFences ( logicalDevice , 1 , &syncObjects.in_flight_fences_[ currentFrame ] );
+
+			if ( vkQueueSubmit ( graphicsQueue , 1 , &submitInfo , syncObjects.in_flight_fences_[ currentFrame ] ) != VK_SUCCESS )
+			{
+				throw std::runtime_error ( "failed to submit draw command buffer!" );
+			}
+			auto submit_end = std::chrono::steady_clock::now ();
+			phase.End ();
+
+			if ( timings )
+			{
+				if ( imageIndex < timings->query_pending_.size () )
+				{
+					timings->query_pending_[ imageIndex ] = timings->query_pool_ != VK_NULL_HANDLE;
+				}
+				sample.wait_ms_ = ElapsedMs ( frame_start , wait_end ) + ElapsedMs ( acquire_end , image_wait_end );
+				sample.acquire_ms_ = ElapsedMs ( wait_end , acquire_end );
+				sample.record_ms_ = ElapsedMs ( image_wait_end , record_end );
+				sample.submit_ms_ = ElapsedMs ( record_end , submit_end );
+				timings->last_frame_start_ = frame_start;
+				timings->slot_start_[ currentFrame ] = wait_end;
+			}
+
+			// offscreen, the frame is read back once its fence signals instead of being presented
+			if ( offscreen )
+			{
+				if ( timings )
+				{
+					PushCpuSample ( *timings , sample );
+					PollLatencySamples ( logicalDevice , *timings , syncObjects );
+				}
+				swapChain.last_image_ = imageIndex;
+				currentFrame = ( currentFrame + 1 ) % syncObjects.in_flight_fences_.size ();
+				return;
+			}
+
+			VkPresentInfoKHR presentInfo {};
+			presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			presentInfo.waitSemaphoreCount = 1;
+			presentInfo.pWaitSemaphores = signalSemaphores;
+
+			VkSwapchainKHR swapChains[] = { swapChain.swapchain_ };
+			presentInfo.swapchainCount = 1;
+			presentInfo.pSwapchains = swapChains;
+			presentInfo.pImageIndices = &imageIndex;
+
+			presentInfo.pResults = nullptr;
+
+			phase.Next ( "DrawFrame::present" );
+			result = vkQueuePresentKHR ( presentQueue , &presentInfo );
+			phase.End ();
+
+			if ( timings )
+			{
+				sample.present_ms_ = ElapsedMs ( submit_end , std::chrono::steady_clock::now () );
+				PushCpuSample ( *timings , sample );
+				PollLatencySamples ( logicalDevice , *timings , syncObjects );
+			}
+
+			if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR )
+			{
+				Misc::RecreateSwapChain ( profile , logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers , syncObjects , timings , renderPassChanged );
+			}
+			else if ( result != VK_SUCCESS )
+			{
+				throw std::runtime_error ( "failed to present swap chain image!" );
+			}
+
+			currentFrame = ( currentFrame + 1 ) % syncObjects.in_flight_fences_.size ();
+		}
+
+		void RebuildSwapChainResources ( VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , vkFrameTimingData* timings , bool prerecorded )
+		{
+			vkTrace::Zone zone ( "Misc::RebuildSwapChainResources" );
+
+			// the fence of the frame that last drew old image i is kept for new image i, that frame may still be writing
+			// timestamp queries 2i and 2i + 1, which the new image's command buffer resets, waiting on it orders the two
+			syncObjects.images_in_flight_.resize ( swapChain.images_.size () , VK_NULL_HANDLE );
+
+			std::vector<VkFramebuffer> new_framebuffers;
+			Create::vkFramebuffers ( logicalDevice , swapChain , renderPass , new_framebuffers );
+			framebuffers = new_framebuffers;
+			// frames recorded per frame in DrawFrame have nothing to prerecord
+			if ( prerecorded )
+			{
+				std::vector<VkCommandBuffer> new_commandbuffers;
+				Create::vkCommandBuffers ( logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , new_commandbuffers , timings );
+				commandBuffers = new_commandbuffers;
+			}
+
+			// pending queries of the old command buffers are dropped
+			if ( timings )
+			{
+				timings->query_pending_.assign ( vkFrameTimingData::MAX_TIMED_IMAGES , false );
+			}
+		}
+
+		void RecreateSwapChain ( vkDeviceProfile& profile , VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , vkFrameTimingData* timings ,
+			vkRenderPassChanged const* renderPassChanged )
+		{
+			vkTrace::Zone zone ( "Misc::RecreateSwapChain" );
+
+			VkFormat old_format = swapChain.format_;
+			bool prerecorded = !commandBuffers.empty ();
+
+			// the old swap chain is retired by the create call whether it succeeds or not,
+			// frames already in flight keep using it until their fences signal
+			vkSwapChainData new_swapchain = Create::vkSwapChain ( profile , logicalDevice , swapChain.swapchain_ , swapChain.present_mode_ );
+			RetireSwapChain ( syncObjects , swapChain , framebuffers , commandBuffers );
+			swapChain = new_swapchain;
+
+			// viewport and scizzor are dynamic, the render pass and pipeline only depend on the format,
+			// a format change is rare enough to drain the device for
+			if ( swapChain.format_ != old_format )
+			{
+				vkDeviceWaitIdle ( logicalDevice );
+				VkRenderPass old_render_pass = renderPass;
+				renderPass = Create::vkRenderPass ( logicalDevice , swapChain.format_ );
+				RebuildPipeline ( logicalDevice , renderPass , graphicsPipeline );
+
+				// the old render pass outlives the call, pipeline compiles still running may be using it
+				if ( renderPassChanged && *renderPassChanged )
+				{
+					( *renderPassChanged ) ( renderPass , graphicsPipeline );
+				}
+				vkDestroyRenderPass ( logicalDevice , old_render_pass , nullptr );
+			}
+
+			RebuildSwapChainResources ( logicalDevice , swapChain , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers , syncObjects , timings , prerecorded );
+		}
+
+		void RebuildPipeline ( VkDevice logicalDevice , VkRenderPass renderPass , vkPipelineData& pipeline )
+		{
+			vkPipelineData rebuilt = Create::vkGraphicsPipeline ( logicalDevice , renderPass , pipeline.cache_ , pipeline.instanced_ , pipeline.set_layouts_ ,
+				pipeline.push_constant_size_ , pipeline.shaders_ , pipeline.state_ );
+			DestroyPipeline ( logicalDevice , pipeline );
+			pipeline = rebuilt;
+		}
+
+		void ResizeOffscreenTarget ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkExtent2D extent , vkSwapChainData& offscreen , VkRenderPass renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , vkFrameTimingData* timings )
+		{
+			vkTrace::Zone zone ( "Misc::ResizeOffscreenTarget" );
+
+			vkSwapChainData new_target = Create::vkOffscreenTarget ( profile , logicalDevice , extent , offscreen.format_ , static_cast< uint32_t >( offscreen.images_.size () ) );
+			if ( !new_target.IsOffscreen () )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Misc::ResizeOffscreenTarget failed! Keeping the old target." );
+				return;
+			}
+			bool prerecorded = !commandBuffers.empty ();
+			RetireSwapChain ( syncObjects , offscreen , framebuffers , commandBuffers );
+			offscreen = new_target;
+
+			RebuildSwapChainResources ( logicalDevice , offscreen , renderPass , graphicsPipeline , framebuffers , commandPool , commandBuffers , syncObjects , timings , prerecorded );
+		}
+
+		void RetireSwapChain ( vkSyncObjects& syncObjects , vkSwapChainData& swapChain , std::vector<VkFramebuffer>& framebuffers , std::vector<VkCommandBuffer>& commandBuffers )
+		{
+			vkRetiredSwapChainData retired;
+			retired.swapchain_ = std::move ( swapChain );
+			retired.framebuffers_ = std::move ( framebuffers );
+			retired.command_buffers_ = std::move ( commandBuffers );
+			retired.pending_frames_.assign ( syncObjects.in_flight_fences_.size () , true );
+			syncObjects.retired_swapchains_.push_back ( std::move ( retired ) );
+
+			swapChain = vkSwapChainData {};
+			framebuffers.clear ();
+			commandBuffers.clear ();
+		}
+
+		void ReleaseRetiredSwapChains ( VkDevice logicalDevice , VkCommandPool commandPool , vkSyncObjects& syncObjects , size_t completedFrame , bool deviceIdle )
+		{
+			auto& retired_swapchains = syncObjects.retired_swapchains_;
+			for ( auto it = retired_swapchains.begin (); it != retired_swapchains.end (); )
+			{
+				if ( completedFrame < it->pending_frames_.size () )
+				{
+					it->pending_frames_[ completedFrame ] = false;
+				}
+
+				bool in_use = !deviceIdle && std::find ( it->pending_frames_.begin () , it->pending_frames_.end () , true ) != it->pending_frames_.end ();
+				if ( in_use )
+				{
+					++it;
+					continue;
+				}
+
+				CleanUpSwapChain ( logicalDevice , it->swapchain_ , it->framebuffers_ , commandPool , it->command_buffers_ );
+				it = retired_swapchains.erase ( it );
+			}
+		}
+
+		void CleanUpSwapChain ( VkDevice logicalDevice , vkSwapChainData& swapChain , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers )
+		{
+			for ( size_t i = 0; i < framebuffers.size (); i++ )
+			{
+				vkDestroyFramebuffer ( logicalDevice , framebuffers[ i ] , nullptr );
+			}
+
+			if ( !commandBuffers.empty () )
+			{
+				vkFreeCommandBuffers ( logicalDevice , commandPool , static_cast< uint32_t >( commandBuffers.size () ) , commandBuffers.data () );
+			}
+
+			if ( swapChain.IsOffscreen () )
+			{
+				DestroyOffscreenTarget ( logicalDevice , swapChain );
+				return;
+			}
+
+			for ( size_t i = 0; i < swapChain.image_views_.size (); i++ )
+			{
+				vkDestroyImageView ( logicalDevice , swapChain.image_views_[ i ] , nullptr );
+			}
+
+			vkDestroySwapchainKHR ( logicalDevice , swapChain.swapchain_ , nullptr );
+		}
+
+		void ReportShaderCache ( vkShaderCacheData& shaderCache , std::ostream& out )
+		{
+			std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+			out << "### Shader cache: " << shaderCache.by_hash_.size () << " modules from " << shaderCache.file_loads_ << " file loads ("
+				<< shaderCache.prefetch_hits_ << " prefetched), " << shaderCache.path_hits_ << " path hits, " << shaderCache.hash_hits_ << " content hits." << std::endl;
+		}
+
+		void DestroyShaderCache ( VkDevice logicalDevice , vkShaderCacheData& shaderCache )
+		{
+			std::lock_guard<std::mutex> lock ( shaderCache.mutex_ );
+			for ( auto& shader : shaderCache.by_hash_ )
+			{
+				vkDestroyShaderModule ( logicalDevice , shader.second.module_ , nullptr );
+			}
+			shaderCache.by_hash_.clear ();
+			shaderCache.by_path_.clear ();
+
+			// prefetched but never loaded
+			for ( auto& shader : shaderCache.prefetched_ )
+			{
+				IO::UnmapFile ( shader.second.file_ );
+			}
+			shaderCache.prefetched_.clear ();
+		}
+
+		void DestroyPipeline ( VkDevice logicalDevice , vkPipelineData& pipeline )
+		{
+			vkDestroyPipeline ( logicalDevice , pipeline.pipeline_ , nullptr );
+			vkDestroyPipelineLayout ( logicalDevice , pipeline.layout_ , nullptr );
+			pipeline.pipeline_ = VK_NULL_HANDLE;
+			pipeline.layout_ = VK_NULL_HANDLE;
+		}
+
+		void DestroyOffscreenTarget ( VkDevice logicalDevice , vkSwapChainData& offscreen )
+		{
+			for ( size_t i = 0; i < offscreen.image_views_.size (); i++ )
+			{
+				vkDestroyImageView ( logicalDevice , offscreen.image_views_[ i ] , nullptr );
+			}
+
+			for ( size_t i = 0; i < offscreen.images_.size (); i++ )
+			{
+				if ( offscreen.readback_mapped_[ i ] != nullptr )
+				{
+					vkUnmapMemory ( logicalDevice , offscreen.readback_memory_[ i ] );
+				}
+				vkDestroyBuffer ( logicalDevice , offscreen.readback_buffers_[ i ] , nullptr );
+				vkFreeMemory ( logicalDevice , offscreen.readback_memory_[ i ] , nullptr );
+				vkDestroyImage ( logicalDevice , offscreen.images_[ i ] , nullptr );
+				vkFreeMemory ( logicalDevice , offscreen.image_memory_[ i ] , nullptr );
+			}
+
+			offscreen.image_views_.clear ();
+			offscreen.images_.clear ();
+			offscreen.image_memory_.clear ();
+			offscreen.readback_buffers_.clear ();
+			offscreen.readback_memory_.clear ();
+			offscreen.readback_mapped_.clear ();
+		}
+
+		bool ReadbackImage ( VkDevice logicalDevice , vkSwapChainData const& offscreen , vkSyncObjects const& syncObjects , uint32_t imageIndex , std::vector<char>& pixels )
+		{
+			if ( !offscreen.IsOffscreen () || imageIndex >= offscreen.images_.size () )
+			{
+				VKLOG_FAILURE ( "### vkHelper::Misc::ReadbackImage failed! Not an offscreen image." );
+				return false;
+			}
+
+			// wait for the frame that last rendered into this image
+			if ( syncObjects.images_in_flight_[ imageIndex ] != VK_NULL_HANDLE )
+			{
+				vkWaitForFences ( logicalDevice , 1 , &syncObjects.images_in_flight_[ imageIndex ] , VK_TRUE , UINT64_MAX );
+			}
+
+			size_t readback_size = static_cast< size_t >( offscreen.extent_.width ) * offscreen.extent_.height * 4;
+			pixels.resize ( readback_size );
+			std::memcpy ( pixels.data () , offscreen.readback_mapped_[ imageIndex ] , readback_size );
+
+			return true;
+		}
+
+		double Percentile ( std::vector<double> const& sorted , double p )
+		{
+			if ( sorted.empty () )
+			{
+				return 0.0;
+			}
+			size_t rank = static_cast< size_t >( p * static_cast< double >( sorted.size () - 1 ) + 0.5 );
+			return sorted[ std::min ( rank , sorted.size () - 1 ) ];
+		}
+
+		void ReportSeries ( std::ostream& out , char const* name , std::vector<double>& values )
+		{
+			std::sort ( values.begin () , values.end () );
+			out << "\t- " << name
+				<< "\tp50 " << Percentile ( values , 0.50 ) << " ms"
+				<< "\tp95 " << Percentile ( values , 0.95 ) << " ms"
+				<< "\tp99 " << Percentile ( values , 0.99 ) << " ms\n";
+		}
+
+		void ReportFrameTimings ( vkFrameTimingData const& timings , std::ostream& out )
+		{
+			size_t cpu_count = std::min ( timings.cpu_count_ , timings.cpu_samples_.size () );
+			size_t gpu_count = std::min ( timings.gpu_count_ , timings.gpu_samples_.size () );
+
+			// the first sample has no previous frame to measure against
+			std::vector<double> frame , wait , acquire , record , submit , present;
+			for ( size_t i = 0; i < cpu_count; ++i )
+			{
+				vkFrameTimingData::Sample const& sample = timings.cpu_samples_[ i ];
+				if ( sample.frame_ms_ > 0.0 )
+				{
+					frame.push_back ( sample.frame_ms_ );
+				}
+				wait.push_back ( sample.wait_ms_ );
+				acquire.push_back ( sample.acquire_ms_ );
+				record.push_back ( sample.record_ms_ );
+				submit.push_back ( sample.submit_ms_ );
+				present.push_back ( sample.present_ms_ );
+			}
+			std::vector<double> gpu ( timings.gpu_samples_.begin () , timings.gpu_samples_.begin () + gpu_count );
+			size_t latency_count = std::min ( timings.latency_count_ , timings.latency_samples_.size () );
+			std::vector<double> latency ( timings.latency_samples_.begin () , timings.latency_samples_.begin () + latency_count );
+
+			out << "### Frame timings (" << cpu_count << " cpu samples, " << gpu_count << " gpu samples):\n";
+			ReportSeries ( out , "frame  " , frame );
+			ReportSeries ( out , "wait   " , wait );
+			ReportSeries ( out , "acquire" , acquire );
+			ReportSeries ( out , "record " , record );
+			ReportSeries ( out , "submit " , submit );
+			ReportSeries ( out , "present" , present );
+			ReportSeries ( out , "gpu    " , gpu );
+			ReportSeries ( out , "latency" , latency );
+			out.flush ();
+		}
+
+		double CpuPercentile ( vkFrameTimingData const& timings , double vkFrameTimingData::Sample::* phase , double p )
+		{
+			size_t cpu_count = std::min ( timings.cpu_count_ , timings.cpu_samples_.size () );
+			std::vector<double> values;
+			values.reserve ( cpu_count );
+			for ( size_t i = 0; i < cpu_count; ++i )
+			{
+				values.push_back ( timings.cpu_samples_[ i ].*phase );
+			}
+			std::sort ( values.begin () , values.end () );
+			return Percentile ( values , p );
+		}
+
+		double GpuPercentile ( vkFrameTimingData const& timings , double p )
+		{
+			size_t gpu_count = std::min ( timings.gpu_count_ , timings.gpu_samples_.size () );
+			std::vector<double> values ( timings.gpu_samples_.begin () , timings.gpu_samples_.begin () + gpu_count );
+			std::sort ( values.begin () , values.end () );
+			return Percentile ( values , p );
+		}
+
+		double LatencyPercentile ( vkFrameTimingData const& timings , double p )
+		{
+			size_t latency_count = std::min ( timings.latency_count_ , timings.latency_samples_.size () );
+			std::vector<double> values ( timings.latency_samples_.begin () , timings.latency_samples_.begin () + latency_count );
+			std::sort ( values.begin () , values.end () );
+			return Percentile ( values , p );
+		}
+
+		void ResetFrameTimings ( vkFrameTimingData& timings )
+		{
+			timings.cpu_count_ = 0;
+			timings.gpu_count_ = 0;
+			timings.latency_count_ = 0;
+			// frames still in flight started before the reset
+			timings.slot_start_.clear ();
+			timings.last_frame_start_ = {};
+		}
+
+		void ReportComputeOverlap ( vkAsyncComputeData const& asyncCompute , std::ostream& out )
+		{
+			if ( asyncCompute.samples_ < 2 )
+			{
+				out << "### Async compute: not enough timed frames." << std::endl;
+				return;
+			}
+
+			// wall time between the first and the last sample covers one frame less than was sampled
+			double frames = static_cast< double >( asyncCompute.samples_ );
+			double compute_ms = asyncCompute.compute_ms_ / frames;
+			double graphics_ms = asyncCompute.graphics_ms_ / frames;
+			double wall_ms = ElapsedMs ( asyncCompute.first_sample_ , asyncCompute.last_sample_ ) / ( frames - 1.0 );
+			double concurrent_ms = std::max ( compute_ms + graphics_ms - wall_ms , 0.0 );
+			out << "### Async compute (" << asyncCompute.samples_ << " frames):\n"
+				<< "\t- compute mean " << compute_ms << " ms\n"
+				<< "\t- render mean  " << graphics_ms << " ms\n"
+				<< "\t- frame wall   " << wall_ms << " ms\n"
+				<< "\t- concurrent   " << concurrent_ms << " ms, lower bound ("
+				<< ( compute_ms > 0.0 ? 100.0 * std::min ( concurrent_ms / compute_ms , 1.0 ) : 0.0 ) << "% of compute)" << std::endl;
+		}
+
+		void DestroySyncObjects ( VkDevice logicalDevice , vkSyncObjects& syncObjects )
+		{
+			for ( size_t i = 0; i < syncObjects.in_flight_fences_.size (); ++i )
+			{
+				vkDestroySemaphore ( logicalDevice , syncObjects.finished_semaphores_[ i ] , nullptr );
+				vkDestroySemaphore ( logicalDevice , syncObjects.available_semaphores_[ i ] , nullptr );
+				vkDestroyFence ( logicalDevice , syncObjects.in_flight_fences_[ i ] , nullptr );
+			}
+			syncObjects.available_semaphores_.clear ();
+			syncObjects.finished_semaphores_.clear ();
+			syncObjects.in_flight_fences_.clear ();
+			syncObjects.images_in_flight_.assign ( syncObjects.images_in_flight_.size () , VK_NULL_HANDLE );
+		}
+
+		void DestroyAsyncCompute ( VkDevice logicalDevice , vkAsyncComputeData& asyncCompute )
+		{
+			for ( size_t i = 0; i < asyncCompute.pools_.size (); ++i )
+			{
+				vkDestroyCommandPool ( logicalDevice , asyncCompute.pools_[ i ] , nullptr );
+			}
+			for ( size_t i = 0; i < asyncCompute.finished_semaphores_.size (); ++i )
+			{
+				vkDestroySemaphore ( logicalDevice , asyncCompute.finished_semaphores_[ i ] , nullptr );
+			}
+			for ( size_t i = 0; i < asyncCompute.fences_.size (); ++i )
+			{
+				vkDestroyFence ( logicalDevice , asyncCompute.fences_[ i ] , nullptr );
+			}
+			vkDestroyQueryPool ( logicalDevice , asyncCompute.query_pool_ , nullptr );
+			asyncCompute.pools_.clear ();
+			asyncCompute.buffers_.clear ();
+			asyncCompute.finished_semaphores_.clear ();
+			asyncCompute.fences_.clear ();
+			asyncCompute.query_pool_ = VK_NULL_HANDLE;
+		}
+
+		void DestroyFrameTimings ( VkDevice logicalDevice , vkFrameTimingData& timings )
+		{
+			vkDestroyQueryPool ( logicalDevice , timings.query_pool_ , nullptr );
+			timings.query_pool_ = VK_NULL_HANDLE;
+		}
+
+		void DestroyFrameCommands ( VkDevice logicalDevice , vkFrameCommandData& frameCommands )
+		{
+			if ( frameCommands.workers_ )
+			{
+				DestroyRecordWorkers ( *frameCommands.workers_ );
+				frameCommands.workers_.reset ();
+			}
+
+			for ( auto const& pool : frameCommands.pools_ )
+			{
+				vkDestroyCommandPool ( logicalDevice , pool , nullptr );
+			}
+			for ( auto const& pool : frameCommands.secondary_pools_ )
+			{
+				vkDestroyCommandPool ( logicalDevice , pool , nullptr );
+			}
+			frameCommands.pools_.clear ();
+			frameCommands.buffers_.clear ();
+			frameCommands.secondary_pools_.clear ();
+			frameCommands.secondary_buffers_.clear ();
+			frameCommands.thread_count_ = 0;
 		}
 	}
 }
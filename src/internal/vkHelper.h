@@ -5,26 +5,230 @@
 */
 
 #pragma once
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR 1
+#endif
 #include <vulkan/vulkan.h>
 #include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <Windows.h>
+#endif
 #include <optional>
 #include <array>
 #include <unordered_map>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
 
 namespace vkHelper
 {
 	/*!
 	 * @brief holds all relevant swap chain objects
+	 *		an offscreen target has no swapchain_ and owns its images,
+	 *		each image is copied into a host visible readback buffer
 	*/
 	struct vkSwapChainData
 	{
 		VkSwapchainKHR				swapchain_ { VK_NULL_HANDLE };
 		VkExtent2D					extent_;
 		VkFormat					format_;
+		VkPresentModeKHR			present_mode_ { VK_PRESENT_MODE_FIFO_KHR };	// kept when the swap chain is recreated
 		std::vector<VkImage>		images_;
 		std::vector<VkImageView>	image_views_;
+
+		// offscreen only
+		std::vector<VkDeviceMemory>	image_memory_;
+		std::vector<VkBuffer>		readback_buffers_;
+		std::vector<VkDeviceMemory>	readback_memory_;
+		std::vector<void*>			readback_mapped_;
+		uint32_t					next_image_ { 0 };
+		uint32_t					last_image_ { 0 };
+
+		bool IsOffscreen () const
+		{
+			return swapchain_ == VK_NULL_HANDLE && !images_.empty ();
+		}
+	};
+
+	/*!
+	 * @brief a read only view of a whole file mapped into memory
+	*/
+	struct vkMappedFile
+	{
+		void const*	data_ { nullptr };
+		size_t		size_ { 0 };
+#ifdef _WIN32
+		HANDLE		file_ { INVALID_HANDLE_VALUE };
+		HANDLE		mapping_ { nullptr };
+#else
+		int			descriptor_ { -1 };
+#endif
+	};
+
+	/*!
+	 * @brief a SPIR-V file mapped and hashed before there is a device to create its module, see IO::PrefetchShader
+	*/
+	struct vkPrefetchedShader
+	{
+		vkMappedFile	file_;
+		uint64_t		hash_ { 0 };
+	};
+
+	/*!
+	 * @brief a cached module with the SPIR-V it was created from, a content hash hit is only reused when the words match
+	*/
+	struct vkCachedShader
+	{
+		std::vector<uint32_t>	code_;
+		VkShaderModule			module_ { VK_NULL_HANDLE };
+	};
+
+	/*!
+	 * @brief shader modules kept for the life of the device, looked up by path and then by content hash
+	 *		a path is mapped and hashed once, two paths holding the same SPIR-V share one module
+	 *		locked, pipelines may be built on several threads, modules are created outside the lock
+	*/
+	struct vkShaderCacheData
+	{
+		std::unordered_map<std::string , VkShaderModule>		by_path_;
+		std::unordered_multimap<uint64_t , vkCachedShader>	by_hash_;		// colliding hashes keep one entry per content
+		std::unordered_map<std::string , vkPrefetchedShader>	prefetched_;	// taken by the first load of the path
+		std::mutex											mutex_;
+		uint32_t											file_loads_ { 0 };
+		uint32_t											prefetch_hits_ { 0 };
+		uint32_t											path_hits_ { 0 };
+		uint32_t											hash_hits_ { 0 };
+	};
+
+	/*!
+	 * @brief a specialization constant of type T, id_ is the constant_id the shaders declare it with
+	*/
+	template <typename T>
+	struct vkSpecConstant
+	{
+		uint32_t	id_;
+	};
+
+	/*!
+	 * @brief specialization constant values given to every shader stage of a pipeline, stages ignore ids they do not declare
+	 *		entries are kept sorted by id, the same values set in any order hash and compare equal
+	 *		bool constants are stored as VkBool32
+	*/
+	struct vkSpecializationData
+	{
+		std::vector<VkSpecializationMapEntry>	entries_;
+		std::vector<uint8_t>					data_;
+
+		template <typename T>
+		void Set ( vkSpecConstant<T> constant , T value )
+		{
+			static_assert ( std::is_arithmetic<T>::value , "specialization constants are scalars" );
+			if constexpr ( std::is_same<T , bool>::value )
+			{
+				VkBool32 boolean = value ? VK_TRUE : VK_FALSE;
+				Write ( constant.id_ , &boolean , sizeof ( VkBool32 ) );
+			}
+			else
+			{
+				Write ( constant.id_ , &value , sizeof ( T ) );
+			}
+		}
+
+		void Write ( uint32_t id , void const* value , size_t size )
+		{
+			auto entry = std::lower_bound ( entries_.begin () , entries_.end () , id ,
+				[] ( VkSpecializationMapEntry const& lhs , uint32_t rhs ) { return lhs.constantID < rhs; } );
+			if ( entry == entries_.end () || entry->constantID != id )
+			{
+				entry = entries_.insert ( entry , { id , 0 , 0 } );
+			}
+			if ( entry->size != size )
+			{
+				// a new or resized constant goes to the end, the old bytes are left unused
+				entry->offset = static_cast< uint32_t >( data_.size () );
+				entry->size = size;
+				data_.resize ( data_.size () + size );
+			}
+			std::memcpy ( data_.data () + entry->offset , value , size );
+		}
+
+		size_t Hash () const
+		{
+			size_t hash { 14695981039346656037ull };
+			auto mix = [ &hash ] ( uint8_t byte ) { hash = ( hash ^ byte ) * 1099511628211ull; };
+			for ( auto const& entry : entries_ )
+			{
+				for ( uint32_t shift = 0; shift < 32; shift += 8 )
+				{
+					mix ( static_cast< uint8_t >( entry.constantID >> shift ) );
+				}
+				for ( size_t i = 0; i < entry.size; ++i )
+				{
+					mix ( data_[ entry.offset + i ] );
+				}
+			}
+			return hash;
+		}
+
+		bool operator== ( vkSpecializationData const& rhs ) const
+		{
+			if ( entries_.size () != rhs.entries_.size () )
+			{
+				return false;
+			}
+			for ( size_t i = 0; i < entries_.size (); ++i )
+			{
+				VkSpecializationMapEntry const& lhs_entry = entries_[ i ];
+				VkSpecializationMapEntry const& rhs_entry = rhs.entries_[ i ];
+				if ( lhs_entry.constantID != rhs_entry.constantID || lhs_entry.size != rhs_entry.size ||
+					std::memcmp ( data_.data () + lhs_entry.offset , rhs.data_.data () + rhs_entry.offset , lhs_entry.size ) != 0 )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/*!
+		 * @brief points into this, valid while it is not changed
+		*/
+		VkSpecializationInfo Info () const
+		{
+			VkSpecializationInfo info {};
+			info.mapEntryCount = static_cast< uint32_t >( entries_.size () );
+			info.pMapEntries = entries_.data ();
+			info.dataSize = data_.size ();
+			info.pData = data_.data ();
+			return info;
+		}
+	};
+
+	/*!
+	 * @brief state graphics pipelines vary by, fixed function state and the shaders' specialization constants
+	 *		the defaults are those of the built in pipeline
+	*/
+	struct vkPipelineState
+	{
+		VkCullModeFlags			cull_mode_ { VK_CULL_MODE_BACK_BIT };
+		VkFrontFace				front_face_ { VK_FRONT_FACE_CLOCKWISE };
+		bool					alpha_blend_ { false };
+		vkSpecializationData	constants_;
+
+		// e.g. points, drawn by a vertex shader of their own from one vec4 position per vertex
+		VkPrimitiveTopology		topology_ { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+		std::string				vertex_shader_;			// in place of the built in or instanced vertex shader when set
+		uint32_t				position_stride_ { 0 };	// non zero reads location 0 from binding 0 at this stride instead of the instanced input
 	};
 
 	/*!
@@ -34,6 +238,92 @@ namespace vkHelper
 	{
 		VkPipeline			pipeline_;
 		VkPipelineLayout	layout_;
+		VkPipelineCache		cache_ { VK_NULL_HANDLE };	// not owned, shared by every pipeline creation
+		bool				instanced_ { false };		// takes vkVertex and vkInstance input instead of the built in triangle
+		std::vector<VkDescriptorSetLayout>	set_layouts_;	// not owned, kept to rebuild the layout with the pipeline
+		uint32_t			push_constant_size_ { 0 };	// vertex and fragment push constant bytes, from offset 0
+		vkShaderCacheData*	shaders_ { nullptr };		// not owned, modules come from it when set
+		vkPipelineState		state_;
+	};
+
+	/*!
+	 * @brief a mesh vertex, vertex input binding 0
+	*/
+	struct vkVertex
+	{
+		float	position_[ 2 ];
+		float	color_[ 3 ];
+	};
+
+	/*!
+	 * @brief per instance attributes, vertex input binding 1 advanced once per instance
+	 *		transform_ is offset x, offset y, scale and rotation in radians
+	*/
+	struct vkInstance
+	{
+		float	transform_[ 4 ];
+		float	color_[ 4 ];
+	};
+
+	/*!
+	 * @brief per draw constants of the instanced pipeline, set 0 binding 0 at a dynamic offset
+	 *		or pushed with the draw when the pipeline has a push constant range
+	 *		the draw's instances are scaled by scale_, moved by offset_ and tinted by color_
+	*/
+	struct vkDrawConstants
+	{
+		float	offset_[ 2 ];
+		float	scale_;
+		float	padding_;
+		float	color_[ 4 ];
+	};
+
+	/*!
+	 * @brief specialization constants of the instanced vertex shaders, both on by default
+	 *		INSTANCE_ROTATION rotates instances by transform_[ 3 ], INSTANCE_TINT multiplies in the instance color
+	*/
+	static constexpr vkSpecConstant<bool> INSTANCE_ROTATION { 0 };
+	static constexpr vkSpecConstant<bool> INSTANCE_TINT { 1 };
+
+	/*!
+	 * @brief what one instanced draw reads, the buffers are owned by whoever filled them
+	 *		no vertex buffer draws the built in triangle
+	 *		with an indirect_buffer_ the draws come from the gpu, e.g. written by a culling pass before the render pass
+	*/
+	struct vkDrawData
+	{
+		VkBuffer	vertex_buffer_ { VK_NULL_HANDLE };
+		VkBuffer	instance_buffer_ { VK_NULL_HANDLE };
+		uint32_t	vertex_count_ { 3 };
+		uint32_t	instance_count_ { 1 };
+		VkBuffer	index_buffer_ { VK_NULL_HANDLE };	// uint16 indices, drawn indexed if set
+		uint32_t	index_count_ { 0 };
+
+		VkBuffer								indirect_buffer_ { VK_NULL_HANDLE };	// VkDrawIndexedIndirectCommand array
+		VkBuffer								count_buffer_ { VK_NULL_HANDLE };		// uint32 draw count
+		uint32_t								max_draw_count_ { 0 };
+		PFN_vkCmdDrawIndexedIndirectCountKHR	draw_indirect_count_ { nullptr };		// null draws all max_draw_count_ commands
+		uint32_t								max_draws_per_call_ { UINT32_MAX };	// the device's maxDrawIndirectCount, more are split over several calls
+
+		// draw i binds uniform_set_ at uniform_offset_ + i * uniform_stride_, its vkDrawConstants
+		VkDescriptorSet							uniform_set_ { VK_NULL_HANDLE };
+		uint32_t								uniform_offset_ { 0 };
+		uint32_t								uniform_stride_ { 0 };
+
+		// or draw i pushes push_constants_[ i ], the pipeline needs a vkDrawConstants sized push constant range
+		vkDrawConstants const*					push_constants_ { nullptr };
+	};
+
+	/*!
+	 * @brief a swap chain replaced during a resize, with the objects recorded against it
+	 *		released once every frame slot that may still use it has had its fence waited on
+	*/
+	struct vkRetiredSwapChainData
+	{
+		vkSwapChainData					swapchain_;
+		std::vector<VkFramebuffer>		framebuffers_;
+		std::vector<VkCommandBuffer>	command_buffers_;
+		std::vector<bool>				pending_frames_;
 	};
 
 	/*!
@@ -45,59 +335,232 @@ namespace vkHelper
 		std::vector<VkSemaphore>	finished_semaphores_;
 		std::vector<VkFence>		in_flight_fences_;
 		std::vector<VkFence>		images_in_flight_;
+
+		// deferred destruction of swap chains retired by RecreateSwapChain
+		std::vector<vkRetiredSwapChainData>	retired_swapchains_;
 	};
 
+	/*!
+	 * @brief holds the timestamp query pool and a fixed size ring of frame timings
+	 *		cpu phases of DrawFrame in ms, gpu render pass time read back once the frame's fence signals
+	*/
+	struct vkFrameTimingData
+	{
+		static constexpr size_t		RING_SIZE { 1024 };
+		static constexpr uint32_t	MAX_TIMED_IMAGES { 16 };
+
+		struct Sample
+		{
+			double	wait_ms_ { 0.0 };
+			double	acquire_ms_ { 0.0 };
+			double	submit_ms_ { 0.0 };
+			double	present_ms_ { 0.0 };
+			double	record_ms_ { 0.0 };
+			double	frame_ms_ { 0.0 };
+		};
+
+		VkQueryPool				query_pool_ { VK_NULL_HANDLE };
+		double					timestamp_period_ { 1.0 };
+		uint64_t				timestamp_mask_ { ~0ull };
+		std::vector<bool>		query_pending_;
+
+		std::vector<Sample>		cpu_samples_;
+		std::vector<double>		gpu_samples_;
+		size_t					cpu_count_ { 0 };
+		size_t					gpu_count_ { 0 };
+
+		// cpu start to gpu completion of each frame, the start is kept per frame slot until its fence is seen signaled
+		std::vector<double>		latency_samples_;
+		size_t					latency_count_ { 0 };
+		std::vector<std::chrono::steady_clock::time_point>	slot_start_;
+
+		std::chrono::steady_clock::time_point	last_frame_start_ {};
+	};
+
+	/*!
+	 * @brief persistent worker threads that run one job per worker and are waited on as a batch
+	*/
+	struct vkRecordWorkers
+	{
+		std::vector<std::thread>			threads_;
+		std::mutex							mutex_;
+		std::condition_variable				start_cv_;
+		std::condition_variable				done_cv_;
+		std::function<void ( uint32_t )>	job_;
+		uint64_t							generation_ { 0 };
+		uint32_t							pending_ { 0 };
+		bool								quit_ { false };
+	};
+
+	/*!
+	 * @brief one transient command pool and primary command buffer per frame in flight,
+	 *		the pool is reset as a whole and the buffer re-recorded by DrawFrame every frame
+	 *		with thread_count_ workers, each worker records its share of the draws into a secondary buffer
+	 *		from its own pool, the primary only executes them
+	*/
+	struct vkFrameCommandData
+	{
+		std::vector<VkCommandPool>		pools_;
+		std::vector<VkCommandBuffer>	buffers_;
+
+		uint32_t						draw_count_ { 1 };
+		vkDrawData						draw_;					// what each of the draw_count_ draws renders
+		uint32_t						thread_count_ { 0 };	// 0 records inline on the render thread
+		std::vector<VkCommandPool>		secondary_pools_;		// frame * thread_count_ + thread
+		std::vector<VkCommandBuffer>	secondary_buffers_;		// frame * thread_count_ + thread
+		std::unique_ptr<vkRecordWorkers>	workers_;
+
+		// host writes of the frame once its fence signaled, e.g. the draws' constants, may point draw_ at them
+		std::function<bool ( size_t , vkDrawData& )>	update_;
+
+		// work that has to finish before the render pass, e.g. gpu culling, may point draw_ at its results
+		std::vector<VkCommandBuffer>	pre_buffers_;			// recorded by pre_pass_ and submitted ahead of buffers_
+		std::function<bool ( VkCommandBuffer , size_t , vkDrawData& )>	pre_pass_;
+	};
+
+	/*!
+	 * @brief per frame compute work submitted on the compute queue next to the frame's graphics work
+	 *		graphics does not wait on the compute unless wait_stage_ is set, the frame slot waits on fences_ before its pool is reused
+	 *		with wait_stage_ set, finished_semaphores_ is signaled and the graphics submission waits on it at that stage, the one that reads the results
+	 *		timestamp pair 2f, 2f + 1 brackets frame f's compute, it is summed next to the render pass time of frame_images_[ f ]
+	 *		timestamps of different queues are not comparable, concurrency is judged against the cpu wall time between samples instead
+	*/
+	struct vkAsyncComputeData
+	{
+		VkQueue								queue_ { VK_NULL_HANDLE };
+		std::vector<VkCommandPool>			pools_;
+		std::vector<VkCommandBuffer>		buffers_;
+		std::vector<VkSemaphore>			finished_semaphores_;
+		std::vector<VkFence>				fences_;
+		VkPipelineStageFlags				wait_stage_ { 0 };		// 0 while graphics reads nothing the compute writes
+		std::function<bool ( VkCommandBuffer , size_t )>	record_;	// records frame's compute work, outside any render pass
+
+		// graphics side of the results, recorded into the frame's command buffer when set, needs per frame recording
+		std::function<void ( VkCommandBuffer , size_t )>	acquire_;	// ahead of the render pass, e.g. a queue family ownership transfer
+		std::function<void ( VkCommandBuffer , size_t )>	draw_;		// inside the render pass, after the frame's own draws
+
+		VkQueryPool							query_pool_ { VK_NULL_HANDLE };
+		uint64_t							timestamp_mask_ { ~0ull };
+		std::vector<bool>					query_pending_;
+		std::vector<uint32_t>				frame_images_;
+		double								compute_ms_ { 0.0 };
+		double								graphics_ms_ { 0.0 };
+		size_t								samples_ { 0 };
+		std::chrono::steady_clock::time_point	first_sample_ {};
+		std::chrono::steady_clock::time_point	last_sample_ {};
+	};
+
+	struct vkDeviceProfile;
+
 	namespace Create
 	{
 		/*!
 		 * @brief creates a vkinstance
 		*/
-		bool				vkInstance ( char const* name , VkInstance& instance , int flags );
+		bool				vkInstance ( char const* name , VkInstance& instance , int flags , bool headless = false );
 
 		/*!
 		 * @brief creates a vkDebugMessenger
 		*/
 		bool				vkDebugMessenger ( VkInstance instance , VkDebugUtilsMessengerEXT& debugMessenger );
 
+#ifdef _WIN32
 		/*!
 		 * @brief creates a vkSurfaceWin32
 		*/
 		bool				vkSurfaceWin32 ( VkInstance instance , HWND hWnd , VkSurfaceKHR& surface );
+#endif
 
 		/*!
-		 * @brief creates a vkPhysicalDevice
+		 * @brief creates a vkPhysicalDevice, and fills the profile of the device picked
 		*/
-		VkPhysicalDevice	vkPhysicalDevice ( VkInstance instance , VkSurfaceKHR surface );
+		VkPhysicalDevice	vkPhysicalDevice ( VkInstance instance , VkSurfaceKHR surface , vkDeviceProfile& profile );
 
 		/*!
 		 * @brief creates a vkLogicalDevice
 		*/
-		VkDevice			vkLogicalDevice ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , int flags );
+		VkDevice			vkLogicalDevice ( vkDeviceProfile const& profile , int flags );
 
 		/*!
 		 * @brief creates a vkGraphicsQueue
 		*/
-		VkQueue				vkGraphicsQueue ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice );
+		VkQueue				vkGraphicsQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice );
 
 		/*!
 		 * @brief creates a vkPresentQueue
 		*/
-		VkQueue				vkPresentQueue ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice );
+		VkQueue				vkPresentQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice );
+
+		/*!
+		 * @brief creates a vkTransferQueue, the graphics queue if the device has no separate transfer family
+		*/
+		VkQueue				vkTransferQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice );
+
+		/*!
+		 * @brief creates a vkComputeQueue, the graphics queue if the device has no separate compute family
+		*/
+		VkQueue				vkComputeQueue ( vkDeviceProfile const& profile , VkDevice logicalDevice );
 
 		/*!
-		 * @brief creates a vkSwapChain
+		 * @brief creates a vkSwapChain, refreshes the surface capabilities of the profile
+		 *		presentMode is used if the surface supports it, FIFO otherwise
 		*/
-		vkSwapChainData		vkSwapChain ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice );
+		vkSwapChainData		vkSwapChain ( vkDeviceProfile& profile , VkDevice logicalDevice , VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE ,
+			VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR );
+
+		/*!
+		 * @brief creates device owned images with readback buffers in place of a swap chain
+		*/
+		vkSwapChainData		vkOffscreenTarget ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkExtent2D extent , VkFormat format , uint32_t imageCount );
 
 		/*!
 		 * @brief creates a vkRenderPass
 		*/
-		VkRenderPass		vkRenderPass ( VkDevice logicalDevice , VkFormat imageFormat );
+		VkRenderPass		vkRenderPass ( VkDevice logicalDevice , VkFormat imageFormat , VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR );
 
 		/*!
 		 * @brief creates a vkGraphicsPipeline
+		 *		viewport and scissor are dynamic, the pipeline outlives swap chain resizes
+		 *		instanced reads a vkVertex buffer and a vkInstance buffer, see vkDrawData
+		 *		setLayouts make up the pipeline layout, the instanced shader reads vkDrawConstants from set 0
+		 *		with a pushConstantSize the layout gets one vertex and fragment push constant range instead
+		 *		and the instanced shader reads vkDrawConstants from it
+		 *		with a shaderCache the modules are taken from it, otherwise read and created for this pipeline only
+		 *		safe to call from several threads at once, pipeline caches are internally synchronized
+		*/
+		vkPipelineData		vkGraphicsPipeline ( VkDevice logicalDevice , VkRenderPass renderPass , VkPipelineCache pipelineCache = VK_NULL_HANDLE , bool instanced = false ,
+			std::vector<VkDescriptorSetLayout> const& setLayouts = {} , uint32_t pushConstantSize = 0 , vkShaderCacheData* shaderCache = nullptr ,
+			vkPipelineState const& state = {} );
+
+		/*!
+		 * @brief creates a compute pipeline from a SPIR-V file
+		 *		its layout takes setLayouts and one compute push constant range of pushConstantSize bytes
+		*/
+		vkPipelineData		vkComputePipeline ( VkDevice logicalDevice , std::string const& shaderFile , std::vector<VkDescriptorSetLayout> const& setLayouts ,
+			uint32_t pushConstantSize = 0 , VkPipelineCache pipelineCache = VK_NULL_HANDLE , vkShaderCacheData* shaderCache = nullptr );
+
+		/*!
+		 * @brief creates a vkDescriptorSetLayout
+		*/
+		VkDescriptorSetLayout	vkDescriptorSetLayout ( VkDevice logicalDevice , std::vector<VkDescriptorSetLayoutBinding> const& bindings );
+
+		/*!
+		 * @brief creates a vkDescriptorPool
+		*/
+		VkDescriptorPool	vkDescriptorPool ( VkDevice logicalDevice , std::vector<VkDescriptorPoolSize> const& poolSizes , uint32_t maxSets , VkDescriptorPoolCreateFlags flags = 0 );
+
+		/*!
+		 * @brief allocates count descriptor sets of one layout from a pool
+		*/
+		bool				vkDescriptorSets ( VkDevice logicalDevice , VkDescriptorPool pool , VkDescriptorSetLayout layout , uint32_t count , std::vector<VkDescriptorSet>& sets );
+
+		/*!
+		 * @brief creates a vkPipelineCache seeded from disk
+		 *		a file written for another device or driver, or a damaged file, is rejected and the cache starts empty
+		 *		fileData is the file read ahead with IO::ReadPipelineCacheFile, empty if there was none, when null it is read here
 		*/
-		vkPipelineData		vkGraphicsPipeline ( VkDevice logicalDevice , vkSwapChainData swapChainData , VkRenderPass renderPass );
+		VkPipelineCache		vkPipelineCache ( vkDeviceProfile const& profile , VkDevice logicalDevice , std::string const& filename ,
+			std::vector<char> const* fileData = nullptr );
 
 		/*!
 		 * @brief creates a vkFramebuffers
@@ -107,18 +570,49 @@ namespace vkHelper
 		/*!
 		 * @brief creates a vkCommandPool
 		*/
-		VkCommandPool		vkCommandPool ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice );
+		VkCommandPool		vkCommandPool ( vkDeviceProfile const& profile , VkDevice logicalDevice );
 
 		/*!
 		 * @brief creates a vkCommandBuffers
 		*/
-		bool				vkCommandBuffers ( VkDevice logicalDevice , vkSwapChainData swapChain , VkRenderPass renderPass , vkPipelineData graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers );
+		bool				vkCommandBuffers ( VkDevice logicalDevice , vkSwapChainData swapChain , VkRenderPass renderPass , vkPipelineData graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers ,
+			vkFrameTimingData const* timings = nullptr );
 
 		/*!
-		 * @brief creates a SyncObjects
+		 * @brief frames the cpu may record ahead of the gpu, 1 has the lowest latency, deeper queues ride out cpu hitches
 		*/
-		static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-		bool				SyncObjects ( VkDevice logicalDevice , vkSwapChainData swapChain , vkSyncObjects& syncObjects );
+		static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+		static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+		/*!
+		 * @brief creates a SyncObjects with framesInFlight frame slots, 1 to MAX_FRAMES_IN_FLIGHT
+		*/
+		bool				SyncObjects ( VkDevice logicalDevice , vkSwapChainData swapChain , vkSyncObjects& syncObjects , uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT );
+
+		/*!
+		 * @brief creates a transient command pool and command buffer for every frame in flight
+		 *		threadCount > 0 adds that many record workers, each with a transient pool and secondary buffer per frame
+		*/
+		bool				vkFrameCommands ( vkDeviceProfile const& profile , VkDevice logicalDevice , vkFrameCommandData& frameCommands , uint32_t threadCount = 0 , uint32_t drawCount = 1 ,
+			uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT );
+
+		/*!
+		 * @brief starts threadCount record workers
+		*/
+		void				RecordWorkers ( uint32_t threadCount , vkRecordWorkers& workers );
+
+		/*!
+		 * @brief creates the timestamp query pool and sample rings of a vkFrameTimingData
+		 *		gpu timing is skipped if the graphics queue has no timestamp support
+		*/
+		bool				FrameTimings ( vkDeviceProfile const& profile , VkDevice logicalDevice , vkFrameTimingData& timings );
+
+		/*!
+		 * @brief creates the per frame compute pools, command buffers and semaphores of a vkAsyncComputeData on computeQueue
+		 *		overlap timing is skipped if the compute queue has no timestamp support
+		*/
+		bool				AsyncCompute ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkQueue computeQueue , vkAsyncComputeData& asyncCompute ,
+			uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT );
 	}
 
 	namespace Check
@@ -131,22 +625,27 @@ namespace vkHelper
 		/*!
 		 * @brief checks InstanceExtensionsSupport
 		*/
-		bool InstanceExtensionsSupport ( bool debug );
+		bool InstanceExtensionsSupport ( bool debug , bool headless = false );
 
 		/*!
 		 * @brief checks DeviceExtensionsSupport
 		*/
-		bool DeviceExtensionsSupport ( VkPhysicalDevice device );
+		bool DeviceExtensionsSupport ( vkDeviceProfile const& profile , bool presentation = true );
 
 		/*!
 		 * @brief checks SwapChainSupport
 		*/
-		bool SwapChainSupport ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+		bool SwapChainSupport ( vkDeviceProfile const& profile );
 
 		/*!
-		 * @brief checks PhysicalDeviceSuitable
+		 * @brief checks PhysicalDeviceSuitable, no surface skips the presentation checks
 		*/
-		bool PhysicalDeviceSuitable ( VkPhysicalDevice device , VkSurfaceKHR surface );
+		bool PhysicalDeviceSuitable ( vkDeviceProfile const& profile );
+
+		/*!
+		 * @brief checks a single device extension, e.g. one of Get::OptionalDeviceExtensions
+		*/
+		bool DeviceExtensionAvailable ( vkDeviceProfile const& profile , char const* extension );
 	}
 
 	namespace Get
@@ -179,12 +678,22 @@ namespace vkHelper
 		/*!
 		 * @brief get all instance extensions based on debug mode
 		*/
-		std::vector<char const*> InstanceExtensions ( bool debug );
+		std::vector<char const*> InstanceExtensions ( bool debug , bool headless = false );
 
 		/*!
 		 * @brief get all device extensions
 		*/
-		std::vector<char const*> DeviceExtensions ();
+		std::vector<char const*> DeviceExtensions ( bool presentation = true );
+
+		/*!
+		 * @brief get device extensions enabled only if the device has them
+		*/
+		std::vector<char const*> OptionalDeviceExtensions ();
+
+		/*!
+		 * @brief get a memory type index matching the filter and properties
+		*/
+		std::optional<uint32_t> MemoryType ( vkDeviceProfile const& profile , uint32_t typeFilter , VkMemoryPropertyFlags properties );
 
 		/*!
 		 * @brief object that checks if all queue families are ready
@@ -193,14 +702,26 @@ namespace vkHelper
 		{
 			std::optional<uint32_t> graphics_family_;
 			std::optional<uint32_t> present_family_;
+			std::optional<uint32_t> transfer_family_;	// a dedicated transfer family if there is one, else graphics
+			std::optional<uint32_t> compute_family_;	// a compute family without graphics if there is one, else graphics
+
+			bool HasDedicatedTransfer () const
+			{
+				return transfer_family_.has_value () && transfer_family_ != graphics_family_;
+			}
+
+			bool HasDedicatedCompute () const
+			{
+				return compute_family_.has_value () && compute_family_ != graphics_family_;
+			}
 
-			bool IsComplete ()
+			bool IsComplete () const
 			{
 				return graphics_family_.has_value ()
 					&& present_family_.has_value ();
 			}
 		};
-		QueueFamilyIndices QueueFamilies ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+		QueueFamilyIndices QueueFamilies ( vkDeviceProfile const& profile );
 
 		/*!
 		 * @brief object that holds all swap chain support details
@@ -220,17 +741,27 @@ namespace vkHelper
 		/*!
 		 * @brief gets swap chain surface format
 		*/
-		VkSurfaceFormatKHR			vkSwapChainSurfaceFormat ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+		VkSurfaceFormatKHR			vkSwapChainSurfaceFormat ( SwapChainSupportDetails const& details );
 
 		/*!
-		 * @brief gets swap chain present mode
+		 * @brief gets swap chain present mode, preferred if available, else FIFO which always is
 		*/
-		VkPresentModeKHR			vkSwapChainPresentMode ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+		VkPresentModeKHR			vkSwapChainPresentMode ( SwapChainSupportDetails const& details , VkPresentModeKHR preferred = VK_PRESENT_MODE_MAILBOX_KHR );
 
 		/*!
 		 * @brief gets swap chain extent2D
 		*/
-		VkExtent2D					vkSwapChainExtent2D ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+		VkExtent2D					vkSwapChainExtent2D ( VkSurfaceCapabilitiesKHR const& capabilities );
+
+		/*!
+		 * @brief gathers everything queried about a physical device and its surface, once
+		*/
+		vkDeviceProfile				DeviceProfile ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface );
+
+		/*!
+		 * @brief re-queries the surface capabilities, the only surface data that changes on resize
+		*/
+		void						RefreshSurfaceCapabilities ( vkDeviceProfile& profile );
 
 		/*!
 		 * @brief gets swap chain images
@@ -243,6 +774,24 @@ namespace vkHelper
 		std::vector<VkImageView>	vkSwapChainImageViews ( VkDevice logicalDevice , std::vector<VkImage> const& swapChainImages , VkFormat swapChainImageFormat );
 	}
 
+	/*!
+	 * @brief everything queried about the physical device and surface in use, gathered once by Get::DeviceProfile
+	 *		only swapchain_support_.capabilities_ is refreshed, on swap chain creation
+	*/
+	struct vkDeviceProfile
+	{
+		VkPhysicalDevice					physical_device_ { VK_NULL_HANDLE };
+		VkSurfaceKHR						surface_ { VK_NULL_HANDLE };
+		VkPhysicalDeviceProperties			properties_ {};
+		VkPhysicalDeviceFeatures			features_ {};
+		VkPhysicalDeviceMemoryProperties	memory_properties_ {};
+		std::vector<VkQueueFamilyProperties>	queue_families_;
+		std::vector<VkBool32>				present_support_;
+		std::vector<VkExtensionProperties>	extensions_;
+		Get::SwapChainSupportDetails		swapchain_support_;
+		Get::QueueFamilyIndices				indices_;
+	};
+
 	namespace Debug
 	{
 		/*!
@@ -285,25 +834,241 @@ namespace vkHelper
 		 * @brief compiles the shader code into a shader module
 		*/
 		VkShaderModule		CreateShaderModule ( VkDevice logicalDevice , std::vector<char> const& code );
+
+		/*!
+		 * @brief maps a whole file read only, false if it cannot be opened or is empty
+		*/
+		bool				MapFile ( std::string const& filename , vkMappedFile& file );
+
+		void				UnmapFile ( vkMappedFile& file );
+
+		/*!
+		 * @brief the cached module of a SPIR-V file, mapped and created on first use, VK_NULL_HANDLE on failure
+		*/
+		VkShaderModule		LoadShaderModule ( VkDevice logicalDevice , vkShaderCacheData& shaderCache , std::string const& filename );
+
+		/*!
+		 * @brief maps and hashes a SPIR-V file ahead of LoadShaderModule, which then only creates the module
+		 *		needs no device, can run on any thread while the device is being created
+		*/
+		bool				PrefetchShader ( vkShaderCacheData& shaderCache , std::string const& filename );
+
+		/*!
+		 * @brief reads a pipeline cache file, false if missing or its header does not match this device
+		*/
+		bool				LoadPipelineCacheData ( vkDeviceProfile const& profile , std::string const& filename , std::vector<char>& data );
+
+		/*!
+		 * @brief reads a whole pipeline cache file, header included, false if missing
+		 *		needs no device, can run while the device is being created
+		*/
+		bool				ReadPipelineCacheFile ( std::string const& filename , std::vector<char>& file );
+
+		/*!
+		 * @brief checks a file read by ReadPipelineCacheFile against this device and copies its cache data out
+		*/
+		bool				ParsePipelineCacheData ( vkDeviceProfile const& profile , std::string const& filename , std::vector<char> const& file , std::vector<char>& data );
+
+		/*!
+		 * @brief writes the pipeline cache to disk behind a header of the device uuid and driver version
+		*/
+		bool				SavePipelineCache ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkPipelineCache pipelineCache , std::string const& filename );
 	}
 
 	namespace Misc
 	{
+		/*!
+		 * @brief mixes value into seed, for the hashes of the layout, descriptor set and pipeline variant caches
+		*/
+		inline void HashCombine ( size_t& seed , size_t value )
+		{
+			seed ^= value + static_cast< size_t >( 0x9e3779b97f4a7c15ull ) + ( seed << 6 ) + ( seed >> 2 );
+		}
+
+		/*!
+		 * @brief records the draw of one swap chain image into a command buffer
+		 *		with secondaryBuffers the render pass only executes them, otherwise drawCount draws are recorded inline
+		 *		with asyncCompute, its acquire_ and inline draw_ of frame are recorded around them
+		*/
+		bool RecordCommandBuffer ( VkCommandBuffer commandBuffer , vkSwapChainData const& swapChain , VkRenderPass renderPass , vkPipelineData const& graphicsPipeline , VkFramebuffer framebuffer , uint32_t imageIndex ,
+			VkCommandBufferUsageFlags usage , vkFrameTimingData const* timings = nullptr , uint32_t drawCount = 1 , VkCommandBuffer const* secondaryBuffers = nullptr , uint32_t secondaryCount = 0 ,
+			vkDrawData const* draw = nullptr , vkAsyncComputeData const* asyncCompute = nullptr , size_t frame = 0 );
+
+		/*!
+		 * @brief binds the pipeline, sets the dynamic state and records drawCount draws, inside a render pass
+		 *		with a vertex buffer in draw, each draw binds the mesh and instance buffers and draws every instance in one call
+		 *		with an indirect buffer in draw, the draws and their count are read from the gpu instead
+		 *		with a uniform set or push constants in draw, each draw binds or pushes its constants,
+		 *		firstDraw is the index of the first one
+		*/
+		void RecordDraws ( VkCommandBuffer commandBuffer , vkSwapChainData const& swapChain , vkPipelineData const& graphicsPipeline , uint32_t drawCount , vkDrawData const* draw = nullptr ,
+			uint32_t firstDraw = 0 );
+
+		/*!
+		 * @brief pushes one draw's constants, the pipeline needs a vkDrawConstants sized push constant range
+		*/
+		void PushDrawConstants ( VkCommandBuffer commandBuffer , vkPipelineData const& graphicsPipeline , vkDrawConstants const& constants );
+
+		/*!
+		 * @brief points binding of a descriptor set at a buffer range
+		*/
+		void WriteBufferDescriptor ( VkDevice logicalDevice , VkDescriptorSet set , uint32_t binding , VkDescriptorType type , VkBuffer buffer , VkDeviceSize offset = 0 , VkDeviceSize range = VK_WHOLE_SIZE );
+
+		/*!
+		 * @brief records every worker's share of the draws into its secondary buffer for frame, in parallel
+		 *		the last worker records asyncCompute's draw_ after its share
+		*/
+		bool RecordSecondaryBuffers ( VkDevice logicalDevice , vkFrameCommandData& frameCommands , size_t frame , vkSwapChainData const& swapChain , VkRenderPass renderPass , vkPipelineData const& graphicsPipeline ,
+			VkFramebuffer framebuffer , vkAsyncComputeData const* asyncCompute = nullptr );
+
+		/*!
+		 * @brief body of a record worker thread, runs the current job once per RunRecordWorkers
+		*/
+		void RecordWorkerLoop ( vkRecordWorkers* workers , uint32_t index );
+
+		/*!
+		 * @brief runs job ( worker index ) on every record worker and waits for all of them
+		*/
+		void RunRecordWorkers ( vkRecordWorkers& workers , std::function<void ( uint32_t )> const& job );
+
+		/*!
+		 * @brief stops and joins the record workers
+		*/
+		void DestroyRecordWorkers ( vkRecordWorkers& workers );
+
+		/*!
+		 * @brief called by RecreateSwapChain once the render pass is recreated for a new surface format, before the old one is destroyed,
+		 *		with the new render pass and the pipeline already rebuilt against it, every other pipeline of the old render pass is its to rebuild
+		*/
+		using vkRenderPassChanged = std::function<void ( VkRenderPass , vkPipelineData const& )>;
+
 		/*!
 		 * @brief draws a vulkan frame 
+		 *		with frameCommands, the frame's transient pool is reset and its command buffer re-recorded
+		 *		instead of submitting the prerecorded commandBuffers
+		 *		with asyncCompute, the frame's compute work is submitted on the compute queue first, the graphics submission only waits on it at wait_stage_ if set
 		*/
-		void DrawFrame ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice , VkQueue graphicsQueue , VkQueue presentQueue , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
-			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , size_t& currentFrame );
+		void DrawFrame ( vkDeviceProfile& profile , VkDevice logicalDevice , VkQueue graphicsQueue , VkQueue presentQueue , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , size_t& currentFrame , vkFrameTimingData* timings = nullptr ,
+			vkFrameCommandData* frameCommands = nullptr , vkAsyncComputeData* asyncCompute = nullptr , vkRenderPassChanged const* renderPassChanged = nullptr );
 
 		/*!
 		 * @brief recreates the swap chain
+		 *		hands the old swap chain to the new one and retires it without waiting on the device,
+		 *		the render pass and pipeline are only rebuilt if the surface format changed,
+		 *		command buffers are only prerecorded again if there were any
+		*/
+		void RecreateSwapChain ( vkDeviceProfile& profile , VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , vkFrameTimingData* timings = nullptr ,
+			vkRenderPassChanged const* renderPassChanged = nullptr );
+
+		/*!
+		 * @brief destroys pipeline and creates it again from its own settings against renderPass, nothing may still use it
+		*/
+		void RebuildPipeline ( VkDevice logicalDevice , VkRenderPass renderPass , vkPipelineData& pipeline );
+
+		/*!
+		 * @brief recreates an offscreen target at a new extent, retiring the old images like RecreateSwapChain
+		*/
+		void ResizeOffscreenTarget ( vkDeviceProfile const& profile , VkDevice logicalDevice , VkExtent2D extent , vkSwapChainData& offscreen , VkRenderPass renderPass , vkPipelineData& graphicsPipeline ,
+			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers , vkSyncObjects& syncObjects , vkFrameTimingData* timings = nullptr );
+
+		/*!
+		 * @brief moves a swap chain and its framebuffers and command buffers into the deferred destruction list
+		*/
+		void RetireSwapChain ( vkSyncObjects& syncObjects , vkSwapChainData& swapChain , std::vector<VkFramebuffer>& framebuffers , std::vector<VkCommandBuffer>& commandBuffers );
+
+		/*!
+		 * @brief marks a frame slot's fence as waited on and destroys retired swap chains no frame can still use
+		 *		deviceIdle releases everything, e.g. at shutdown
+		*/
+		void ReleaseRetiredSwapChains ( VkDevice logicalDevice , VkCommandPool commandPool , vkSyncObjects& syncObjects , size_t completedFrame , bool deviceIdle = false );
+
+		/*!
+		 * @brief clean up the swap chain and the objects sized to it, i.e. framebuffers and command buffers
+		*/
+		void CleanUpSwapChain ( VkDevice logicalDevice , vkSwapChainData& swapChain , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers );
+
+		/*!
+		 * @brief destroys the pipeline and its layout, the shared cache is left alive
+		*/
+		void DestroyPipeline ( VkDevice logicalDevice , vkPipelineData& pipeline );
+
+		/*!
+		 * @brief destroys the images, memory and readback buffers of an offscreen target
+		*/
+		void DestroyOffscreenTarget ( VkDevice logicalDevice , vkSwapChainData& offscreen );
+
+		/*!
+		 * @brief copies a finished offscreen image into host memory, waits on the image's fence
+		*/
+		bool ReadbackImage ( VkDevice logicalDevice , vkSwapChainData const& offscreen , vkSyncObjects const& syncObjects , uint32_t imageIndex , std::vector<char>& pixels );
+
+		/*!
+		 * @brief prints p50/p95/p99 of every cpu phase and of the gpu time collected so far
+		*/
+		void ReportFrameTimings ( vkFrameTimingData const& timings , std::ostream& out );
+
+		/*!
+		 * @brief nearest rank percentile p in [0,1] of sorted values, 0 when there are none
+		*/
+		double Percentile ( std::vector<double> const& sorted , double p );
+
+		/*!
+		 * @brief percentile p in [0,1] of one cpu phase over the samples collected so far, e.g. &vkFrameTimingData::Sample::record_ms_
+		*/
+		double CpuPercentile ( vkFrameTimingData const& timings , double vkFrameTimingData::Sample::* phase , double p );
+
+		/*!
+		 * @brief percentile p in [0,1] of the gpu render pass time over the samples collected so far
+		*/
+		double GpuPercentile ( vkFrameTimingData const& timings , double p );
+
+		/*!
+		 * @brief percentile p in [0,1] of the time from a frame's cpu start to its gpu completion over the samples collected so far
+		*/
+		double LatencyPercentile ( vkFrameTimingData const& timings , double p );
+
+		/*!
+		 * @brief drops every sample collected so far, pending gpu queries are kept, the latency of frames still in flight is not measured
+		*/
+		void ResetFrameTimings ( vkFrameTimingData& timings );
+
+		/*!
+		 * @brief prints the mean compute and render pass gpu time per frame against the cpu wall time per frame,
+		 *		whatever gpu time does not fit into the wall time must have run on both queues at once,
+		 *		a lower bound of the overlap, it reads 0 whenever the gpu idled for longer than the queues overlapped
+		*/
+		void ReportComputeOverlap ( vkAsyncComputeData const& asyncCompute , std::ostream& out );
+
+		/*!
+		 * @brief destroys the semaphores and fences of a vkSyncObjects, retired swap chains are left to ReleaseRetiredSwapChains
+		*/
+		void DestroySyncObjects ( VkDevice logicalDevice , vkSyncObjects& syncObjects );
+
+		/*!
+		 * @brief destroys the pools, semaphores, fences and query pool of a vkAsyncComputeData
+		*/
+		void DestroyAsyncCompute ( VkDevice logicalDevice , vkAsyncComputeData& asyncCompute );
+
+		/*!
+		 * @brief prints how many shader files were loaded and how many lookups the cache answered
+		*/
+		void ReportShaderCache ( vkShaderCacheData& shaderCache , std::ostream& out );
+
+		/*!
+		 * @brief destroys every module of a vkShaderCacheData, no pipeline may still be created from them
+		*/
+		void DestroyShaderCache ( VkDevice logicalDevice , vkShaderCacheData& shaderCache );
+
+		/*!
+		 * @brief destroys the query pool of a vkFrameTimingData
 		*/
-		void RecreateSwapChain ( VkPhysicalDevice physicalDevice , VkSurfaceKHR surface , VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass& renderPass , vkPipelineData& graphicsPipeline ,
-			std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers );
+		void DestroyFrameTimings ( VkDevice logicalDevice , vkFrameTimingData& timings );
 
 		/*!
-		 * @brief clean up the swap chain
+		 * @brief stops the record workers and destroys the transient pools of a vkFrameCommandData, freeing their command buffers
 		*/
-		void CleanUpSwapChain ( VkDevice logicalDevice , vkSwapChainData& swapChain , VkRenderPass renderPass , vkPipelineData& graphicsPipeline , std::vector<VkFramebuffer>& framebuffers , VkCommandPool commandPool , std::vector<VkCommandBuffer>& commandBuffers );
+		void DestroyFrameCommands ( VkDevice logicalDevice , vkFrameCommandData& frameCommands );
 	}
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkLog.h"
+
+#include <memory>
+#include <thread>
+#include <chrono>
+
+namespace vkLog
+{
+	namespace Detail
+	{
+		std::atomic<int> g_level_ { static_cast< int >( LEVEL::INFO ) };
+
+		/*!
+		 * @brief a bounded multi producer ring with one consumer, the writer thread
+		 *		a line is free for position p when its sequence is p, written when it is p + 1
+		*/
+		struct Ring
+		{
+			std::unique_ptr<Line[]>		lines_;
+			size_t						mask_ { 0 };
+			std::atomic<size_t>			enqueue_ { 0 };
+			std::atomic<size_t>			dequeue_ { 0 };
+			std::atomic<size_t>			dropped_ { 0 };
+			std::atomic<bool>			running_ { false };
+			std::atomic<bool>			stopping_ { false };
+			std::thread					writer_;
+
+			~Ring ()
+			{
+				Shutdown ();
+			}
+		};
+		static Ring g_ring_;
+
+		bool Running ()
+		{
+			return g_ring_.running_.load ( std::memory_order_acquire );
+		}
+
+		Line* Claim ( size_t& position )
+		{
+			position = g_ring_.enqueue_.load ( std::memory_order_relaxed );
+			for ( ;;)
+			{
+				Line& line = g_ring_.lines_[ position & g_ring_.mask_ ];
+				size_t sequence = line.sequence_.load ( std::memory_order_acquire );
+				intptr_t difference = static_cast< intptr_t >( sequence ) - static_cast< intptr_t >( position );
+				if ( difference == 0 )
+				{
+					if ( g_ring_.enqueue_.compare_exchange_weak ( position , position + 1 , std::memory_order_relaxed ) )
+					{
+						return &line;
+					}
+				}
+				else if ( difference < 0 )
+				{
+					// the writer thread is a lap behind, never block the caller on it
+					return nullptr;
+				}
+				else
+				{
+					position = g_ring_.enqueue_.load ( std::memory_order_relaxed );
+				}
+			}
+		}
+
+		void Publish ( Line& line , size_t position )
+		{
+			line.sequence_.store ( position + 1 , std::memory_order_release );
+		}
+
+		void Drop ()
+		{
+			g_ring_.dropped_.fetch_add ( 1 , std::memory_order_relaxed );
+		}
+
+		void WriteNow ( Line const& line )
+		{
+			std::FILE* stream = line.level_ >= LEVEL::WARNING ? stderr : stdout;
+			std::fwrite ( line.text_ , 1 , line.length_ , stream );
+			std::fputc ( '\n' , stream );
+		}
+
+		/*!
+		 * @brief writes every published line in order, returns how many
+		*/
+		static size_t Drain ()
+		{
+			size_t position = g_ring_.dequeue_.load ( std::memory_order_relaxed );
+			size_t written { 0 };
+			for ( ;; ++written , ++position )
+			{
+				Line& line = g_ring_.lines_[ position & g_ring_.mask_ ];
+				if ( line.sequence_.load ( std::memory_order_acquire ) != position + 1 )
+				{
+					break;
+				}
+				WriteNow ( line );
+				line.sequence_.store ( position + g_ring_.mask_ + 1 , std::memory_order_release );
+				g_ring_.dequeue_.store ( position + 1 , std::memory_order_release );
+			}
+
+			// one flush per batch instead of one per line
+			if ( written > 0 )
+			{
+				std::fflush ( stdout );
+				std::fflush ( stderr );
+			}
+			return written;
+		}
+
+		static void WriterThread ()
+		{
+			while ( !g_ring_.stopping_.load ( std::memory_order_acquire ) )
+			{
+				if ( Drain () == 0 )
+				{
+					std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
+				}
+			}
+		}
+	}
+
+	bool Initialize ( Parameters const& params )
+	{
+		using namespace Detail;
+		if ( g_ring_.running_ )
+		{
+			return true;
+		}
+		SetLevel ( params.level_ );
+
+		size_t capacity { 2 };
+		while ( capacity < params.capacity_ )
+		{
+			capacity *= 2;
+		}
+		g_ring_.lines_ = std::make_unique<Line[]> ( capacity );
+		for ( size_t i = 0; i < capacity; ++i )
+		{
+			g_ring_.lines_[ i ].sequence_.store ( i , std::memory_order_relaxed );
+		}
+		g_ring_.mask_ = capacity - 1;
+		g_ring_.enqueue_ = 0;
+		g_ring_.dequeue_ = 0;
+		g_ring_.dropped_ = 0;
+		g_ring_.stopping_ = false;
+
+		g_ring_.writer_ = std::thread ( WriterThread );
+		g_ring_.running_.store ( true , std::memory_order_release );
+		return true;
+	}
+
+	void SetLevel ( LEVEL level )
+	{
+		Detail::g_level_.store ( static_cast< int >( level ) , std::memory_order_relaxed );
+	}
+
+	bool ParseLevel ( char const* name , LEVEL& level )
+	{
+		struct Name
+		{
+			char const*	name_;
+			LEVEL		level_;
+		};
+		static constexpr Name names[] {
+			{ "trace" , LEVEL::TRACE } ,
+			{ "info" , LEVEL::INFO } ,
+			{ "warning" , LEVEL::WARNING } ,
+			{ "failure" , LEVEL::FAILURE } ,
+			{ "off" , LEVEL::OFF } };
+
+		for ( auto const& entry : names )
+		{
+			if ( !std::strcmp ( name , entry.name_ ) )
+			{
+				level = entry.level_;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Flush ()
+	{
+		using namespace Detail;
+		if ( !Running () )
+		{
+			return;
+		}
+
+		// lines claimed before this point are written once dequeue_ passes it
+		size_t target = g_ring_.enqueue_.load ( std::memory_order_acquire );
+		while ( g_ring_.dequeue_.load ( std::memory_order_acquire ) < target )
+		{
+			std::this_thread::yield ();
+		}
+	}
+
+	void Shutdown ()
+	{
+		using namespace Detail;
+		if ( !g_ring_.running_.exchange ( false , std::memory_order_acq_rel ) )
+		{
+			return;
+		}
+
+		g_ring_.stopping_.store ( true , std::memory_order_release );
+		g_ring_.writer_.join ();
+		Drain ();
+
+		size_t dropped = g_ring_.dropped_.load ( std::memory_order_relaxed );
+		if ( dropped > 0 )
+		{
+			VKLOG_WARNING ( "### vkLog: " , dropped , " trace and info lines dropped, the ring was full. Raise Parameters::capacity_." );
+		}
+		g_ring_.lines_.reset ();
+	}
+}
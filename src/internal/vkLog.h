@@ -0,0 +1,223 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <charconv>
+
+/*!
+ * @brief lowest level compiled in, 0 trace, 1 info, 2 warning, 3 failure, 4 nothing
+ *		lines below it compile to nothing, their arguments are not evaluated
+*/
+#ifndef VKLOG_LEVEL
+#if defined(DEBUG) | defined(_DEBUG)
+#define VKLOG_LEVEL 0
+#else
+#define VKLOG_LEVEL 1
+#endif
+#endif
+
+/*!
+ * @brief logs the arguments, streamed one after the other, as one line, e.g. VKLOG_INFO ( "### Loaded " , size , " bytes." );
+ *		below the run time level only the level check runs
+*/
+#define VKLOG( level , ... ) \
+	do \
+	{ \
+		if constexpr ( static_cast< int >( vkLog::LEVEL::level ) >= VKLOG_LEVEL ) \
+		{ \
+			if ( vkLog::Enabled ( vkLog::LEVEL::level ) ) \
+			{ \
+				vkLog::Write ( vkLog::LEVEL::level , __VA_ARGS__ ); \
+			} \
+		} \
+	} while ( 0 )
+
+#define VKLOG_TRACE( ... )		VKLOG ( TRACE , __VA_ARGS__ )
+#define VKLOG_INFO( ... )		VKLOG ( INFO , __VA_ARGS__ )
+#define VKLOG_WARNING( ... )	VKLOG ( WARNING , __VA_ARGS__ )
+#define VKLOG_FAILURE( ... )	VKLOG ( FAILURE , __VA_ARGS__ )
+
+namespace vkLog
+{
+	/*!
+	 * @brief FAILURE rather than ERROR, wingdi.h defines ERROR
+	 *		failures and warnings go to stderr, the rest to stdout
+	*/
+	enum class LEVEL : int
+	{
+		TRACE = 0 ,
+		INFO ,
+		WARNING ,
+		FAILURE ,
+		OFF
+	};
+
+	struct Parameters
+	{
+		LEVEL		level_ { LEVEL::INFO };
+		uint32_t	capacity_ { 1024 };		// lines, rounded up to a power of two
+	};
+
+	/*!
+	 * @brief starts the thread writing queued lines out
+	 *		lines logged before Initialize or after Shutdown are written on the calling thread
+	*/
+	bool Initialize ( Parameters const& params );
+
+	void SetLevel ( LEVEL level );
+
+	/*!
+	 * @brief parses trace, info, warning, failure or off
+	*/
+	bool ParseLevel ( char const* name , LEVEL& level );
+
+	/*!
+	 * @brief blocks until every line logged before the call is written, for output that must not interleave with it
+	*/
+	void Flush ();
+
+	/*!
+	 * @brief writes what is queued and stops the thread, nothing may be logging concurrently
+	*/
+	void Shutdown ();
+
+	namespace Detail
+	{
+		static constexpr size_t LINE_SIZE { 1024 - 2 * sizeof ( uint64_t ) };
+
+		/*!
+		 * @brief a ring slot, sequence_ tells producers and the writer thread whose turn it is
+		*/
+		struct Line
+		{
+			std::atomic<size_t>	sequence_ { 0 };
+			LEVEL				level_ { LEVEL::INFO };
+			uint32_t			length_ { 0 };
+			char				text_[ LINE_SIZE ];
+		};
+
+		extern std::atomic<int> g_level_;
+
+		bool Running ();
+
+		/*!
+		 * @brief claims the next free line, nullptr when the ring is full
+		*/
+		Line* Claim ( size_t& position );
+
+		void Publish ( Line& line , size_t position );
+
+		void Drop ();
+
+		void WriteNow ( Line const& line );
+
+		inline void AppendText ( Line& line , char const* text , size_t size )
+		{
+			size_t room = LINE_SIZE - line.length_;
+			if ( size > room )
+			{
+				// truncated, mark it
+				std::memcpy ( line.text_ + line.length_ , text , room );
+				line.length_ = static_cast< uint32_t >( LINE_SIZE );
+				std::memcpy ( line.text_ + LINE_SIZE - 3 , "..." , 3 );
+				return;
+			}
+			std::memcpy ( line.text_ + line.length_ , text , size );
+			line.length_ += static_cast< uint32_t >( size );
+		}
+
+		/*!
+		 * @brief formats value the way operator<< of std::ostream would, without the stream
+		*/
+		template <typename T>
+		void Append ( Line& line , T const& value )
+		{
+			using Value = std::decay_t<T>;
+			if constexpr ( std::is_pointer<T>::value && std::is_same<std::remove_cv_t<std::remove_pointer_t<T>> , char>::value )
+			{
+				// arrays, literals among them, are never null and take the string_view path
+				char const* text = value ? value : "(null)";
+				AppendText ( line , text , std::strlen ( text ) );
+			}
+			else if constexpr ( std::is_convertible<T const& , std::string_view>::value )
+			{
+				std::string_view text ( value );
+				AppendText ( line , text.data () , text.size () );
+			}
+			else if constexpr ( std::is_same<Value , bool>::value || std::is_same<Value , char>::value )
+			{
+				char c = std::is_same<Value , bool>::value ? ( value ? '1' : '0' ) : static_cast< char >( value );
+				AppendText ( line , &c , 1 );
+			}
+			else if constexpr ( std::is_enum<Value>::value )
+			{
+				Append ( line , static_cast< std::underlying_type_t<Value> >( value ) );
+			}
+			else if constexpr ( std::is_integral<Value>::value )
+			{
+				char buffer[ 24 ];
+				auto result = std::to_chars ( buffer , buffer + sizeof ( buffer ) , value );
+				AppendText ( line , buffer , static_cast< size_t >( result.ptr - buffer ) );
+			}
+			else if constexpr ( std::is_floating_point<Value>::value )
+			{
+				char buffer[ 32 ];
+				int size = std::snprintf ( buffer , sizeof ( buffer ) , "%g" , static_cast< double >( value ) );
+				AppendText ( line , buffer , size > 0 ? static_cast< size_t >( size ) : 0 );
+			}
+			else if constexpr ( std::is_pointer<Value>::value )
+			{
+				char buffer[ 24 ];
+				int size = std::snprintf ( buffer , sizeof ( buffer ) , "%p" , static_cast< void const* >( value ) );
+				AppendText ( line , buffer , size > 0 ? static_cast< size_t >( size ) : 0 );
+			}
+			else
+			{
+				static_assert ( std::is_void<T>::value , "vkLog can not format this type" );
+			}
+		}
+	}
+
+	inline bool Enabled ( LEVEL level )
+	{
+		return static_cast< int >( level ) >= Detail::g_level_.load ( std::memory_order_relaxed );
+	}
+
+	/*!
+	 * @brief formats straight into a ring line on the calling thread, the writer thread does the io
+	 *		with the ring full trace and info lines are dropped and counted, warnings and failures are written on the calling thread
+	*/
+	template <typename... Args>
+	void Write ( LEVEL level , Args const&... args )
+	{
+		size_t position;
+		Detail::Line* line = Detail::Running () ? Detail::Claim ( position ) : nullptr;
+		if ( line == nullptr )
+		{
+			if ( Detail::Running () && level < LEVEL::WARNING )
+			{
+				Detail::Drop ();
+				return;
+			}
+			Detail::Line local;
+			local.level_ = level;
+			( Detail::Append ( local , args ) , ... );
+			Detail::WriteNow ( local );
+			return;
+		}
+		line->level_ = level;
+		line->length_ = 0;
+		( Detail::Append ( *line , args ) , ... );
+		Detail::Publish ( *line , position );
+	}
+}
@@ -0,0 +1,460 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkMemory.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <map>
+#include <algorithm>
+
+namespace vkMemory
+{
+	/*!
+	 * @brief one range of a FREE_LIST block, keyed by its offset
+	*/
+	struct Range
+	{
+		VkDeviceSize	size_ { 0 };
+		bool			free_ { true };
+		TILING			tiling_ { TILING::LINEAR };
+	};
+
+	struct Block
+	{
+		VkDeviceMemory	memory_ { VK_NULL_HANDLE };
+		VkDeviceSize	size_ { 0 };
+		void*			mapped_ { nullptr };
+		uint32_t		memory_type_ { 0 };
+		STRATEGY		strategy_ { STRATEGY::FREE_LIST };
+		bool			dedicated_ { false };
+		VkDeviceSize	used_ { 0 };
+
+		// LINEAR
+		VkDeviceSize	head_ { 0 };
+		TILING			last_tiling_ { TILING::LINEAR };
+
+		// FREE_LIST
+		std::map<VkDeviceSize , Range>	ranges_;
+	};
+
+	VkDeviceSize AlignUp ( VkDeviceSize value , VkDeviceSize alignment )
+	{
+		return alignment > 1 ? ( value + alignment - 1 ) / alignment * alignment : value;
+	}
+
+	// true if the last byte of one resource and the first byte of the next fall on the same granularity page
+	bool OnSamePage ( VkDeviceSize lastByte , VkDeviceSize nextStart , VkDeviceSize pageSize )
+	{
+		return pageSize > 1 && lastByte / pageSize == nextStart / pageSize;
+	}
+
+	bool LinearAllocate ( Block& block , VkDeviceSize size , VkDeviceSize alignment , TILING tiling , VkDeviceSize granularity , VkDeviceSize& offset )
+	{
+		VkDeviceSize start = AlignUp ( block.head_ , alignment );
+		if ( block.head_ > 0 && block.last_tiling_ != tiling && OnSamePage ( block.head_ - 1 , start , granularity ) )
+		{
+			start = AlignUp ( start , granularity );
+		}
+		if ( start + size > block.size_ )
+		{
+			return false;
+		}
+
+		block.head_ = start + size;
+		block.last_tiling_ = tiling;
+		block.used_ += size;
+		offset = start;
+		return true;
+	}
+
+	bool FreeListAllocate ( Block& block , VkDeviceSize size , VkDeviceSize alignment , TILING tiling , VkDeviceSize granularity , VkDeviceSize& offset )
+	{
+		auto& ranges = block.ranges_;
+		for ( auto it = ranges.begin (); it != ranges.end (); ++it )
+		{
+			if ( !it->second.free_ || it->second.size_ < size )
+			{
+				continue;
+			}
+
+			VkDeviceSize range_begin = it->first;
+			VkDeviceSize range_end = it->first + it->second.size_;
+			VkDeviceSize start = AlignUp ( range_begin , alignment );
+
+			// free neighbours are always merged, so a neighbour of a free range is in use
+			if ( it != ranges.begin () )
+			{
+				auto prev = std::prev ( it );
+				if ( prev->second.tiling_ != tiling && OnSamePage ( prev->first + prev->second.size_ - 1 , start , granularity ) )
+				{
+					start = AlignUp ( start , granularity );
+				}
+			}
+			if ( start + size > range_end )
+			{
+				continue;
+			}
+
+			auto next = std::next ( it );
+			if ( next != ranges.end () && next->second.tiling_ != tiling && OnSamePage ( start + size - 1 , next->first , granularity ) )
+			{
+				continue;
+			}
+
+			// split into leading padding, the allocation and the free tail
+			ranges.erase ( it );
+			if ( start > range_begin )
+			{
+				ranges[ range_begin ] = { start - range_begin , true , tiling };
+			}
+			ranges[ start ] = { size , false , tiling };
+			if ( range_end > start + size )
+			{
+				ranges[ start + size ] = { range_end - start - size , true , tiling };
+			}
+
+			block.used_ += size;
+			offset = start;
+			return true;
+		}
+		return false;
+	}
+
+	void FreeListFree ( Block& block , VkDeviceSize offset )
+	{
+		auto& ranges = block.ranges_;
+		auto it = ranges.find ( offset );
+		if ( it == ranges.end () || it->second.free_ )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::Free failed! Range at " , offset , " is not allocated." );
+			return;
+		}
+
+		block.used_ -= it->second.size_;
+		it->second.free_ = true;
+
+		// merge with the free neighbours so free ranges never touch
+		auto next = std::next ( it );
+		if ( next != ranges.end () && next->second.free_ )
+		{
+			it->second.size_ += next->second.size_;
+			ranges.erase ( next );
+		}
+		if ( it != ranges.begin () )
+		{
+			auto prev = std::prev ( it );
+			if ( prev->second.free_ )
+			{
+				prev->second.size_ += it->second.size_;
+				ranges.erase ( it );
+			}
+		}
+	}
+
+	// defined here, Block is only complete in this file
+	Allocator::Allocator () = default;
+	Allocator::~Allocator () = default;
+
+	bool Allocator::Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , Parameters const& params )
+	{
+		vkTrace::Zone zone ( "vkMemory::Allocator::Initialize" );
+
+		logical_device_ = logicalDevice;
+		memory_properties_ = profile.memory_properties_;
+		buffer_image_granularity_ = std::max<VkDeviceSize> ( profile.properties_.limits.bufferImageGranularity , 1 );
+		non_coherent_atom_size_ = std::max<VkDeviceSize> ( profile.properties_.limits.nonCoherentAtomSize , 1 );
+		max_allocation_count_ = profile.properties_.limits.maxMemoryAllocationCount;
+		allocation_count_ = 0;
+		block_size_ = params.block_size_;
+		return block_size_ > 0;
+	}
+
+	bool Allocator::Allocate ( VkMemoryRequirements const& requirements , VkMemoryPropertyFlags properties , TILING tiling , STRATEGY strategy , Allocation& allocation )
+	{
+		std::lock_guard<std::mutex> lock ( mutex_ );
+
+		// first memory type allowed by the resource that has every requested property
+		uint32_t memory_type = memory_properties_.memoryTypeCount;
+		for ( uint32_t i = 0; i < memory_properties_.memoryTypeCount; ++i )
+		{
+			if ( ( requirements.memoryTypeBits & ( 1u << i ) ) && ( memory_properties_.memoryTypes[ i ].propertyFlags & properties ) == properties )
+			{
+				memory_type = i;
+				break;
+			}
+		}
+		if ( memory_type == memory_properties_.memoryTypeCount )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::Allocate failed! No memory type with the requested properties." );
+			return false;
+		}
+
+		// non coherent ranges are flushed in whole atoms, keep neighbours out of each other's atoms
+		VkDeviceSize alignment = std::max<VkDeviceSize> ( requirements.alignment , 1 );
+		VkDeviceSize size = requirements.size;
+		VkMemoryPropertyFlags type_flags = memory_properties_.memoryTypes[ memory_type ].propertyFlags;
+		if ( ( type_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ) && !( type_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT ) )
+		{
+			alignment = std::max ( alignment , non_coherent_atom_size_ );
+			size = AlignUp ( size , non_coherent_atom_size_ );
+		}
+
+		Block* target { nullptr };
+		VkDeviceSize offset { 0 };
+		if ( size > block_size_ )
+		{
+			target = NewBlock ( memory_type , strategy , size , true );
+			offset = 0;
+		}
+		else
+		{
+			for ( auto const& block : blocks_ )
+			{
+				if ( block->dedicated_ || block->memory_type_ != memory_type || block->strategy_ != strategy )
+				{
+					continue;
+				}
+				bool placed = strategy == STRATEGY::LINEAR ?
+					LinearAllocate ( *block , size , alignment , tiling , buffer_image_granularity_ , offset ) :
+					FreeListAllocate ( *block , size , alignment , tiling , buffer_image_granularity_ , offset );
+				if ( placed )
+				{
+					target = block.get ();
+					break;
+				}
+			}
+
+			// every block of this type is full, start a new one, or a dedicated one if a full block does not fit
+			if ( target == nullptr )
+			{
+				Block* block = NewBlock ( memory_type , strategy , block_size_ , false );
+				if ( block == nullptr )
+				{
+					target = NewBlock ( memory_type , strategy , size , true );
+					offset = 0;
+				}
+				else
+				{
+					bool placed = strategy == STRATEGY::LINEAR ?
+						LinearAllocate ( *block , size , alignment , tiling , buffer_image_granularity_ , offset ) :
+						FreeListAllocate ( *block , size , alignment , tiling , buffer_image_granularity_ , offset );
+					target = placed ? block : nullptr;
+				}
+			}
+		}
+
+		if ( target == nullptr )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::Allocate failed! Failed to place " , size , " bytes." );
+			return false;
+		}
+
+		if ( target->dedicated_ )
+		{
+			target->used_ = size;
+		}
+
+		allocation.memory_ = target->memory_;
+		allocation.offset_ = offset;
+		allocation.size_ = size;
+		allocation.mapped_ = target->mapped_ ? static_cast< char* >( target->mapped_ ) + offset : nullptr;
+		allocation.block_ = target;
+		return true;
+	}
+
+	void Allocator::Free ( Allocation& allocation )
+	{
+		if ( allocation.block_ == nullptr )
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock ( mutex_ );
+		Block* block = allocation.block_;
+		if ( block->dedicated_ )
+		{
+			ReleaseBlock ( block );
+		}
+		else if ( block->strategy_ == STRATEGY::FREE_LIST )
+		{
+			FreeListFree ( *block , allocation.offset_ );
+		}
+		// LINEAR, the space comes back on ResetLinear
+
+		allocation = Allocation {};
+	}
+
+	void Allocator::ResetLinear ()
+	{
+		std::lock_guard<std::mutex> lock ( mutex_ );
+		for ( auto const& block : blocks_ )
+		{
+			if ( block->strategy_ == STRATEGY::LINEAR && !block->dedicated_ )
+			{
+				block->head_ = 0;
+				block->used_ = 0;
+			}
+		}
+	}
+
+	bool Allocator::CreateBuffer ( VkBufferCreateInfo const& createInfo , VkMemoryPropertyFlags properties , STRATEGY strategy , VkBuffer& buffer , Allocation& allocation )
+	{
+		if ( vkCreateBuffer ( logical_device_ , &createInfo , nullptr , &buffer ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::CreateBuffer failed! Failed to create buffer." );
+			return false;
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements ( logical_device_ , buffer , &requirements );
+
+		if ( !Allocate ( requirements , properties , TILING::LINEAR , strategy , allocation ) ||
+			vkBindBufferMemory ( logical_device_ , buffer , allocation.memory_ , allocation.offset_ ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::CreateBuffer failed! Failed to bind buffer memory." );
+			DestroyBuffer ( buffer , allocation );
+			return false;
+		}
+		return true;
+	}
+
+	void Allocator::DestroyBuffer ( VkBuffer& buffer , Allocation& allocation )
+	{
+		vkDestroyBuffer ( logical_device_ , buffer , nullptr );
+		buffer = VK_NULL_HANDLE;
+		Free ( allocation );
+	}
+
+	bool Allocator::CreateImage ( VkImageCreateInfo const& createInfo , VkMemoryPropertyFlags properties , STRATEGY strategy , VkImage& image , Allocation& allocation )
+	{
+		if ( vkCreateImage ( logical_device_ , &createInfo , nullptr , &image ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::CreateImage failed! Failed to create image." );
+			return false;
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements ( logical_device_ , image , &requirements );
+
+		TILING tiling = createInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? TILING::OPTIMAL : TILING::LINEAR;
+		if ( !Allocate ( requirements , properties , tiling , strategy , allocation ) ||
+			vkBindImageMemory ( logical_device_ , image , allocation.memory_ , allocation.offset_ ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::CreateImage failed! Failed to bind image memory." );
+			DestroyImage ( image , allocation );
+			return false;
+		}
+		return true;
+	}
+
+	void Allocator::DestroyImage ( VkImage& image , Allocation& allocation )
+	{
+		vkDestroyImage ( logical_device_ , image , nullptr );
+		image = VK_NULL_HANDLE;
+		Free ( allocation );
+	}
+
+	void Allocator::Report ( std::ostream& out )
+	{
+		std::lock_guard<std::mutex> lock ( mutex_ );
+
+		out << "### Device memory (" << allocation_count_ << " of " << max_allocation_count_ << " allocations, peak "
+			<< peak_reserved_ / 1024 << " KiB reserved):\n";
+		for ( uint32_t type = 0; type < memory_properties_.memoryTypeCount; ++type )
+		{
+			size_t block_count { 0 };
+			VkDeviceSize reserved { 0 } , used { 0 };
+			for ( auto const& block : blocks_ )
+			{
+				if ( block->memory_type_ == type )
+				{
+					++block_count;
+					reserved += block->size_;
+					used += block->used_;
+				}
+			}
+			if ( block_count > 0 )
+			{
+				out << "\t- type " << type << "\t" << block_count << " blocks\t"
+					<< reserved / 1024 << " KiB reserved\t" << used / 1024 << " KiB used\n";
+			}
+		}
+		out.flush ();
+	}
+
+	VkDeviceSize Allocator::PeakReserved ()
+	{
+		std::lock_guard<std::mutex> lock ( mutex_ );
+		return peak_reserved_;
+	}
+
+	void Allocator::Destroy ()
+	{
+		std::lock_guard<std::mutex> lock ( mutex_ );
+		for ( auto const& block : blocks_ )
+		{
+			vkFreeMemory ( logical_device_ , block->memory_ , nullptr );
+		}
+		blocks_.clear ();
+		allocation_count_ = 0;
+		reserved_ = 0;
+	}
+
+	Block* Allocator::NewBlock ( uint32_t memoryType , STRATEGY strategy , VkDeviceSize size , bool dedicated )
+	{
+		if ( max_allocation_count_ > 0 && allocation_count_ >= max_allocation_count_ )
+		{
+			VKLOG_FAILURE ( "### vkMemory::Allocator::NewBlock failed! maxMemoryAllocationCount reached." );
+			return nullptr;
+		}
+
+		auto block = std::make_unique<Block> ();
+		block->size_ = size;
+		block->memory_type_ = memoryType;
+		block->strategy_ = strategy;
+		block->dedicated_ = dedicated;
+		block->ranges_[ 0 ] = { size , true , TILING::LINEAR };
+
+		VkMemoryAllocateInfo allocInfo {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		if ( vkAllocateMemory ( logical_device_ , &allocInfo , nullptr , &block->memory_ ) != VK_SUCCESS )
+		{
+			return nullptr;
+		}
+		++allocation_count_;
+		reserved_ += size;
+		peak_reserved_ = std::max ( peak_reserved_ , reserved_ );
+
+		// host visible blocks are mapped once, allocations hand out pointers into the mapping
+		if ( memory_properties_.memoryTypes[ memoryType ].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT )
+		{
+			if ( vkMapMemory ( logical_device_ , block->memory_ , 0 , VK_WHOLE_SIZE , 0 , &block->mapped_ ) != VK_SUCCESS )
+			{
+				block->mapped_ = nullptr;
+			}
+		}
+
+		blocks_.push_back ( std::move ( block ) );
+		return blocks_.back ().get ();
+	}
+
+	void Allocator::ReleaseBlock ( Block* block )
+	{
+		auto it = std::find_if ( blocks_.begin () , blocks_.end () , [ block ] ( std::unique_ptr<Block> const& b ) { return b.get () == block; } );
+		if ( it == blocks_.end () )
+		{
+			return;
+		}
+		vkFreeMemory ( logical_device_ , block->memory_ , nullptr );
+		--allocation_count_;
+		reserved_ -= block->size_;
+		blocks_.erase ( it );
+	}
+}
@@ -0,0 +1,114 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace vkMemory
+{
+	/*!
+	 * @brief how a block hands out its memory
+	 *		LINEAR bumps a head pointer, frees are no-ops until the blocks are Reset as a whole
+	 *		FREE_LIST keeps sorted free ranges, frees merge with their free neighbours
+	*/
+	enum class STRATEGY
+	{
+		LINEAR ,
+		FREE_LIST
+	};
+
+	/*!
+	 * @brief linear resources (buffers, linear images) and optimal images may not share a
+	 *		bufferImageGranularity page
+	*/
+	enum class TILING
+	{
+		LINEAR ,
+		OPTIMAL
+	};
+
+	struct Block;
+
+	/*!
+	 * @brief a sub range of a block, host visible memory stays mapped for the block's lifetime
+	*/
+	struct Allocation
+	{
+		VkDeviceMemory	memory_ { VK_NULL_HANDLE };
+		VkDeviceSize	offset_ { 0 };
+		VkDeviceSize	size_ { 0 };
+		void*			mapped_ { nullptr };
+		Block*			block_ { nullptr };
+	};
+
+	/*!
+	 * @brief takes large VkDeviceMemory blocks per memory type and strategy and sub allocates from them,
+	 *		requests larger than a block get a dedicated block of their own
+	*/
+	struct Allocator
+	{
+		struct Parameters
+		{
+			VkDeviceSize block_size_ { 64ull * 1024 * 1024 };
+		};
+
+		Allocator ();
+		~Allocator ();
+
+		bool Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , Parameters const& params );
+
+		bool Allocate ( VkMemoryRequirements const& requirements , VkMemoryPropertyFlags properties , TILING tiling , STRATEGY strategy , Allocation& allocation );
+
+		void Free ( Allocation& allocation );
+
+		/*!
+		 * @brief rewinds every LINEAR block, allocations made from them must no longer be in use
+		*/
+		void ResetLinear ();
+
+		bool CreateBuffer ( VkBufferCreateInfo const& createInfo , VkMemoryPropertyFlags properties , STRATEGY strategy , VkBuffer& buffer , Allocation& allocation );
+
+		void DestroyBuffer ( VkBuffer& buffer , Allocation& allocation );
+
+		bool CreateImage ( VkImageCreateInfo const& createInfo , VkMemoryPropertyFlags properties , STRATEGY strategy , VkImage& image , Allocation& allocation );
+
+		void DestroyImage ( VkImage& image , Allocation& allocation );
+
+		/*!
+		 * @brief prints block count, reserved and used bytes per memory type
+		*/
+		void Report ( std::ostream& out );
+
+		/*!
+		 * @brief most device memory held in blocks at any one time since Initialize, in bytes
+		*/
+		VkDeviceSize PeakReserved ();
+
+		void Destroy ();
+
+	private:
+		Block*		NewBlock ( uint32_t memoryType , STRATEGY strategy , VkDeviceSize size , bool dedicated );
+
+		void		ReleaseBlock ( Block* block );
+
+		VkDevice								logical_device_ { VK_NULL_HANDLE };
+		VkPhysicalDeviceMemoryProperties		memory_properties_ {};
+		VkDeviceSize							buffer_image_granularity_ { 1 };
+		VkDeviceSize							non_coherent_atom_size_ { 1 };
+		uint32_t								max_allocation_count_ { 0 };
+		uint32_t								allocation_count_ { 0 };
+		VkDeviceSize							block_size_ { 0 };
+		VkDeviceSize							reserved_ { 0 };
+		VkDeviceSize							peak_reserved_ { 0 };
+		std::vector<std::unique_ptr<Block>>		blocks_;
+		std::mutex								mutex_;
+	};
+}
@@ -0,0 +1,165 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkMesh.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace vkMesh
+{
+	bool InstancedMesh::Initialize ( vkMemory::Allocator& allocator , vkTransfer::StagingRing& stagingRing , std::vector<vkHelper::vkVertex> const& vertices ,
+		std::vector<uint16_t> const& indices , uint32_t instanceCapacity )
+	{
+		vkTrace::Zone zone ( "vkMesh::InstancedMesh::Initialize" );
+
+		allocator_ = &allocator;
+		staging_ring_ = &stagingRing;
+
+		VkBufferCreateInfo bufferInfo {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = sizeof ( vkHelper::vkVertex ) * vertices.size ();
+		bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , vertex_buffer_ , vertex_allocation_ ) )
+		{
+			VKLOG_FAILURE ( "### vkMesh::InstancedMesh::Initialize failed! Failed to create vertex buffer." );
+			return false;
+		}
+		if ( !stagingRing.UploadBuffer ( vertices.data () , bufferInfo.size , vertex_buffer_ , 0 , VK_PIPELINE_STAGE_VERTEX_INPUT_BIT , VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT ) )
+		{
+			return false;
+		}
+
+		bufferInfo.size = sizeof ( uint16_t ) * indices.size ();
+		bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , index_buffer_ , index_allocation_ ) )
+		{
+			VKLOG_FAILURE ( "### vkMesh::InstancedMesh::Initialize failed! Failed to create index buffer." );
+			return false;
+		}
+		if ( !stagingRing.UploadBuffer ( indices.data () , bufferInfo.size , index_buffer_ , 0 , VK_PIPELINE_STAGE_VERTEX_INPUT_BIT , VK_ACCESS_INDEX_READ_BIT ) )
+		{
+			return false;
+		}
+
+		if ( !CreateInstanceBuffer ( std::max ( instanceCapacity , 1u ) ) )
+		{
+			return false;
+		}
+
+		draw_.vertex_buffer_ = vertex_buffer_;
+		draw_.vertex_count_ = static_cast< uint32_t >( vertices.size () );
+		draw_.index_buffer_ = index_buffer_;
+		draw_.index_count_ = static_cast< uint32_t >( indices.size () );
+		draw_.instance_count_ = 0;
+
+		return stagingRing.Flush ();
+	}
+
+	bool InstancedMesh::SetInstances ( std::vector<vkHelper::vkInstance> const& instances )
+	{
+		uint32_t count = static_cast< uint32_t >( instances.size () );
+		if ( count > instance_capacity_ )
+		{
+			allocator_->DestroyBuffer ( instance_buffer_ , instance_allocation_ );
+			if ( !CreateInstanceBuffer ( count ) )
+			{
+				return false;
+			}
+		}
+
+		if ( count > 0 && !staging_ring_->UploadBuffer ( instances.data () , sizeof ( vkHelper::vkInstance ) * count , instance_buffer_ , 0 ,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT , VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT ) )
+		{
+			return false;
+		}
+		draw_.instance_count_ = count;
+
+		return staging_ring_->Flush ();
+	}
+
+	void InstancedMesh::Destroy ()
+	{
+		if ( allocator_ )
+		{
+			allocator_->DestroyBuffer ( instance_buffer_ , instance_allocation_ );
+			allocator_->DestroyBuffer ( index_buffer_ , index_allocation_ );
+			allocator_->DestroyBuffer ( vertex_buffer_ , vertex_allocation_ );
+		}
+		instance_capacity_ = 0;
+		draw_ = {};
+	}
+
+	bool InstancedMesh::CreateInstanceBuffer ( uint32_t instanceCapacity )
+	{
+		VkBufferCreateInfo bufferInfo {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = sizeof ( vkHelper::vkInstance ) * instanceCapacity;
+		bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if ( !allocator_->CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , instance_buffer_ , instance_allocation_ ) )
+		{
+			VKLOG_FAILURE ( "### vkMesh::InstancedMesh::CreateInstanceBuffer failed! Failed to create instance buffer of " , instanceCapacity , " instances." );
+			instance_capacity_ = 0;
+			draw_.instance_buffer_ = VK_NULL_HANDLE;
+			return false;
+		}
+		instance_capacity_ = instanceCapacity;
+		draw_.instance_buffer_ = instance_buffer_;
+		return true;
+	}
+
+	std::vector<vkHelper::vkVertex> TriangleVertices ()
+	{
+		return {
+			{ {  0.0f , -0.5f } , { 1.0f , 0.0f , 0.0f } },
+			{ {  0.5f ,  0.5f } , { 0.0f , 1.0f , 0.0f } },
+			{ { -0.5f ,  0.5f } , { 0.0f , 0.0f , 1.0f } }
+		};
+	}
+
+	std::vector<uint16_t> TriangleIndices ()
+	{
+		return { 0 , 1 , 2 };
+	}
+
+	std::vector<vkHelper::vkInstance> GridInstances ( uint32_t count , float extent )
+	{
+		std::vector<vkHelper::vkInstance> instances ( count );
+		uint32_t side = std::max ( static_cast< uint32_t >( std::ceil ( std::sqrt ( static_cast< double >( count ) ) ) ) , 1u );
+		float cell = 2.0f * extent / static_cast< float >( side );
+
+		for ( uint32_t i = 0; i < count; ++i )
+		{
+			uint32_t x = i % side;
+			uint32_t y = i / side;
+			float u = static_cast< float >( x ) / static_cast< float >( side );
+			float v = static_cast< float >( y ) / static_cast< float >( side );
+
+			vkHelper::vkInstance& instance = instances[ i ];
+			instance.transform_[ 0 ] = -extent + cell * ( static_cast< float >( x ) + 0.5f );
+			instance.transform_[ 1 ] = -extent + cell * ( static_cast< float >( y ) + 0.5f );
+			instance.transform_[ 2 ] = cell;
+			instance.transform_[ 3 ] = 6.2831853f * u * v;
+			instance.color_[ 0 ] = 0.5f + 0.5f * u;
+			instance.color_[ 1 ] = 0.5f + 0.5f * v;
+			instance.color_[ 2 ] = 1.0f;
+			instance.color_[ 3 ] = 1.0f;
+		}
+		return instances;
+	}
+
+	vkHelper::vkDrawConstants FadedDrawConstants ( uint32_t draw , uint32_t drawCount )
+	{
+		float fade = 1.0f - 0.5f * static_cast< float >( draw ) / static_cast< float >( std::max ( drawCount , 1u ) );
+		return { { 0.0f , 0.0f } , fade , 0.0f , { fade , fade , fade , 1.0f } };
+	}
+}
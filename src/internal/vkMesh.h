@@ -0,0 +1,73 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+#include "vkMemory.h"
+#include "vkTransfer.h"
+
+#include <vector>
+
+namespace vkMesh
+{
+	/*!
+	 * @brief a device local vertex, index and instance buffer, all filled through the staging ring,
+	 *		drawn with one instanced draw call per vkDrawData
+	 *		the instance buffer is also a storage buffer, e.g. for culling the instances on the gpu
+	*/
+	struct InstancedMesh
+	{
+		bool Initialize ( vkMemory::Allocator& allocator , vkTransfer::StagingRing& stagingRing , std::vector<vkHelper::vkVertex> const& vertices ,
+			std::vector<uint16_t> const& indices , uint32_t instanceCapacity );
+
+		/*!
+		 * @brief uploads the instances, growing the instance buffer if they do not fit
+		 *		the device must be done reading the previous instances, e.g. after vkDeviceWaitIdle
+		*/
+		bool SetInstances ( std::vector<vkHelper::vkInstance> const& instances );
+
+		vkHelper::vkDrawData const& DrawData () const
+		{
+			return draw_;
+		}
+
+		void Destroy ();
+
+	private:
+		bool CreateInstanceBuffer ( uint32_t instanceCapacity );
+
+		vkMemory::Allocator*		allocator_ { nullptr };
+		vkTransfer::StagingRing*	staging_ring_ { nullptr };
+
+		VkBuffer					vertex_buffer_ { VK_NULL_HANDLE };
+		vkMemory::Allocation		vertex_allocation_;
+		VkBuffer					index_buffer_ { VK_NULL_HANDLE };
+		vkMemory::Allocation		index_allocation_;
+		VkBuffer					instance_buffer_ { VK_NULL_HANDLE };
+		vkMemory::Allocation		instance_allocation_;
+		uint32_t					instance_capacity_ { 0 };
+
+		vkHelper::vkDrawData		draw_;
+	};
+
+	/*!
+	 * @brief the built in triangle as vertices and indices
+	*/
+	std::vector<vkHelper::vkVertex>		TriangleVertices ();
+
+	std::vector<uint16_t>				TriangleIndices ();
+
+	/*!
+	 * @brief count instances laid out on a square grid over [-extent, extent] in clip space, scaled to fit their cell
+	 *		an extent above 1 puts part of the grid off screen
+	*/
+	std::vector<vkHelper::vkInstance>	GridInstances ( uint32_t count , float extent = 1.0f );
+
+	/*!
+	 * @brief constants of draw out of drawCount draws of the same instances, each a little smaller and darker
+	*/
+	vkHelper::vkDrawConstants			FadedDrawConstants ( uint32_t draw , uint32_t drawCount );
+}
@@ -0,0 +1,206 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkPerf.h"
+#include "vkLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace vkPerf
+{
+	struct Baseline
+	{
+		std::string											device_;
+		std::vector<std::pair<std::string , std::vector<double>>>	metrics_;
+
+		std::vector<double>* Find ( std::string const& name )
+		{
+			for ( auto& metric : metrics_ )
+			{
+				if ( metric.first == name )
+				{
+					return &metric.second;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	static char const* DEVICE_KEY { "device " };
+
+	static bool Load ( std::string const& filename , Baseline& baseline )
+	{
+		std::ifstream file ( filename );
+		if ( !file.is_open () )
+		{
+			return false;
+		}
+
+		std::string line;
+		while ( std::getline ( file , line ) )
+		{
+			if ( line.empty () || line[ 0 ] == '#' )
+			{
+				continue;
+			}
+			if ( line.compare ( 0 , std::strlen ( DEVICE_KEY ) , DEVICE_KEY ) == 0 )
+			{
+				baseline.device_ = line.substr ( std::strlen ( DEVICE_KEY ) );
+				continue;
+			}
+
+			std::istringstream fields ( line );
+			std::string name;
+			fields >> name;
+			std::vector<double> values;
+			for ( double value; fields >> value; )
+			{
+				values.push_back ( value );
+			}
+			if ( !values.empty () )
+			{
+				baseline.metrics_.emplace_back ( name , std::move ( values ) );
+			}
+		}
+		return true;
+	}
+
+	static double Median ( std::vector<double> values )
+	{
+		std::sort ( values.begin () , values.end () );
+		size_t half = values.size () / 2;
+		return values.size () % 2 ? values[ half ] : 0.5 * ( values[ half - 1 ] + values[ half ] );
+	}
+
+	bool HasBaseline ( std::string const& filename )
+	{
+		Baseline baseline;
+		return Load ( filename , baseline ) && !baseline.metrics_.empty ();
+	}
+
+	void Suite::Add ( std::string const& name , double ms )
+	{
+		metrics_.emplace_back ( name , ms );
+	}
+
+	bool Suite::Record ( std::string const& filename , std::string const& device , Parameters const& params ) const
+	{
+		Baseline baseline;
+		if ( Load ( filename , baseline ) && !baseline.device_.empty () && baseline.device_ != device )
+		{
+			VKLOG_FAILURE ( "### vkPerf::Suite::Record failed! " , filename , " was recorded on " , baseline.device_ , ", not " , device , "." );
+			return false;
+		}
+		baseline.device_ = device;
+
+		for ( auto const& metric : metrics_ )
+		{
+			std::vector<double>* values = baseline.Find ( metric.first );
+			if ( values == nullptr )
+			{
+				baseline.metrics_.emplace_back ( metric.first , std::vector<double> {} );
+				values = &baseline.metrics_.back ().second;
+			}
+			values->push_back ( metric.second );
+			if ( values->size () > params.history_ )
+			{
+				values->erase ( values->begin () , values->end () - params.history_ );
+			}
+		}
+
+		std::ofstream file ( filename , std::ios::trunc );
+		file << "# vkPerf baseline, ms from each recorded run, oldest first\n";
+		file << DEVICE_KEY << baseline.device_ << "\n";
+		for ( auto const& metric : baseline.metrics_ )
+		{
+			file << metric.first;
+			for ( double value : metric.second )
+			{
+				file << " " << value;
+			}
+			file << "\n";
+		}
+		if ( !file )
+		{
+			VKLOG_FAILURE ( "### vkPerf::Suite::Record failed! Failed to write " , filename , "." );
+			return false;
+		}
+		VKLOG_INFO ( "### Perf: " , metrics_.size () , " metrics recorded to " , filename );
+		return true;
+	}
+
+	bool Suite::Compare ( std::string const& filename , std::string const& device , Parameters const& params , std::ostream& out ) const
+	{
+		Baseline baseline;
+		if ( !Load ( filename , baseline ) )
+		{
+			VKLOG_FAILURE ( "### vkPerf::Suite::Compare failed! No baseline at " , filename , "." );
+			return false;
+		}
+		if ( baseline.device_ != device )
+		{
+			// another device's times say nothing about this one
+			VKLOG_FAILURE ( "### vkPerf::Suite::Compare failed! " , filename , " was recorded on " , baseline.device_ , ", not " , device , "." );
+			return false;
+		}
+
+		uint32_t regressed { 0 };
+		uint32_t unusable { 0 };
+		out << "### Perf gate against " << filename << ":\n";
+		for ( auto const& metric : metrics_ )
+		{
+			std::vector<double>* values = baseline.Find ( metric.first );
+			if ( values == nullptr )
+			{
+				++unusable;
+				out << "\t- " << metric.first << "\t" << metric.second << " ms\tnot in the baseline\n";
+				continue;
+			}
+			if ( values->size () < params.min_runs_ )
+			{
+				// the deviation of one or two runs is no noise estimate
+				++unusable;
+				out << "\t- " << metric.first << "\t" << metric.second << " ms\t" << values->size () << " of " << params.min_runs_ << " runs recorded\n";
+				continue;
+			}
+
+			// median absolute deviation, scaled to a standard deviation for normal noise, one slow run does not widen it
+			double median = Median ( *values );
+			std::vector<double> deviations;
+			for ( double value : *values )
+			{
+				deviations.push_back ( std::fabs ( value - median ) );
+			}
+			double sigma = 1.4826 * Median ( deviations );
+			double margin = std::max ( { params.noise_sigmas_ * sigma , params.min_relative_ * median , params.min_absolute_ms_ } );
+
+			bool slower = metric.second > median + margin;
+			bool faster = metric.second < median - margin;
+			regressed += slower;
+			out << "\t- " << metric.first << "\t" << metric.second << " ms\tbaseline " << median << " +- " << margin << " ms"
+				<< ( slower ? "\tREGRESSED" : faster ? "\tfaster, record a new baseline" : "" ) << "\n";
+		}
+		for ( auto const& metric : baseline.metrics_ )
+		{
+			bool measured = std::any_of ( metrics_.begin () , metrics_.end () , [ &metric ] ( std::pair<std::string , double> const& m ) { return m.first == metric.first; } );
+			if ( !measured )
+			{
+				out << "\t- " << metric.first << "\tnot measured this run\n";
+			}
+		}
+		if ( unusable > 0 || metrics_.empty () )
+		{
+			out << "### Perf gate: baseline unusable, " << unusable << " metrics lack " << params.min_runs_ << " recorded runs, add runs with -perf-record." << std::endl;
+			return false;
+		}
+		out << "### Perf gate: " << ( regressed ? std::to_string ( regressed ) + " metrics regressed." : std::string ( "passed." ) ) << std::endl;
+		return regressed == 0;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include <vector>
+#include <string>
+#include <utility>
+#include <ostream>
+#include <cstdint>
+
+namespace vkPerf
+{
+	/*!
+	 * @brief a metric regresses when it is above the baseline median by more than the largest of
+	 *		noise_sigmas_ robust deviations of the recorded runs, min_relative_ of the median and min_absolute_ms_
+	*/
+	struct Parameters
+	{
+		double		noise_sigmas_ { 4.0 };
+		double		min_relative_ { 0.10 };
+		double		min_absolute_ms_ { 0.1 };
+		uint32_t	history_ { 10 };			// recorded runs kept per metric, oldest dropped first
+		uint32_t	min_runs_ { 3 };			// recorded runs a metric needs before it is gated on
+	};
+
+	/*!
+	 * @brief true if filename holds a baseline with at least one metric, whatever device it was recorded on
+	*/
+	bool HasBaseline ( std::string const& filename );
+
+	/*!
+	 * @brief the times of one run, each compared on its own against the runs recorded in a baseline file
+	 *		a baseline is plain text to check in, a device line and then one line per metric, its name and its value in ms from every recorded run
+	 *		a baseline is only compared on the device it was recorded on
+	*/
+	struct Suite
+	{
+		/*!
+		 * @brief one measurement of this run in ms, lower is better, name may not contain white space
+		*/
+		void Add ( std::string const& name , double ms );
+
+		/*!
+		 * @brief appends this run to the baseline, creating it, record a few runs before gating on it
+		*/
+		bool Record ( std::string const& filename , std::string const& device , Parameters const& params ) const;
+
+		/*!
+		 * @brief prints every metric against its threshold, false if any regressed or the baseline could not be used
+		 *		it cannot be used if a metric of this run is missing from it or has fewer than min_runs_ runs recorded,
+		 *		a gate that compared nothing does not pass
+		*/
+		bool Compare ( std::string const& filename , std::string const& device , Parameters const& params , std::ostream& out ) const;
+
+	private:
+		std::vector<std::pair<std::string , double>>	metrics_;
+	};
+}
@@ -0,0 +1,210 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkSimulation.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+
+namespace vkSimulation
+{
+	// push constants of shaders/simulate.comp
+	struct SimulationConstants
+	{
+		uint32_t	particle_count_;
+		float		dt_;
+		uint32_t	reset_;
+	};
+
+	// matches Particle of shaders/simulate.comp
+	struct Particle
+	{
+		float	position_[ 4 ];
+		float	velocity_[ 4 ];
+	};
+
+	static constexpr uint32_t SIMULATE_GROUP_SIZE { 64 };
+
+	bool ParticleSimulation::Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+		vkDescriptor::SetCache& staticSets , VkPipelineCache pipelineCache , VkRenderPass renderPass , uint32_t frameCount , Parameters const& params )
+	{
+		vkTrace::Zone zone ( "vkSimulation::ParticleSimulation::Initialize" );
+
+		logical_device_ = logicalDevice;
+		allocator_ = &allocator;
+		particle_count_ = std::max ( params.particle_count_ , 1u );
+		dt_ = params.dt_;
+		seeded_ = false;
+
+		// the position buffers change queue family every frame unless both queues share one
+		if ( profile.indices_.HasDedicatedCompute () )
+		{
+			compute_family_ = profile.indices_.compute_family_.value ();
+			graphics_family_ = profile.indices_.graphics_family_.value ();
+		}
+
+		std::vector<VkDescriptorSetLayoutBinding> bindings ( 2 );
+		for ( uint32_t i = 0; i < 2; ++i )
+		{
+			bindings[ i ].binding = i;
+			bindings[ i ].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[ i ].descriptorCount = 1;
+			bindings[ i ].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		if ( ( set_layout_ = layoutCache.Get ( bindings ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		if ( ( pipeline_ = vkHelper::Create::vkComputePipeline ( logicalDevice , "shaders/simulate_comp.spv" , { set_layout_ } , sizeof ( SimulationConstants ) , pipelineCache ) ).pipeline_ == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		vkHelper::vkPipelineState points_state;
+		points_state.cull_mode_ = VK_CULL_MODE_NONE;
+		points_state.topology_ = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+		points_state.vertex_shader_ = "shaders/particles_vert.spv";
+		points_state.position_stride_ = sizeof ( float ) * 4;
+		if ( ( points_pipeline_ = vkHelper::Create::vkGraphicsPipeline ( logicalDevice , renderPass , pipelineCache , false , {} , 0 , nullptr , points_state ) ).pipeline_ == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		VkBufferCreateInfo bufferInfo {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = sizeof ( Particle ) * particle_count_;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , particles_ , particles_allocation_ ) )
+		{
+			VKLOG_FAILURE ( "### vkSimulation::ParticleSimulation::Initialize failed! Failed to create particle buffer of " , particle_count_ , " particles." );
+			return false;
+		}
+
+		// positions per frame in flight, a frame's points are drawn while the next frame steps
+		bufferInfo.size = sizeof ( float ) * 4 * particle_count_;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		frames_.resize ( frameCount );
+		for ( auto& frame : frames_ )
+		{
+			if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT , vkMemory::STRATEGY::FREE_LIST , frame.positions_ , frame.positions_allocation_ ) )
+			{
+				VKLOG_FAILURE ( "### vkSimulation::ParticleSimulation::Initialize failed! Failed to create position buffer of " , particle_count_ , " particles." );
+				return false;
+			}
+			if ( ( frame.set_ = staticSets.Get ( set_layout_ , { { 0 , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , particles_ } , { 1 , VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , frame.positions_ } } ) ) == VK_NULL_HANDLE )
+			{
+				return false;
+			}
+		}
+
+		VKLOG_INFO ( "### Particle simulation: " , particle_count_ , " particles" ,
+			( compute_family_ != graphics_family_ ? ", positions transferred to the graphics queue family." : "." ) );
+		return true;
+	}
+
+	bool ParticleSimulation::Record ( VkCommandBuffer commandBuffer , size_t frame )
+	{
+		FrameData const& frame_data = frames_[ frame ];
+
+		// a step reads what the previous one wrote, the steps of consecutive frames are on the same queue
+		VkMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT , VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT , 0 , 1 , &barrier , 0 , nullptr , 0 , nullptr );
+
+		SimulationConstants constants {};
+		constants.particle_count_ = particle_count_;
+		constants.dt_ = dt_;
+		constants.reset_ = seeded_ ? 0 : 1;
+		seeded_ = true;
+
+		vkCmdBindPipeline ( commandBuffer , VK_PIPELINE_BIND_POINT_COMPUTE , pipeline_.pipeline_ );
+		vkCmdBindDescriptorSets ( commandBuffer , VK_PIPELINE_BIND_POINT_COMPUTE , pipeline_.layout_ , 0 , 1 , &frame_data.set_ , 0 , nullptr );
+		vkCmdPushConstants ( commandBuffer , pipeline_.layout_ , VK_SHADER_STAGE_COMPUTE_BIT , 0 , sizeof ( SimulationConstants ) , &constants );
+		vkCmdDispatch ( commandBuffer , ( particle_count_ + SIMULATE_GROUP_SIZE - 1 ) / SIMULATE_GROUP_SIZE , 1 , 1 );
+
+		// on a shared family the semaphore the frame waits on already makes the writes visible
+		if ( compute_family_ == graphics_family_ )
+		{
+			return true;
+		}
+
+		// release half of the transfer, Acquire records the other half on graphics
+		VkBufferMemoryBarrier release {};
+		release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		release.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		release.dstAccessMask = 0;
+		release.srcQueueFamilyIndex = compute_family_;
+		release.dstQueueFamilyIndex = graphics_family_;
+		release.buffer = frame_data.positions_;
+		release.offset = 0;
+		release.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT , VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT , 0 , 0 , nullptr , 1 , &release , 0 , nullptr );
+		return true;
+	}
+
+	void ParticleSimulation::Acquire ( VkCommandBuffer commandBuffer , size_t frame ) const
+	{
+		if ( compute_family_ == graphics_family_ )
+		{
+			return;
+		}
+
+		// starts at the stage the frame waits on the compute semaphore, so it runs after the release
+		VkBufferMemoryBarrier acquire {};
+		acquire.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		acquire.srcAccessMask = 0;
+		acquire.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		acquire.srcQueueFamilyIndex = compute_family_;
+		acquire.dstQueueFamilyIndex = graphics_family_;
+		acquire.buffer = frames_[ frame ].positions_;
+		acquire.offset = 0;
+		acquire.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier ( commandBuffer , VK_PIPELINE_STAGE_VERTEX_INPUT_BIT , VK_PIPELINE_STAGE_VERTEX_INPUT_BIT , 0 , 0 , nullptr , 1 , &acquire , 0 , nullptr );
+	}
+
+	void ParticleSimulation::Draw ( VkCommandBuffer commandBuffer , size_t frame ) const
+	{
+		VkDeviceSize offset { 0 };
+		vkCmdBindPipeline ( commandBuffer , VK_PIPELINE_BIND_POINT_GRAPHICS , points_pipeline_.pipeline_ );
+		vkCmdBindVertexBuffers ( commandBuffer , 0 , 1 , &frames_[ frame ].positions_ , &offset );
+		vkCmdDraw ( commandBuffer , particle_count_ , 1 , 0 , 0 );
+	}
+
+	void ParticleSimulation::Rebind ( VkRenderPass renderPass )
+	{
+		if ( points_pipeline_.pipeline_ == VK_NULL_HANDLE )
+		{
+			return;
+		}
+		vkHelper::Misc::RebuildPipeline ( logical_device_ , renderPass , points_pipeline_ );
+	}
+
+	void ParticleSimulation::Destroy ()
+	{
+		if ( logical_device_ == VK_NULL_HANDLE )
+		{
+			return;
+		}
+
+		for ( auto& frame : frames_ )
+		{
+			allocator_->DestroyBuffer ( frame.positions_ , frame.positions_allocation_ );
+		}
+		frames_.clear ();
+
+		allocator_->DestroyBuffer ( particles_ , particles_allocation_ );
+		vkHelper::Misc::DestroyPipeline ( logical_device_ , pipeline_ );
+		vkHelper::Misc::DestroyPipeline ( logical_device_ , points_pipeline_ );
+		set_layout_ = VK_NULL_HANDLE;
+		logical_device_ = VK_NULL_HANDLE;
+	}
+}
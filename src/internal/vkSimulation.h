@@ -0,0 +1,83 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+#include "vkMemory.h"
+#include "vkDescriptor.h"
+
+#include <vector>
+
+namespace vkSimulation
+{
+	/*!
+	 * @brief a particle simulation stepped by a compute shader, a workload for the async compute queue
+	 *		the particles live on the compute queue family only, every step also writes their positions into the frame slot's buffer
+	 *		that buffer is released to the graphics queue family and drawn as points in the frame's render pass,
+	 *		it is not handed back, the step of the slot's next frame overwrites all of it once the slot's fence signaled
+	*/
+	struct ParticleSimulation
+	{
+		struct Parameters
+		{
+			uint32_t	particle_count_ { 1 << 20 };
+			float		dt_ { 1.0f / 60.0f };
+		};
+
+		/*!
+		 * @brief the set layout comes from layoutCache and the sets from staticSets, both outlive the simulation
+		 *		the points are drawn in renderPass, frameCount position buffers are kept, one per frame slot
+		*/
+		bool Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+			vkDescriptor::SetCache& staticSets , VkPipelineCache pipelineCache , VkRenderPass renderPass , uint32_t frameCount , Parameters const& params );
+
+		/*!
+		 * @brief records one step into commandBuffer and releases frame's positions to graphics, fits vkAsyncComputeData::record_
+		 *		the first step seeds the particles
+		*/
+		bool Record ( VkCommandBuffer commandBuffer , size_t frame );
+
+		/*!
+		 * @brief acquires frame's positions on graphics, outside a render pass, fits vkAsyncComputeData::acquire_
+		*/
+		void Acquire ( VkCommandBuffer commandBuffer , size_t frame ) const;
+
+		/*!
+		 * @brief draws frame's positions as points, inside a render pass that set the viewport and scissor, fits vkAsyncComputeData::draw_
+		*/
+		void Draw ( VkCommandBuffer commandBuffer , size_t frame ) const;
+
+		/*!
+		 * @brief rebuilds the point pipeline for a recreated render pass, fits vkHelper::Misc::vkRenderPassChanged
+		*/
+		void Rebind ( VkRenderPass renderPass );
+
+		void Destroy ();
+
+	private:
+		struct FrameData
+		{
+			VkBuffer				positions_ { VK_NULL_HANDLE };
+			vkMemory::Allocation	positions_allocation_;
+			VkDescriptorSet			set_ { VK_NULL_HANDLE };		// owned by the static set cache
+		};
+
+		VkDevice					logical_device_ { VK_NULL_HANDLE };
+		vkMemory::Allocator*		allocator_ { nullptr };
+		vkHelper::vkPipelineData	pipeline_ {};
+		vkHelper::vkPipelineData	points_pipeline_ {};
+		VkDescriptorSetLayout		set_layout_ { VK_NULL_HANDLE };	// owned by the layout cache
+		uint32_t					compute_family_ { VK_QUEUE_FAMILY_IGNORED };	// both ignored on a shared family, no transfer needed
+		uint32_t					graphics_family_ { VK_QUEUE_FAMILY_IGNORED };
+
+		VkBuffer					particles_ { VK_NULL_HANDLE };
+		vkMemory::Allocation		particles_allocation_;
+		std::vector<FrameData>		frames_;
+		uint32_t					particle_count_ { 0 };
+		float						dt_ { 0.0f };
+		bool						seeded_ { false };
+	};
+}
@@ -0,0 +1,223 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkStartup.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <thread>
+#include <algorithm>
+
+namespace vkStartup
+{
+	Scheduler::Task Scheduler::Add ( char const* name , std::function<bool ()> job , std::vector<Task> const& dependencies , bool mainThread )
+	{
+		Task task = static_cast< Task >( nodes_.size () );
+		nodes_.emplace_back ();
+		Node& node = nodes_.back ();
+		node.name_ = name;
+		node.job_ = std::move ( job );
+		node.main_thread_ = mainThread;
+		for ( Task dependency : dependencies )
+		{
+			// only earlier tasks, the graph can not have a cycle
+			if ( dependency < task )
+			{
+				node.dependencies_.push_back ( dependency );
+				nodes_[ dependency ].dependents_.push_back ( task );
+			}
+		}
+		node.waiting_on_ = static_cast< uint32_t >( node.dependencies_.size () );
+		return task;
+	}
+
+	bool Scheduler::Run ( uint32_t threadCount )
+	{
+		auto start = std::chrono::high_resolution_clock::now ();
+
+		{
+			std::lock_guard<std::mutex> lock ( mutex_ );
+			remaining_ = static_cast< uint32_t >( nodes_.size () );
+			for ( Task task = 0; task < nodes_.size (); ++task )
+			{
+				if ( nodes_[ task ].waiting_on_ == 0 )
+				{
+					nodes_[ task ].state_ = STATE::READY;
+					ready_.push_back ( task );
+				}
+			}
+		}
+
+		thread_count_ = std::max ( threadCount , 1u );
+		std::vector<std::thread> workers;
+		for ( uint32_t i = 1; i < thread_count_; ++i )
+		{
+			workers.emplace_back ( &Scheduler::Work , this , false );
+		}
+		Work ( true );
+		for ( auto& worker : workers )
+		{
+			worker.join ();
+		}
+
+		wall_ms_ = std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - start ).count ();
+		return failed_ == UINT32_MAX;
+	}
+
+	char const* Scheduler::Failed () const
+	{
+		return failed_ == UINT32_MAX ? nullptr : nodes_[ failed_ ].name_;
+	}
+
+	bool Scheduler::Take ( bool mainThread , Task& task )
+	{
+		for ( auto it = ready_.begin (); it != ready_.end (); ++it )
+		{
+			if ( mainThread || !nodes_[ *it ].main_thread_ )
+			{
+				task = *it;
+				ready_.erase ( it );
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Scheduler::Finish ( Task task , bool succeeded )
+	{
+		Node& node = nodes_[ task ];
+		node.state_ = succeeded ? STATE::DONE : STATE::FAILED;
+		--remaining_;
+		if ( !succeeded && failed_ == UINT32_MAX )
+		{
+			failed_ = task;
+		}
+
+		for ( Task dependent : node.dependents_ )
+		{
+			Node& next = nodes_[ dependent ];
+			if ( next.state_ != STATE::WAITING )
+			{
+				continue;
+			}
+			if ( !succeeded )
+			{
+				// nothing can run on top of a failed step, skip down the whole chain
+				VKLOG_WARNING ( "### vkStartup::Scheduler skipped " , next.name_ , ", " , node.name_ , " failed." );
+				Finish ( dependent , false );
+				continue;
+			}
+			if ( --next.waiting_on_ == 0 )
+			{
+				next.state_ = STATE::READY;
+				ready_.push_back ( dependent );
+			}
+		}
+		if ( !succeeded )
+		{
+			node.state_ = task == failed_ ? STATE::FAILED : STATE::SKIPPED;
+		}
+	}
+
+	void Scheduler::Work ( bool mainThread )
+	{
+		if ( !mainThread )
+		{
+			vkTrace::NameThread ( "startup worker" );
+		}
+
+		std::unique_lock<std::mutex> lock ( mutex_ );
+		for ( ;;)
+		{
+			Task task { 0 };
+			bool taken { false };
+			changed_.wait ( lock , [ & ] () { return remaining_ == 0 || ( taken = Take ( mainThread , task ) ); } );
+			if ( !taken )
+			{
+				return;
+			}
+
+			Node& node = nodes_[ task ];
+			node.state_ = STATE::RUNNING;
+			lock.unlock ();
+
+			bool succeeded { false };
+			auto start = std::chrono::high_resolution_clock::now ();
+			{
+				vkTrace::Zone zone ( node.name_ );
+				succeeded = node.job_ ();
+			}
+			double ms = std::chrono::duration<double , std::milli> ( std::chrono::high_resolution_clock::now () - start ).count ();
+			if ( !succeeded )
+			{
+				VKLOG_FAILURE ( "### vkStartup::Scheduler " , node.name_ , " failed!" );
+			}
+
+			lock.lock ();
+			node.ms_ = ms;
+			Finish ( task , succeeded );
+			changed_.notify_all ();
+		}
+	}
+
+	void Scheduler::Report ( std::ostream& out ) const
+	{
+		// the longest chain by measured time is what no number of threads can shorten
+		std::vector<double> finish ( nodes_.size () , 0.0 );
+		std::vector<Task> previous ( nodes_.size () , UINT32_MAX );
+		double serial_ms { 0.0 } , critical_ms { 0.0 };
+		Task critical_end { UINT32_MAX };
+		for ( Task task = 0; task < nodes_.size (); ++task )
+		{
+			Node const& node = nodes_[ task ];
+			double start_ms { 0.0 };
+			for ( Task dependency : node.dependencies_ )
+			{
+				if ( finish[ dependency ] > start_ms )
+				{
+					start_ms = finish[ dependency ];
+					previous[ task ] = dependency;
+				}
+			}
+			finish[ task ] = start_ms + node.ms_;
+			serial_ms += node.ms_;
+			if ( finish[ task ] >= critical_ms )
+			{
+				critical_ms = finish[ task ];
+				critical_end = task;
+			}
+		}
+
+		out << "### Startup: " << nodes_.size () << " steps on " << thread_count_ << " threads, " << wall_ms_ << " ms wall against "
+			<< serial_ms << " ms one after the other";
+		if ( serial_ms > 0.0 )
+		{
+			out << " (" << 100.0 * ( 1.0 - wall_ms_ / serial_ms ) << "% shorter)";
+		}
+		out << ", critical path " << critical_ms << " ms:";
+
+		std::vector<Task> path;
+		for ( Task task = critical_end; task != UINT32_MAX; task = previous[ task ] )
+		{
+			path.push_back ( task );
+		}
+		for ( auto it = path.rbegin (); it != path.rend (); ++it )
+		{
+			out << ( it == path.rbegin () ? " " : " > " ) << nodes_[ *it ].name_;
+		}
+		out << std::endl;
+
+		for ( Node const& node : nodes_ )
+		{
+			out << "###\t" << node.name_ << ": " << node.ms_ << " ms";
+			if ( node.state_ == STATE::FAILED || node.state_ == STATE::SKIPPED )
+			{
+				out << ( node.state_ == STATE::FAILED ? " (failed)" : " (skipped)" );
+			}
+			out << std::endl;
+		}
+	}
+}
@@ -0,0 +1,95 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+namespace vkStartup
+{
+	/*!
+	 * @brief runs the startup steps as a graph, a step starts once the steps it depends on are done
+	 *		steps with nothing between them overlap, e.g. file reads while the instance and device are created
+	 *		the calling thread takes part, steps bound to it, like a window and its message queue, only run there
+	 *		a failed step skips every step depending on it
+	*/
+	struct Scheduler
+	{
+		using Task = uint32_t;
+
+		/*!
+		 * @brief name must outlive the scheduler, it names the trace zone too
+		 *		dependencies are tasks added before this one, job returns false on failure
+		*/
+		Task Add ( char const* name , std::function<bool ()> job , std::vector<Task> const& dependencies = {} , bool mainThread = false );
+
+		/*!
+		 * @brief runs every task on threadCount threads, the calling thread among them, and returns once all are done or skipped
+		 *		true if none failed
+		*/
+		bool Run ( uint32_t threadCount );
+
+		/*!
+		 * @brief the first task that failed, nullptr if none
+		*/
+		char const* Failed () const;
+
+		/*!
+		 * @brief time of each task, the serial sum, the longest dependency chain and the wall time of Run
+		*/
+		void Report ( std::ostream& out ) const;
+
+	private:
+		enum class STATE
+		{
+			WAITING ,
+			READY ,
+			RUNNING ,
+			DONE ,
+			FAILED ,
+			SKIPPED
+		};
+
+		struct Node
+		{
+			char const*				name_ { nullptr };
+			std::function<bool ()>	job_;
+			std::vector<Task>		dependencies_;
+			std::vector<Task>		dependents_;
+			uint32_t				waiting_on_ { 0 };
+			bool					main_thread_ { false };
+			STATE					state_ { STATE::WAITING };
+			double					ms_ { 0.0 };
+		};
+
+		void Work ( bool mainThread );
+
+		/*!
+		 * @brief takes the next ready task this thread may run, under the lock
+		*/
+		bool Take ( bool mainThread , Task& task );
+
+		/*!
+		 * @brief marks task done or failed and releases or skips its dependents, under the lock
+		*/
+		void Finish ( Task task , bool succeeded );
+
+		std::vector<Node>			nodes_;
+		std::deque<Task>			ready_;
+		uint32_t					remaining_ { 0 };
+		Task						failed_ { UINT32_MAX };
+		std::mutex					mutex_;
+		std::condition_variable		changed_;
+		double						wall_ms_ { 0.0 };
+		uint32_t					thread_count_ { 0 };
+	};
+}
@@ -0,0 +1,167 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkTrace.h"
+#include "vkLog.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+namespace vkTrace
+{
+	namespace Detail
+	{
+		std::atomic<bool> g_enabled_ { false };
+
+		struct Event
+		{
+			char const*	name_;
+			int64_t		begin_;
+			int64_t		end_;
+		};
+
+		struct ThreadEvents
+		{
+			uint32_t			tid_ { 0 };
+			char const*			name_ { nullptr };
+			std::vector<Event>	events_;
+		};
+
+		// every thread's list stays alive after the thread ends, WriteJson reads them all
+		static std::mutex g_mutex_;
+		static std::vector<std::unique_ptr<ThreadEvents>> g_threads_;
+		static int64_t g_epoch_ { 0 };
+
+		static ThreadEvents& CurrentThread ()
+		{
+			thread_local ThreadEvents* events { nullptr };
+			if ( events == nullptr )
+			{
+				std::lock_guard<std::mutex> lock ( g_mutex_ );
+				g_threads_.push_back ( std::make_unique<ThreadEvents> () );
+				events = g_threads_.back ().get ();
+				events->tid_ = static_cast< uint32_t >( g_threads_.size () );
+				events->events_.reserve ( 4096 );
+			}
+			return *events;
+		}
+
+		void Record ( char const* name , int64_t begin , int64_t end )
+		{
+			CurrentThread ().events_.push_back ( { name , begin , end } );
+		}
+	}
+
+	void WriteJsonString ( std::ostream& out , char const* text )
+	{
+		out << '"';
+		for ( ; *text; ++text )
+		{
+			if ( *text == '"' || *text == '\\' )
+			{
+				out << '\\';
+			}
+			out << *text;
+		}
+		out << '"';
+	}
+
+	void Initialize ()
+	{
+		Detail::g_epoch_ = Detail::Now ();
+		Detail::g_enabled_.store ( true , std::memory_order_relaxed );
+	}
+
+	void Stop ()
+	{
+		Detail::g_enabled_.store ( false , std::memory_order_relaxed );
+	}
+
+	void NameThread ( char const* name )
+	{
+		Detail::CurrentThread ().name_ = name;
+	}
+
+	bool WriteJson ( std::string const& filename )
+	{
+		using namespace Detail;
+		std::ofstream file ( filename , std::ios::trunc );
+		if ( !file )
+		{
+			VKLOG_FAILURE ( "### vkTrace::WriteJson failed! Failed to open " , filename , "." );
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock ( g_mutex_ );
+		size_t event_count { 0 };
+		bool first { true };
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		for ( auto const& thread : g_threads_ )
+		{
+			if ( thread->name_ != nullptr )
+			{
+				file << ( first ? "" : ",\n" ) << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid_ << ",\"args\":{\"name\":";
+				WriteJsonString ( file , thread->name_ );
+				file << "}}";
+				first = false;
+			}
+
+			// complete events, timestamps in microseconds from Initialize
+			for ( auto const& event : thread->events_ )
+			{
+				file << ( first ? "" : ",\n" ) << "{\"name\":";
+				WriteJsonString ( file , event.name_ );
+				file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->tid_
+					<< ",\"ts\":" << event.begin_ - g_epoch_ << ",\"dur\":" << event.end_ - event.begin_ << "}";
+				first = false;
+			}
+			event_count += thread->events_.size ();
+		}
+		file << "\n]}\n";
+
+		if ( !file )
+		{
+			VKLOG_FAILURE ( "### vkTrace::WriteJson failed! Failed to write " , filename , "." );
+			return false;
+		}
+		VKLOG_INFO ( "### Trace: " , event_count , " zones on " , g_threads_.size () , " threads written to " , filename );
+		return true;
+	}
+
+	std::vector<Total> Totals ( char const* prefix )
+	{
+		using namespace Detail;
+		std::vector<Total> totals;
+		size_t prefix_size = std::strlen ( prefix );
+
+		std::lock_guard<std::mutex> lock ( g_mutex_ );
+		for ( auto const& thread : g_threads_ )
+		{
+			for ( auto const& event : thread->events_ )
+			{
+				if ( std::strncmp ( event.name_ , prefix , prefix_size ) != 0 )
+				{
+					continue;
+				}
+
+				// a handful of names, a linear search is enough
+				auto total = std::find_if ( totals.begin () , totals.end () , [ &event ] ( Total const& t ) { return !std::strcmp ( t.name_ , event.name_ ); } );
+				if ( total == totals.end () )
+				{
+					totals.push_back ( { event.name_ , 0 , 0.0 } );
+					total = totals.end () - 1;
+				}
+				++total->count_;
+				total->ms_ += static_cast< double >( event.end_ - event.begin_ ) / 1000.0;
+			}
+		}
+		return totals;
+	}
+}
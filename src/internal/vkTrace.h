@@ -0,0 +1,134 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*!
+ * @brief 0 compiles every zone to nothing
+*/
+#ifndef VKTRACE_ENABLED
+#define VKTRACE_ENABLED 1
+#endif
+
+namespace vkTrace
+{
+	/*!
+	 * @brief starts recording zones, until then a zone costs one relaxed load
+	*/
+	void Initialize ();
+
+	/*!
+	 * @brief stops recording zones, zones begun from now on cost one relaxed load again, the ones recorded are kept
+	*/
+	void Stop ();
+
+	/*!
+	 * @brief names the calling thread in the trace, name must outlive the trace
+	*/
+	void NameThread ( char const* name );
+
+	/*!
+	 * @brief writes every zone recorded so far as Chrome / Perfetto trace event json
+	 *		no thread may still be recording, e.g. after the device is idle and the workers joined
+	*/
+	bool WriteJson ( std::string const& filename );
+
+	struct Total
+	{
+		char const*	name_ { nullptr };
+		uint32_t	count_ { 0 };
+		double		ms_ { 0.0 };
+	};
+
+	/*!
+	 * @brief count and summed time of the zones recorded so far whose name starts with prefix, one entry per name
+	 *		same rule as WriteJson, no thread may still be recording
+	*/
+	std::vector<Total> Totals ( char const* prefix );
+
+	/*!
+	 * @brief writes text as a quoted json string, quotes and backslashes escaped
+	*/
+	void WriteJsonString ( std::ostream& out , char const* text );
+
+	namespace Detail
+	{
+		extern std::atomic<bool> g_enabled_;
+
+		inline int64_t Now ()
+		{
+			return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now ().time_since_epoch () ).count ();
+		}
+
+		/*!
+		 * @brief appends to the calling thread's own event list, no lock after its first zone
+		*/
+		void Record ( char const* name , int64_t begin , int64_t end );
+	}
+
+#if VKTRACE_ENABLED
+	/*!
+	 * @brief a timed scope on the calling thread, name must be a string literal or otherwise outlive the trace
+	 *		Next ends the zone and starts the following one, for the phases of one function
+	*/
+	struct Zone
+	{
+		explicit Zone ( char const* name )
+		{
+			Begin ( name );
+		}
+
+		~Zone ()
+		{
+			End ();
+		}
+
+		Zone ( Zone const& ) = delete;
+		Zone& operator= ( Zone const& ) = delete;
+
+		void Next ( char const* name )
+		{
+			End ();
+			Begin ( name );
+		}
+
+		void End ()
+		{
+			if ( name_ != nullptr )
+			{
+				Detail::Record ( name_ , begin_ , Detail::Now () );
+				name_ = nullptr;
+			}
+		}
+
+	private:
+		void Begin ( char const* name )
+		{
+			if ( Detail::g_enabled_.load ( std::memory_order_relaxed ) )
+			{
+				name_ = name;
+				begin_ = Detail::Now ();
+			}
+		}
+
+		char const*	name_ { nullptr };
+		int64_t		begin_ { 0 };
+	};
+#else
+	struct Zone
+	{
+		explicit Zone ( char const* ) {}
+		void Next ( char const* ) {}
+		void End () {}
+	};
+#endif
+}
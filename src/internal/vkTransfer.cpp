@@ -0,0 +1,395 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkTransfer.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vkTransfer
+{
+	// copy offsets into the ring stay 16 byte aligned, enough for any buffer copy and most texel blocks
+	static constexpr VkDeviceSize RING_ALIGNMENT { 16 };
+
+	bool StagingRing::Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator ,
+		VkQueue transferQueue , VkQueue graphicsQueue , Parameters const& params )
+	{
+		vkTrace::Zone zone ( "vkTransfer::StagingRing::Initialize" );
+
+		logical_device_ = logicalDevice;
+		allocator_ = &allocator;
+		transfer_queue_ = transferQueue;
+		graphics_queue_ = graphicsQueue;
+		transfer_family_ = profile.indices_.transfer_family_.value ();
+		graphics_family_ = profile.indices_.graphics_family_.value ();
+		ownership_transfer_ = profile.indices_.HasDedicatedTransfer ();
+
+		// one persistently mapped buffer backs the whole ring
+		VkBufferCreateInfo bufferInfo {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = params.size_;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT , vkMemory::STRATEGY::FREE_LIST , buffer_ , allocation_ ) ||
+			allocation_.mapped_ == nullptr )
+		{
+			VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to create the staging buffer." );
+			return false;
+		}
+		capacity_ = params.size_;
+		head_ = tail_ = used_ = 0;
+
+		VkCommandPoolCreateInfo poolInfo {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		VkSemaphoreCreateInfo semaphoreInfo {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		VkFenceCreateInfo fenceInfo {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+		batches_.resize ( std::max ( params.batch_slots_ , 1u ) );
+		for ( auto& batch : batches_ )
+		{
+			VkCommandBufferAllocateInfo allocInfo {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandBufferCount = 1;
+
+			poolInfo.queueFamilyIndex = transfer_family_;
+			if ( vkCreateCommandPool ( logical_device_ , &poolInfo , nullptr , &batch.transfer_pool_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to create transfer command pool." );
+				return false;
+			}
+			allocInfo.commandPool = batch.transfer_pool_;
+			if ( vkAllocateCommandBuffers ( logical_device_ , &allocInfo , &batch.transfer_commands_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to allocate transfer command buffer." );
+				return false;
+			}
+
+			// the acquire half of the ownership transfer runs on the graphics family
+			if ( ownership_transfer_ )
+			{
+				poolInfo.queueFamilyIndex = graphics_family_;
+				if ( vkCreateCommandPool ( logical_device_ , &poolInfo , nullptr , &batch.acquire_pool_ ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to create acquire command pool." );
+					return false;
+				}
+				allocInfo.commandPool = batch.acquire_pool_;
+				if ( vkAllocateCommandBuffers ( logical_device_ , &allocInfo , &batch.acquire_commands_ ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to allocate acquire command buffer." );
+					return false;
+				}
+				if ( vkCreateSemaphore ( logical_device_ , &semaphoreInfo , nullptr , &batch.released_ ) != VK_SUCCESS )
+				{
+					VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to create release semaphore." );
+					return false;
+				}
+			}
+
+			if ( vkCreateFence ( logical_device_ , &fenceInfo , nullptr , &batch.done_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Initialize failed! Failed to create batch fence." );
+				return false;
+			}
+		}
+		current_ = 0;
+		in_flight_.clear ();
+
+		VKLOG_INFO ( "### Staging ring: " , capacity_ / 1024 , " KiB, transfer family " , transfer_family_ ,
+			( ownership_transfer_ ? " (dedicated)" : " (shared with graphics)" ) );
+		return true;
+	}
+
+	bool StagingRing::UploadBuffer ( void const* data , VkDeviceSize size , VkBuffer dst , VkDeviceSize dstOffset , VkPipelineStageFlags dstStage , VkAccessFlags dstAccess )
+	{
+		// anything larger than half the ring goes up in chunks so the ring can keep cycling
+		VkDeviceSize chunk_limit = std::max<VkDeviceSize> ( capacity_ / 2 , RING_ALIGNMENT );
+		VkDeviceSize done { 0 };
+		while ( done < size )
+		{
+			VkDeviceSize chunk = std::min ( size - done , chunk_limit );
+
+			VkDeviceSize offset { 0 };
+			while ( !Reserve ( chunk , offset ) )
+			{
+				// full, hand the pending copies over and wait for the oldest batch to free its space
+				if ( batches_[ current_ ].recording_ )
+				{
+					if ( !Flush () )
+					{
+						return false;
+					}
+				}
+				else if ( !RetireOldest () )
+				{
+					VKLOG_FAILURE ( "### vkTransfer::StagingRing::UploadBuffer failed! Ring is too small for " , chunk , " bytes." );
+					return false;
+				}
+			}
+
+			Batch& batch = batches_[ current_ ];
+			if ( !batch.recording_ && !BeginBatch ( batch ) )
+			{
+				return false;
+			}
+
+			std::memcpy ( static_cast< char* >( allocation_.mapped_ ) + offset , static_cast< char const* >( data ) + done , static_cast< size_t >( chunk ) );
+
+			VkBufferCopy region {};
+			region.srcOffset = offset;
+			region.dstOffset = dstOffset + done;
+			region.size = chunk;
+			vkCmdCopyBuffer ( batch.transfer_commands_ , buffer_ , dst , 1 , &region );
+
+			VkBufferMemoryBarrier barrier {};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = dst;
+			barrier.offset = region.dstOffset;
+			barrier.size = chunk;
+			batch.barriers_.push_back ( barrier );
+			batch.dst_stages_ |= dstStage;
+
+			done += chunk;
+		}
+		return true;
+	}
+
+	bool StagingRing::Flush ()
+	{
+		Batch& batch = batches_[ current_ ];
+		if ( !batch.recording_ )
+		{
+			return true;
+		}
+
+		std::vector<VkBufferMemoryBarrier> barriers = batch.barriers_;
+		if ( ownership_transfer_ )
+		{
+			// release, the destination access happens after the acquire on the graphics family
+			for ( auto& barrier : barriers )
+			{
+				barrier.dstAccessMask = 0;
+				barrier.srcQueueFamilyIndex = transfer_family_;
+				barrier.dstQueueFamilyIndex = graphics_family_;
+			}
+			vkCmdPipelineBarrier ( batch.transfer_commands_ , VK_PIPELINE_STAGE_TRANSFER_BIT , VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT , 0 ,
+				0 , nullptr , static_cast< uint32_t >( barriers.size () ) , barriers.data () , 0 , nullptr );
+		}
+		else
+		{
+			// same queue, later submissions see the copies through this barrier
+			vkCmdPipelineBarrier ( batch.transfer_commands_ , VK_PIPELINE_STAGE_TRANSFER_BIT , batch.dst_stages_ , 0 ,
+				0 , nullptr , static_cast< uint32_t >( barriers.size () ) , barriers.data () , 0 , nullptr );
+		}
+
+		if ( vkEndCommandBuffer ( batch.transfer_commands_ ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkTransfer::StagingRing::Flush failed! Failed to end transfer command buffer." );
+			return false;
+		}
+		batch.recording_ = false;
+
+		vkResetFences ( logical_device_ , 1 , &batch.done_ );
+
+		VkSubmitInfo submitInfo {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.transfer_commands_;
+		submitInfo.signalSemaphoreCount = ownership_transfer_ ? 1 : 0;
+		submitInfo.pSignalSemaphores = &batch.released_;
+
+		if ( vkQueueSubmit ( transfer_queue_ , 1 , &submitInfo , ownership_transfer_ ? VK_NULL_HANDLE : batch.done_ ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkTransfer::StagingRing::Flush failed! Failed to submit transfer batch." );
+			return false;
+		}
+
+		if ( ownership_transfer_ )
+		{
+			VkCommandBufferBeginInfo beginInfo {};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			if ( vkBeginCommandBuffer ( batch.acquire_commands_ , &beginInfo ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Flush failed! Failed to begin acquire command buffer." );
+				return false;
+			}
+
+			// acquire, chained to the semaphore wait through the consumer stages
+			barriers = batch.barriers_;
+			for ( auto& barrier : barriers )
+			{
+				barrier.srcAccessMask = 0;
+				barrier.srcQueueFamilyIndex = transfer_family_;
+				barrier.dstQueueFamilyIndex = graphics_family_;
+			}
+			vkCmdPipelineBarrier ( batch.acquire_commands_ , batch.dst_stages_ , batch.dst_stages_ , 0 ,
+				0 , nullptr , static_cast< uint32_t >( barriers.size () ) , barriers.data () , 0 , nullptr );
+			if ( vkEndCommandBuffer ( batch.acquire_commands_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Flush failed! Failed to end acquire command buffer." );
+				return false;
+			}
+
+			VkSubmitInfo acquireInfo {};
+			acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			acquireInfo.waitSemaphoreCount = 1;
+			acquireInfo.pWaitSemaphores = &batch.released_;
+			acquireInfo.pWaitDstStageMask = &batch.dst_stages_;
+			acquireInfo.commandBufferCount = 1;
+			acquireInfo.pCommandBuffers = &batch.acquire_commands_;
+
+			if ( vkQueueSubmit ( graphics_queue_ , 1 , &acquireInfo , batch.done_ ) != VK_SUCCESS )
+			{
+				VKLOG_FAILURE ( "### vkTransfer::StagingRing::Flush failed! Failed to submit acquire batch." );
+				return false;
+			}
+		}
+
+		in_flight_.push_back ( current_ );
+
+		// the next slot must be done with its previous batch before it records again
+		current_ = ( current_ + 1 ) % static_cast< uint32_t >( batches_.size () );
+		while ( std::find ( in_flight_.begin () , in_flight_.end () , current_ ) != in_flight_.end () )
+		{
+			RetireOldest ();
+		}
+		batches_[ current_ ].ring_bytes_ = 0;
+		batches_[ current_ ].ring_end_ = head_;
+		return true;
+	}
+
+	void StagingRing::WaitIdle ()
+	{
+		while ( RetireOldest () )
+		{
+		}
+	}
+
+	void StagingRing::Destroy ()
+	{
+		WaitIdle ();
+		for ( auto& batch : batches_ )
+		{
+			vkDestroyCommandPool ( logical_device_ , batch.transfer_pool_ , nullptr );
+			vkDestroyCommandPool ( logical_device_ , batch.acquire_pool_ , nullptr );
+			vkDestroySemaphore ( logical_device_ , batch.released_ , nullptr );
+			vkDestroyFence ( logical_device_ , batch.done_ , nullptr );
+		}
+		batches_.clear ();
+
+		if ( allocator_ )
+		{
+			allocator_->DestroyBuffer ( buffer_ , allocation_ );
+		}
+		capacity_ = head_ = tail_ = used_ = 0;
+	}
+
+	bool StagingRing::Reserve ( VkDeviceSize size , VkDeviceSize& offset )
+	{
+		if ( used_ == 0 )
+		{
+			head_ = tail_ = 0;
+		}
+		else if ( head_ == tail_ )
+		{
+			// wrapped all the way round
+			return false;
+		}
+
+		VkDeviceSize start = ( head_ + RING_ALIGNMENT - 1 ) / RING_ALIGNMENT * RING_ALIGNMENT;
+		VkDeviceSize reserved { 0 };
+		if ( head_ >= tail_ )
+		{
+			if ( start + size <= capacity_ )
+			{
+				reserved = start + size - head_;
+			}
+			else if ( size <= tail_ )
+			{
+				// skip the end of the ring, the skipped bytes come back with this batch
+				reserved = capacity_ - head_ + size;
+				start = 0;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if ( start + size <= tail_ )
+		{
+			reserved = start + size - head_;
+		}
+		else
+		{
+			return false;
+		}
+
+		head_ = start + size;
+		used_ += reserved;
+
+		Batch& batch = batches_[ current_ ];
+		batch.ring_bytes_ += reserved;
+		batch.ring_end_ = head_;
+		offset = start;
+		return true;
+	}
+
+	bool StagingRing::RetireOldest ()
+	{
+		if ( in_flight_.empty () )
+		{
+			return false;
+		}
+
+		Batch& batch = batches_[ in_flight_.front () ];
+		vkWaitForFences ( logical_device_ , 1 , &batch.done_ , VK_TRUE , UINT64_MAX );
+		used_ -= batch.ring_bytes_;
+		tail_ = batch.ring_end_;
+		if ( used_ == 0 )
+		{
+			head_ = tail_ = 0;
+		}
+		in_flight_.pop_front ();
+		return true;
+	}
+
+	bool StagingRing::BeginBatch ( Batch& batch )
+	{
+		vkResetCommandPool ( logical_device_ , batch.transfer_pool_ , 0 );
+		if ( batch.acquire_pool_ != VK_NULL_HANDLE )
+		{
+			vkResetCommandPool ( logical_device_ , batch.acquire_pool_ , 0 );
+		}
+		batch.barriers_.clear ();
+		batch.dst_stages_ = 0;
+
+		VkCommandBufferBeginInfo beginInfo {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if ( vkBeginCommandBuffer ( batch.transfer_commands_ , &beginInfo ) != VK_SUCCESS )
+		{
+			VKLOG_FAILURE ( "### vkTransfer::StagingRing::BeginBatch failed! Failed to begin transfer command buffer." );
+			return false;
+		}
+		batch.recording_ = true;
+		return true;
+	}
+}
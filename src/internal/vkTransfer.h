@@ -0,0 +1,93 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+#include "vkMemory.h"
+
+#include <vector>
+#include <deque>
+
+namespace vkTransfer
+{
+	/*!
+	 * @brief persistently mapped staging ring, uploads are copied in and batched until Flush,
+	 *		which submits them on the transfer queue
+	 *		with a dedicated transfer family the buffers are released to the graphics family and acquired
+	 *		there by a small submit that waits on the transfer semaphore, so rendering never records the copies
+	*/
+	struct StagingRing
+	{
+		struct Parameters
+		{
+			VkDeviceSize	size_ { 32ull * 1024 * 1024 };
+			uint32_t		batch_slots_ { 4 };
+		};
+
+		bool Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator ,
+			VkQueue transferQueue , VkQueue graphicsQueue , Parameters const& params );
+
+		/*!
+		 * @brief copies size bytes into the ring and queues a copy to dst, dstStage and dstAccess are the
+		 *		first use of the data on the graphics queue
+		 *		blocks on the oldest batch only if the ring is full
+		*/
+		bool UploadBuffer ( void const* data , VkDeviceSize size , VkBuffer dst , VkDeviceSize dstOffset , VkPipelineStageFlags dstStage , VkAccessFlags dstAccess );
+
+		/*!
+		 * @brief submits the batched copies, later graphics submissions see the data
+		*/
+		bool Flush ();
+
+		/*!
+		 * @brief waits until every flushed batch completed
+		*/
+		void WaitIdle ();
+
+		void Destroy ();
+
+	private:
+		struct Batch
+		{
+			VkCommandPool					transfer_pool_ { VK_NULL_HANDLE };
+			VkCommandBuffer					transfer_commands_ { VK_NULL_HANDLE };
+			VkCommandPool					acquire_pool_ { VK_NULL_HANDLE };
+			VkCommandBuffer					acquire_commands_ { VK_NULL_HANDLE };
+			VkSemaphore						released_ { VK_NULL_HANDLE };
+			VkFence							done_ { VK_NULL_HANDLE };
+			VkDeviceSize					ring_end_ { 0 };
+			VkDeviceSize					ring_bytes_ { 0 };
+			std::vector<VkBufferMemoryBarrier>	barriers_;
+			VkPipelineStageFlags			dst_stages_ { 0 };
+			bool							recording_ { false };
+		};
+
+		bool		Reserve ( VkDeviceSize size , VkDeviceSize& offset );
+
+		bool		RetireOldest ();
+
+		bool		BeginBatch ( Batch& batch );
+
+		VkDevice					logical_device_ { VK_NULL_HANDLE };
+		vkMemory::Allocator*		allocator_ { nullptr };
+		VkQueue						transfer_queue_ { VK_NULL_HANDLE };
+		VkQueue						graphics_queue_ { VK_NULL_HANDLE };
+		uint32_t					transfer_family_ { 0 };
+		uint32_t					graphics_family_ { 0 };
+		bool						ownership_transfer_ { false };
+
+		VkBuffer					buffer_ { VK_NULL_HANDLE };
+		vkMemory::Allocation		allocation_;
+		VkDeviceSize				capacity_ { 0 };
+		VkDeviceSize				head_ { 0 };
+		VkDeviceSize				tail_ { 0 };
+		VkDeviceSize				used_ { 0 };
+
+		std::vector<Batch>			batches_;
+		uint32_t					current_ { 0 };
+		std::deque<uint32_t>		in_flight_;
+	};
+}
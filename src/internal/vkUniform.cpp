@@ -0,0 +1,116 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#include "vkUniform.h"
+#include "vkLog.h"
+#include "vkTrace.h"
+
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+namespace vkUniform
+{
+	bool UniformRing::Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+		vkDescriptor::SetCache& staticSets , uint32_t frameCount , Parameters const& params )
+	{
+		vkTrace::Zone zone ( "vkUniform::UniformRing::Initialize" );
+
+		logical_device_ = logicalDevice;
+		allocator_ = &allocator;
+		frame_count_ = std::max ( frameCount , 1u );
+
+		// every dynamic offset has to satisfy both, the buffer is bound as uniform and as storage
+		VkPhysicalDeviceLimits const& limits = profile.properties_.limits;
+		alignment_ = std::max ( { limits.minUniformBufferOffsetAlignment , limits.minStorageBufferOffsetAlignment , VkDeviceSize { 1 } } );
+		frame_size_ = ( std::max ( params.frame_size_ , params.range_ ) + alignment_ - 1 ) / alignment_ * alignment_;
+
+		if ( params.range_ > limits.maxUniformBufferRange )
+		{
+			VKLOG_FAILURE ( "### vkUniform::UniformRing::Initialize failed! Range of " , params.range_ , " bytes exceeds maxUniformBufferRange." );
+			return false;
+		}
+		if ( frame_size_ * frame_count_ > std::numeric_limits<uint32_t>::max () )
+		{
+			VKLOG_FAILURE ( "### vkUniform::UniformRing::Initialize failed! Dynamic offsets are 32 bit, the ring is too large." );
+			return false;
+		}
+
+		VkBufferCreateInfo bufferInfo {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = frame_size_ * frame_count_;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if ( !allocator.CreateBuffer ( bufferInfo , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT , vkMemory::STRATEGY::FREE_LIST , buffer_ , allocation_ ) ||
+			allocation_.mapped_ == nullptr )
+		{
+			VKLOG_FAILURE ( "### vkUniform::UniformRing::Initialize failed! Failed to create mapped ring buffer." );
+			return false;
+		}
+		mapped_ = static_cast< char* >( allocation_.mapped_ );
+
+		VkDescriptorSetLayoutBinding binding {};
+		binding.binding = 0;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		binding.descriptorCount = 1;
+		binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		if ( ( set_layout_ = layoutCache.Get ( { binding } ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		// written once, draws only move the dynamic offset
+		if ( ( set_ = staticSets.Get ( set_layout_ , { { 0 , VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC , buffer_ , 0 , params.range_ } } ) ) == VK_NULL_HANDLE )
+		{
+			return false;
+		}
+
+		VKLOG_INFO ( "### Uniform ring: " , frame_count_ , " x " , frame_size_ , " bytes, offsets aligned to " , alignment_ , "." );
+		return true;
+	}
+
+	void UniformRing::BeginFrame ( size_t frame )
+	{
+		assert ( frame < frame_count_ );
+		high_water_ = std::max ( high_water_ , head_ );
+		frame_ = frame;
+		head_ = 0;
+	}
+
+	void* UniformRing::Allocate ( VkDeviceSize size , uint32_t& dynamicOffset )
+	{
+		VkDeviceSize offset = ( head_ + alignment_ - 1 ) / alignment_ * alignment_;
+		if ( offset + size > frame_size_ )
+		{
+			if ( !overflowed_ )
+			{
+				VKLOG_FAILURE ( "### vkUniform::UniformRing::Allocate failed! Frame region of " , frame_size_ , " bytes is full." );
+				overflowed_ = true;
+			}
+			return nullptr;
+		}
+
+		head_ = offset + size;
+		VkDeviceSize ring_offset = frame_size_ * frame_ + offset;
+		dynamicOffset = static_cast< uint32_t >( ring_offset );
+		return mapped_ + ring_offset;
+	}
+
+	void UniformRing::Destroy ()
+	{
+		if ( logical_device_ == VK_NULL_HANDLE )
+		{
+			return;
+		}
+
+		allocator_->DestroyBuffer ( buffer_ , allocation_ );
+		set_layout_ = VK_NULL_HANDLE;
+		set_ = VK_NULL_HANDLE;
+		mapped_ = nullptr;
+		logical_device_ = VK_NULL_HANDLE;
+	}
+}
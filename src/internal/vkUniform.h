@@ -0,0 +1,101 @@
+/*
+* @author:	Zachary Tay
+* @date:	20/02/21
+* @brief:	vulkan midterm
+*/
+
+#pragma once
+#include "vkHelper.h"
+#include "vkMemory.h"
+#include "vkDescriptor.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace vkUniform
+{
+	/*!
+	 * @brief one persistently mapped, host coherent buffer cut into a region per frame in flight,
+	 *		allocations bump a head through the frame's region and are addressed by a dynamic offset
+	 *		into one UNIFORM_BUFFER_DYNAMIC set, so a draw's data costs no allocation, descriptor write or map
+	 *		BeginFrame rewinds a region, the frame's fence in vkSyncObjects::in_flight_fences_ must have signaled,
+	 *		e.g. from vkFrameCommandData::update_
+	 *		the buffer is also a storage buffer, Buffer and the offsets can be bound through other sets
+	*/
+	struct UniformRing
+	{
+		struct Parameters
+		{
+			VkDeviceSize	frame_size_ { 1024 * 1024 };					// bytes per frame in flight
+			VkDeviceSize	range_ { sizeof ( vkHelper::vkDrawConstants ) };	// bytes a draw sees through the set
+		};
+
+		/*!
+		 * @brief the set layout comes from layoutCache and the set from staticSets, both outlive the ring
+		*/
+		bool Initialize ( vkHelper::vkDeviceProfile const& profile , VkDevice logicalDevice , vkMemory::Allocator& allocator , vkDescriptor::LayoutCache& layoutCache ,
+			vkDescriptor::SetCache& staticSets , uint32_t frameCount , Parameters const& params );
+
+		void BeginFrame ( size_t frame );
+
+		/*!
+		 * @brief size bytes from the current frame's region, nullptr once the region is full
+		*/
+		void* Allocate ( VkDeviceSize size , uint32_t& dynamicOffset );
+
+		/*!
+		 * @brief count elements of T, each at its own aligned dynamic offset, dynamicOffset + i * stride
+		*/
+		template <typename T>
+		T* AllocateArray ( uint32_t count , uint32_t& dynamicOffset , uint32_t& stride );
+
+		VkDescriptorSetLayout SetLayout () const
+		{
+			return set_layout_;
+		}
+
+		VkDescriptorSet Set () const
+		{
+			return set_;
+		}
+
+		VkBuffer Buffer () const
+		{
+			return buffer_;
+		}
+
+		/*!
+		 * @brief most bytes any frame used, for sizing frame_size_, the frame being filled included
+		*/
+		VkDeviceSize HighWater () const
+		{
+			return std::max ( high_water_ , head_ );
+		}
+
+		void Destroy ();
+
+	private:
+		VkDevice				logical_device_ { VK_NULL_HANDLE };
+		vkMemory::Allocator*	allocator_ { nullptr };
+		VkBuffer				buffer_ { VK_NULL_HANDLE };
+		vkMemory::Allocation	allocation_;
+		VkDescriptorSetLayout	set_layout_ { VK_NULL_HANDLE };	// owned by the layout cache
+		VkDescriptorSet			set_ { VK_NULL_HANDLE };		// owned by the static set cache
+
+		char*					mapped_ { nullptr };
+		uint32_t				frame_count_ { 0 };
+		VkDeviceSize			frame_size_ { 0 };
+		VkDeviceSize			alignment_ { 1 };
+		size_t					frame_ { 0 };
+		VkDeviceSize			head_ { 0 };
+		VkDeviceSize			high_water_ { 0 };
+		bool					overflowed_ { false };
+	};
+
+	template <typename T>
+	T* UniformRing::AllocateArray ( uint32_t count , uint32_t& dynamicOffset , uint32_t& stride )
+	{
+		stride = static_cast< uint32_t >( ( sizeof ( T ) + alignment_ - 1 ) / alignment_ * alignment_ );
+		return static_cast< T* >( Allocate ( static_cast< VkDeviceSize >( stride ) * count , dynamicOffset ) );
+	}
+}
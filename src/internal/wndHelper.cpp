@@ -5,7 +5,9 @@
 */
 
 #include "wndHelper.h"
-#include <iostream>
+#include "vkLog.h"
+
+#ifdef _WIN32
 
 namespace wndHelper
 {
@@ -55,7 +57,7 @@ namespace wndHelper
 			WNDCLASSA C {};
 			if ( GetClassInfoA ( hInstance , "VULKANCLASS" , &C ) )
 			{
-				std::cerr << "### wndHelper::CreateWindowClass failed! Window class already exists." << std::endl;
+				VKLOG_FAILURE ( "### wndHelper::CreateWindowClass failed! Window class already exists." );
 				return false;
 			}
 		}
@@ -78,7 +80,7 @@ namespace wndHelper
 		// register the window class and check if its successful
 		if ( !RegisterClassEx ( &wnd_class ) )
 		{
-			std::cerr << "### wndHelper::CreateWindowClass failed! Window class not registered." << std::endl;
+			VKLOG_FAILURE ( "### wndHelper::CreateWindowClass failed! Window class not registered." );
 			return false;
 		}
 
@@ -131,7 +133,7 @@ namespace wndHelper
 			{
 				if ( ChangeDisplaySettings ( &dm_screen_settings , CDS_FULLSCREEN ) != DISP_CHANGE_SUCCESSFUL )
 				{
-					std::cerr << "### wndHelper::CreateSystemWindow failed! Display settings not changed successfully." << std::endl;
+					VKLOG_FAILURE ( "### wndHelper::CreateSystemWindow failed! Display settings not changed successfully." );
 					return false;
 				}
 			}
@@ -184,7 +186,7 @@ namespace wndHelper
 		// check if window successfully created
 		if ( !hWnd )
 		{
-			std::cerr << "### wndHelper::CreateSystemWindow failed! Failed to create system window." << std::endl;
+			VKLOG_FAILURE ( "### wndHelper::CreateSystemWindow failed! Failed to create system window." );
 			return false;
 		}
 
@@ -201,13 +203,13 @@ namespace wndHelper
 
 		if ( !CreateWindowClass ( hInstance , WindowProc ) )
 		{
-			std::cerr << "### wndHelper::Window::Initialize failed! Failed to create window class." << std::endl;
+			VKLOG_FAILURE ( "### wndHelper::Window::Initialize failed! Failed to create window class." );
 			return false;
 		}
 
 		if ( !CreateSystemWindow ( hInstance , window_handle_ , params.is_fullscreen_ , params.width_ , params.height_ ) )
 		{
-			std::cerr << "### wndHelper::Window::Initialize failed! Failed to create system window." << std::endl;
+			VKLOG_FAILURE ( "### wndHelper::Window::Initialize failed! Failed to create system window." );
 			return false;
 		}
 
@@ -229,6 +231,23 @@ namespace wndHelper
 		return window_handle_;
 	}
 
+	void Window::Resize ( int width , int height )
+	{
+		// width and height are the client area the surface covers, SetWindowPos sizes the whole window with its frame
+		RECT window_rect { 0 , 0 , width , height };
+		AdjustWindowRectEx ( &window_rect , static_cast< DWORD >( GetWindowLongPtr ( window_handle_ , GWL_STYLE ) ) , FALSE ,
+			static_cast< DWORD >( GetWindowLongPtr ( window_handle_ , GWL_EXSTYLE ) ) );
+		SetWindowPos ( window_handle_ , nullptr , 0 , 0 , window_rect.right - window_rect.left , window_rect.bottom - window_rect.top , SWP_NOMOVE | SWP_NOZORDER );
+
+		// the system may clamp the size, keep what the client area actually became
+		RECT client_rect {};
+		GetClientRect ( window_handle_ , &client_rect );
+		width_ = client_rect.right - client_rect.left;
+		height_ = client_rect.bottom - client_rect.top;
+		g_width = width_;
+		g_height = height_;
+	}
+
 	void Window::Update ()
 	{
 
@@ -257,4 +276,5 @@ namespace wndHelper
 			DispatchMessage ( &msg_ );
 		}
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -5,6 +5,10 @@
 */
 
 #pragma once
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <Windows.h>
 
 namespace wndHelper
@@ -22,6 +26,8 @@ namespace wndHelper
 
 		HWND GetHandle () const noexcept;
 
+		void Resize ( int width , int height );
+
 		void Update ();
 
 		bool WindowShouldClose ();
@@ -37,4 +43,5 @@ namespace wndHelper
 		MSG		msg_;
 
 	};
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file